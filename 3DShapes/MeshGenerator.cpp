@@ -0,0 +1,282 @@
+///////////////////////////////////////////////////////////////////////////////
+// meshgenerator.cpp
+// ============
+// generate the vertices and indices of the round 3D primitives at any
+// tessellation: sphere, cylinder, cone, tapered cylinder, torus
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "MeshGenerator.h"
+
+#include <glm/glm.hpp>
+
+#include <cmath>
+
+namespace
+{
+	const float g_TwoPi = 6.28318530717958647692f;
+	const float g_Pi = 3.14159265358979323846f;
+	const GLuint g_FloatsPerMeshVertex = 8;	// position, normal and texture coordinates
+}
+
+/***********************************************************
+ *  GenerateSphere()
+ *
+ *  This method is used to generate a sphere from rings of
+ *  vertices.  Every ring repeats its first vertex at the
+ *  end so that the texture coordinates do not wrap at the
+ *  seam.
+ ***********************************************************/
+void MeshGenerator::GenerateSphere(
+	int slices,
+	int stacks,
+	MESH_DATA& mesh)
+{
+	GLuint ringVertices = slices + 1;
+	GLuint nVertices = (stacks + 1) * ringVertices;
+	GLuint nIndices = 6 * slices * (stacks - 1);
+
+	mesh.vertices.clear();
+	mesh.indices.clear();
+	mesh.vertices.reserve(nVertices * g_FloatsPerMeshVertex);
+	mesh.indices.reserve(nIndices);
+
+	for (int stack = 0; stack <= stacks; stack++)
+	{
+		float phi = g_Pi * (float)stack / (float)stacks;
+		float y = cos(phi);
+		float ringRadius = sin(phi);
+
+		for (int slice = 0; slice <= slices; slice++)
+		{
+			float theta = g_TwoPi * (float)slice / (float)slices;
+			float x = ringRadius * cos(theta);
+			float z = -ringRadius * sin(theta);
+
+			// the position on a unit sphere is also its normal
+			AddVertex(mesh, x, y, z, x, y, z,
+				(float)slice / (float)slices, 1.0f - (float)stack / (float)stacks);
+		}
+	}
+
+	for (int stack = 0; stack < stacks; stack++)
+	{
+		for (int slice = 0; slice < slices; slice++)
+		{
+			GLuint upper = stack * ringVertices + slice;
+			GLuint lower = upper + ringVertices;
+
+			// the first and last rings are single points, so
+			// only one triangle of their quads has an area
+			if (stack != stacks - 1)
+			{
+				mesh.indices.push_back(lower);
+				mesh.indices.push_back(lower + 1);
+				mesh.indices.push_back(upper);
+			}
+			if (stack != 0)
+			{
+				mesh.indices.push_back(upper);
+				mesh.indices.push_back(lower + 1);
+				mesh.indices.push_back(upper + 1);
+			}
+		}
+	}
+
+	mesh.nVertices = nVertices;
+	mesh.nBottomIndices = 0;
+	mesh.nTopIndices = 0;
+	mesh.nSidesIndices = (GLuint)mesh.indices.size();
+}
+
+/***********************************************************
+ *  GenerateCylinder()
+ *
+ *  This method is used to generate a cylinder with caps
+ *  and sides around the Y axis, from Y = 0 to Y = 1.  The
+ *  first vertex of each ring is on the positive X axis, and
+ *  the rings turn towards the negative Z axis.
+ ***********************************************************/
+void MeshGenerator::GenerateCylinder(
+	int slices,
+	float bottomRadius,
+	float topRadius,
+	MESH_DATA& mesh)
+{
+	bool bTopCap = (topRadius > 0.0f);
+	GLuint nCapVertices = bTopCap ? 2 * slices : slices;
+	GLuint nVertices = nCapVertices + 2 * (slices + 1);
+	GLuint nCapIndices = 3 * (slices - 2);
+	GLuint nIndices = (bTopCap ? 2 * nCapIndices : nCapIndices) + 6 * slices;
+
+	mesh.vertices.clear();
+	mesh.indices.clear();
+	mesh.vertices.reserve(nVertices * g_FloatsPerMeshVertex);
+	mesh.indices.reserve(nIndices);
+
+	// bottom cap - a fan around the first rim vertex, turned
+	// to face down
+	for (int slice = 0; slice < slices; slice++)
+	{
+		float theta = g_TwoPi * (float)slice / (float)slices;
+		float c = cos(theta);
+		float s = sin(theta);
+
+		AddVertex(mesh, bottomRadius * c, 0.0f, -bottomRadius * s, 0.0f, -1.0f, 0.0f,
+			0.5f - 0.5f * s, 0.5f + 0.5f * c);
+	}
+	for (int slice = 1; slice + 1 < slices; slice++)
+	{
+		mesh.indices.push_back(0);
+		mesh.indices.push_back(slice + 1);
+		mesh.indices.push_back(slice);
+	}
+	mesh.nBottomIndices = (GLuint)mesh.indices.size();
+
+	// top cap - a fan around the first rim vertex, facing up
+	if (bTopCap == true)
+	{
+		GLuint first = slices;
+		for (int slice = 0; slice < slices; slice++)
+		{
+			float theta = g_TwoPi * (float)slice / (float)slices;
+			float c = cos(theta);
+			float s = sin(theta);
+
+			AddVertex(mesh, topRadius * c, 1.0f, -topRadius * s, 0.0f, 1.0f, 0.0f,
+				0.5f - 0.5f * s, 0.5f + 0.5f * c);
+		}
+		for (int slice = 1; slice + 1 < slices; slice++)
+		{
+			mesh.indices.push_back(first);
+			mesh.indices.push_back(first + slice);
+			mesh.indices.push_back(first + slice + 1);
+		}
+	}
+	mesh.nTopIndices = (GLuint)mesh.indices.size() - mesh.nBottomIndices;
+
+	// sides - pairs of bottom and top vertices, with the normal
+	// tilted by the slope of a tapered side
+	GLuint first = nCapVertices;
+	for (int slice = 0; slice <= slices; slice++)
+	{
+		float theta = g_TwoPi * (float)slice / (float)slices;
+		float c = cos(theta);
+		float s = sin(theta);
+		glm::vec3 normal = glm::normalize(glm::vec3(c, bottomRadius - topRadius, -s));
+		float u = (float)slice / (float)slices;
+
+		AddVertex(mesh, bottomRadius * c, 0.0f, -bottomRadius * s, normal.x, normal.y, normal.z, u, 0.0f);
+		AddVertex(mesh, topRadius * c, 1.0f, -topRadius * s, normal.x, normal.y, normal.z, u, 1.0f);
+	}
+	for (int slice = 0; slice < slices; slice++)
+	{
+		GLuint bottom = first + 2 * slice;
+		GLuint top = bottom + 1;
+
+		mesh.indices.push_back(bottom);
+		mesh.indices.push_back(bottom + 2);
+		mesh.indices.push_back(top);
+		mesh.indices.push_back(top);
+		mesh.indices.push_back(bottom + 2);
+		mesh.indices.push_back(top + 2);
+	}
+
+	mesh.nVertices = nVertices;
+	mesh.nSidesIndices = (GLuint)mesh.indices.size() - mesh.nBottomIndices - mesh.nTopIndices;
+}
+
+/***********************************************************
+ *  GenerateTorus()
+ *
+ *  This method is used to generate a torus from a grid of
+ *  unique vertices, one ring of the tube per main segment.
+ *  The first ring and the first vertex of every ring are
+ *  repeated at the end so that the texture coordinates do
+ *  not wrap at the seams, and the triangles index the grid
+ *  instead of repeating the vertices.
+ ***********************************************************/
+void MeshGenerator::GenerateTorus(
+	int mainSegments,
+	int tubeSegments,
+	float mainRadius,
+	float tubeRadius,
+	MESH_DATA& mesh)
+{
+	GLuint ringVertices = tubeSegments + 1;
+	GLuint nVertices = (mainSegments + 1) * ringVertices;
+	GLuint nIndices = 6 * mainSegments * tubeSegments;
+
+	mesh.vertices.clear();
+	mesh.indices.clear();
+	mesh.vertices.reserve(nVertices * g_FloatsPerMeshVertex);
+	mesh.indices.reserve(nIndices);
+
+	for (int i = 0; i <= mainSegments; i++)
+	{
+		float mainAngle = g_TwoPi * (float)i / (float)mainSegments;
+		float cosMain = cos(mainAngle);
+		float sinMain = sin(mainAngle);
+
+		for (int j = 0; j <= tubeSegments; j++)
+		{
+			float tubeAngle = g_TwoPi * (float)j / (float)tubeSegments;
+			float cosTube = cos(tubeAngle);
+			float sinTube = sin(tubeAngle);
+			float ringRadius = mainRadius + tubeRadius * cosTube;
+
+			// the normal points away from the center of the
+			// tube ring, so it does not depend on the radii
+			AddVertex(mesh,
+				ringRadius * cosMain, ringRadius * sinMain, tubeRadius * sinTube,
+				cosTube * cosMain, cosTube * sinMain, sinTube,
+				(float)i / (float)mainSegments, (float)j / (float)tubeSegments);
+		}
+	}
+
+	// the quads are added one main segment at a time, so any
+	// run of main segments is one range of the indices
+	for (int i = 0; i < mainSegments; i++)
+	{
+		for (int j = 0; j < tubeSegments; j++)
+		{
+			GLuint current = i * ringVertices + j;
+			GLuint next = current + ringVertices;
+
+			mesh.indices.push_back(current);
+			mesh.indices.push_back(next);
+			mesh.indices.push_back(current + 1);
+			mesh.indices.push_back(current + 1);
+			mesh.indices.push_back(next);
+			mesh.indices.push_back(next + 1);
+		}
+	}
+
+	mesh.nVertices = nVertices;
+	mesh.nBottomIndices = 0;
+	mesh.nTopIndices = 0;
+	mesh.nSidesIndices = (GLuint)mesh.indices.size();
+}
+
+/***********************************************************
+ *  AddVertex()
+ *
+ *  This method is used to add one interleaved vertex to the
+ *  generated mesh.
+ ***********************************************************/
+void MeshGenerator::AddVertex(
+	MESH_DATA& mesh,
+	float x, float y, float z,
+	float nx, float ny, float nz,
+	float u, float v)
+{
+	mesh.vertices.push_back(x);
+	mesh.vertices.push_back(y);
+	mesh.vertices.push_back(z);
+	mesh.vertices.push_back(nx);
+	mesh.vertices.push_back(ny);
+	mesh.vertices.push_back(nz);
+	mesh.vertices.push_back(u);
+	mesh.vertices.push_back(v);
+}
@@ -0,0 +1,75 @@
+///////////////////////////////////////////////////////////////////////////////
+// meshgenerator.h
+// ============
+// generate the vertices and indices of the round 3D primitives at any
+// tessellation: sphere, cylinder, cone, tapered cylinder, torus
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+#include <vector>
+
+// number of levels of detail generated for each round primitive
+#define LOD_LEVELS 4
+
+/***********************************************************
+ *  MeshGenerator
+ *
+ *  This class contains the code for generating the round
+ *  3D shapes from their segment counts.  The vertices use
+ *  the same interleaved position, normal and texture
+ *  coordinate layout as the ShapeMeshes meshes.
+ ***********************************************************/
+class MeshGenerator
+{
+public:
+	// generated vertices and indices of a mesh - the indices
+	// of the bottom, top and sides are laid out in that order
+	struct MESH_DATA
+	{
+		std::vector<GLfloat> vertices;
+		std::vector<GLuint> indices;
+		GLuint nVertices;
+		GLuint nBottomIndices;
+		GLuint nTopIndices;
+		GLuint nSidesIndices;
+	};
+
+	// generate a sphere of radius 1 - the rings run from the
+	// top to the bottom, so with an even number of stacks the
+	// first half of the indices is the upper half sphere
+	static void GenerateSphere(
+		int slices,
+		int stacks,
+		MESH_DATA& mesh);
+
+	// generate a cylinder of height 1 standing on the origin -
+	// a top radius of 0 generates a cone without a top cap
+	static void GenerateCylinder(
+		int slices,
+		float bottomRadius,
+		float topRadius,
+		MESH_DATA& mesh);
+
+	// generate a torus around the Z axis - the first half of
+	// the indices is the half torus above the X axis when the
+	// number of main segments is even
+	static void GenerateTorus(
+		int mainSegments,
+		int tubeSegments,
+		float mainRadius,
+		float tubeRadius,
+		MESH_DATA& mesh);
+
+private:
+	// add one vertex to the generated mesh
+	static void AddVertex(
+		MESH_DATA& mesh,
+		float x, float y, float z,
+		float nx, float ny, float nz,
+		float u, float v);
+};
@@ -0,0 +1,484 @@
+///////////////////////////////////////////////////////////////////////////////
+// meshoptimizer.cpp
+// ============
+// reorder the triangles and vertices of indexed meshes for the post-transform
+// vertex cache, for less overdraw and for vertex fetch locality
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "MeshOptimizer.h"
+
+#include <glm/glm.hpp>
+
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <string.h>
+
+namespace
+{
+	const GLuint g_FloatsPerMeshVertex = 8;	// position, normal and texture coordinates
+
+	// size of the LRU cache modelled while reordering the triangles
+	const int g_CacheSize = 32;
+	// size of the FIFO cache used to measure an index order
+	const GLuint g_AnalyzeCacheSize = 16;
+
+	// vertex scoring of the linear-speed vertex cache optimization
+	const float g_CacheDecayPower = 1.5f;
+	const float g_LastTriangleScore = 0.75f;
+	const float g_ValenceBoostScale = 2.0f;
+	const float g_ValenceBoostPower = 0.5f;
+
+	// score a vertex from its position in the modelled cache, -1
+	// when it is not cached, and the number of triangles that
+	// still use it - vertices with few triangles left are
+	// boosted so that they are finished off
+	float VertexScore(int cachePosition, GLuint liveTriangles)
+	{
+		if (liveTriangles == 0)
+		{
+			return(-1.0f);
+		}
+
+		float score = 0.0f;
+		if (cachePosition >= 0)
+		{
+			if (cachePosition < 3)
+			{
+				// the vertices of the last triangle get a fixed score,
+				// so that the next triangle does not reuse all three
+				score = g_LastTriangleScore;
+			}
+			else
+			{
+				float scale = 1.0f / (float)(g_CacheSize - 3);
+				score = pow(1.0f - (float)(cachePosition - 3) * scale, g_CacheDecayPower);
+			}
+		}
+
+		score += g_ValenceBoostScale * pow((float)liveTriangles, -g_ValenceBoostPower);
+
+		return(score);
+	}
+
+	// get the position of an interleaved vertex
+	glm::vec3 VertexPosition(const GLfloat* vertices, GLuint index)
+	{
+		const GLfloat* values = vertices + index * g_FloatsPerMeshVertex;
+		return(glm::vec3(values[0], values[1], values[2]));
+	}
+}
+
+/***********************************************************
+ *  OptimizeMesh()
+ *
+ *  This method is used to run every optimization on a mesh.
+ *  The triangles of each range are reordered for the vertex
+ *  cache and then for overdraw, and the vertices are then
+ *  reordered for all of the ranges.  Indices that are not
+ *  covered by the ranges are optimized as one more range.
+ ***********************************************************/
+void MeshOptimizer::OptimizeMesh(
+	GLfloat* vertices,
+	GLuint nVertices,
+	GLuint* indices,
+	GLuint nIndices,
+	const GLuint* rangeCounts,
+	int nRanges)
+{
+	if ((NULL == vertices) || (NULL == indices) || (nIndices < 3))
+	{
+		return;
+	}
+
+	GLuint first = 0;
+	for (int range = 0; range < nRanges; range++)
+	{
+		GLuint count = rangeCounts[range];
+		if (first + count > nIndices)
+		{
+			break;
+		}
+
+		OptimizeVertexCache(indices + first, count, nVertices);
+		OptimizeOverdraw(indices + first, count, vertices, nVertices);
+		first += count;
+	}
+	if (first < nIndices)
+	{
+		OptimizeVertexCache(indices + first, nIndices - first, nVertices);
+		OptimizeOverdraw(indices + first, nIndices - first, vertices, nVertices);
+	}
+
+	OptimizeVertexFetch(vertices, nVertices, indices, nIndices);
+}
+
+/***********************************************************
+ *  OptimizeVertexCache()
+ *
+ *  This method is used to reorder the triangles with the
+ *  linear-speed vertex cache optimization by T. Forsyth.
+ *  Every vertex is scored by its position in a modelled LRU
+ *  cache and by the number of its triangles left to draw,
+ *  and the triangle with the highest score among the ones
+ *  using cached vertices is drawn next.
+ ***********************************************************/
+void MeshOptimizer::OptimizeVertexCache(
+	GLuint* indices,
+	GLuint nIndices,
+	GLuint nVertices)
+{
+	GLuint nTriangles = nIndices / 3;
+	if (nTriangles < 2)
+	{
+		return;
+	}
+
+	// the triangles that use each vertex, packed per vertex
+	std::vector<GLuint> liveTriangles(nVertices, 0);
+	for (GLuint i = 0; i < nTriangles * 3; i++)
+	{
+		liveTriangles[indices[i]]++;
+	}
+
+	std::vector<GLuint> adjacencyOffsets(nVertices + 1, 0);
+	for (GLuint v = 0; v < nVertices; v++)
+	{
+		adjacencyOffsets[v + 1] = adjacencyOffsets[v] + liveTriangles[v];
+	}
+
+	std::vector<GLuint> adjacency(nTriangles * 3);
+	std::vector<GLuint> adjacencyFill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+	for (GLuint i = 0; i < nTriangles * 3; i++)
+	{
+		adjacency[adjacencyFill[indices[i]]++] = i / 3;
+	}
+
+	std::vector<float> vertexScores(nVertices);
+	for (GLuint v = 0; v < nVertices; v++)
+	{
+		vertexScores[v] = VertexScore(-1, liveTriangles[v]);
+	}
+
+	std::vector<float> triangleScores(nTriangles);
+	for (GLuint t = 0; t < nTriangles; t++)
+	{
+		triangleScores[t] = vertexScores[indices[t * 3]] +
+			vertexScores[indices[t * 3 + 1]] +
+			vertexScores[indices[t * 3 + 2]];
+	}
+
+	std::vector<bool> bEmitted(nTriangles, false);
+	std::vector<GLuint> output(nTriangles * 3);
+	std::vector<GLuint> cache;
+	std::vector<GLuint> newCache;
+	cache.reserve(g_CacheSize + 3);
+	newCache.reserve(g_CacheSize + 3);
+
+	int bestTriangle = 0;
+	for (GLuint t = 1; t < nTriangles; t++)
+	{
+		if (triangleScores[t] > triangleScores[bestTriangle])
+		{
+			bestTriangle = (int)t;
+		}
+	}
+
+	GLuint scanCursor = 0;
+	for (GLuint emitted = 0; emitted < nTriangles; emitted++)
+	{
+		// none of the cached vertices has triangles left, so
+		// continue with the next triangle in the input order
+		if (bestTriangle < 0)
+		{
+			while (bEmitted[scanCursor] == true)
+			{
+				scanCursor++;
+			}
+			bestTriangle = (int)scanCursor;
+		}
+
+		const GLuint* triangle = indices + bestTriangle * 3;
+		bEmitted[bestTriangle] = true;
+		output[emitted * 3] = triangle[0];
+		output[emitted * 3 + 1] = triangle[1];
+		output[emitted * 3 + 2] = triangle[2];
+
+		// the drawn vertices move to the front of the cache
+		newCache.clear();
+		for (int k = 0; k < 3; k++)
+		{
+			GLuint vertex = triangle[k];
+			newCache.push_back(vertex);
+
+			// remove the triangle from the live triangles of the vertex
+			GLuint* vertexTriangles = &adjacency[adjacencyOffsets[vertex]];
+			for (GLuint i = 0; i < liveTriangles[vertex]; i++)
+			{
+				if (vertexTriangles[i] == (GLuint)bestTriangle)
+				{
+					vertexTriangles[i] = vertexTriangles[liveTriangles[vertex] - 1];
+					break;
+				}
+			}
+			liveTriangles[vertex]--;
+		}
+		for (size_t i = 0; i < cache.size(); i++)
+		{
+			GLuint vertex = cache[i];
+			if ((vertex != triangle[0]) && (vertex != triangle[1]) && (vertex != triangle[2]))
+			{
+				newCache.push_back(vertex);
+			}
+		}
+
+		// rescore the vertices pushed out of the cache and the
+		// ones still in it, and pass the change on to their triangles
+		bestTriangle = -1;
+		float bestScore = -1.0f;
+		for (size_t i = 0; i < newCache.size(); i++)
+		{
+			GLuint vertex = newCache[i];
+			int position = (i < (size_t)g_CacheSize) ? (int)i : -1;
+			float score = VertexScore(position, liveTriangles[vertex]);
+			float delta = score - vertexScores[vertex];
+
+			vertexScores[vertex] = score;
+
+			const GLuint* vertexTriangles = &adjacency[adjacencyOffsets[vertex]];
+			for (GLuint j = 0; j < liveTriangles[vertex]; j++)
+			{
+				triangleScores[vertexTriangles[j]] += delta;
+			}
+		}
+		if (newCache.size() > (size_t)g_CacheSize)
+		{
+			newCache.resize(g_CacheSize);
+		}
+		cache.swap(newCache);
+
+		for (size_t i = 0; i < cache.size(); i++)
+		{
+			GLuint vertex = cache[i];
+			const GLuint* vertexTriangles = &adjacency[adjacencyOffsets[vertex]];
+			for (GLuint j = 0; j < liveTriangles[vertex]; j++)
+			{
+				GLuint candidate = vertexTriangles[j];
+				if (triangleScores[candidate] > bestScore)
+				{
+					bestScore = triangleScores[candidate];
+					bestTriangle = (int)candidate;
+				}
+			}
+		}
+	}
+
+	memcpy(indices, output.data(), sizeof(GLuint) * nTriangles * 3);
+}
+
+/***********************************************************
+ *  OptimizeOverdraw()
+ *
+ *  This method is used to reorder the triangles so that the
+ *  outer surfaces of the mesh are drawn before the ones they
+ *  hide.  The cache optimized triangles are split into
+ *  clusters where a triangle misses the cache with all of
+ *  its vertices, so that moving whole clusters keeps the
+ *  cache efficiency, and the clusters are sorted on how far
+ *  they face out of the mesh.
+ ***********************************************************/
+void MeshOptimizer::OptimizeOverdraw(
+	GLuint* indices,
+	GLuint nIndices,
+	const GLfloat* vertices,
+	GLuint nVertices)
+{
+	GLuint nTriangles = nIndices / 3;
+	if (nTriangles < 2)
+	{
+		return;
+	}
+
+	// find the cluster boundaries with a FIFO cache - a vertex is
+	// cached while fewer than cache size misses followed its own
+	std::vector<GLuint> clusterStarts;
+	std::vector<GLuint> missTimes(nVertices, 0);
+	GLuint time = g_AnalyzeCacheSize + 1;
+	for (GLuint t = 0; t < nTriangles; t++)
+	{
+		int misses = 0;
+		for (int k = 0; k < 3; k++)
+		{
+			GLuint vertex = indices[t * 3 + k];
+			if (time - missTimes[vertex] > g_AnalyzeCacheSize)
+			{
+				missTimes[vertex] = time++;
+				misses++;
+			}
+		}
+		if ((t == 0) || (misses == 3))
+		{
+			clusterStarts.push_back(t);
+		}
+	}
+	if (clusterStarts.size() < 2)
+	{
+		return;
+	}
+	clusterStarts.push_back(nTriangles);
+
+	// area weighted centers and normals of the mesh and clusters
+	size_t nClusters = clusterStarts.size() - 1;
+	std::vector<glm::vec3> clusterCenters(nClusters, glm::vec3(0.0f));
+	std::vector<glm::vec3> clusterNormals(nClusters, glm::vec3(0.0f));
+	std::vector<float> clusterAreas(nClusters, 0.0f);
+	glm::vec3 meshCenter(0.0f);
+	float meshArea = 0.0f;
+
+	for (size_t c = 0; c < nClusters; c++)
+	{
+		for (GLuint t = clusterStarts[c]; t < clusterStarts[c + 1]; t++)
+		{
+			glm::vec3 p0 = VertexPosition(vertices, indices[t * 3]);
+			glm::vec3 p1 = VertexPosition(vertices, indices[t * 3 + 1]);
+			glm::vec3 p2 = VertexPosition(vertices, indices[t * 3 + 2]);
+			glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+			float area = 0.5f * glm::length(normal);
+			glm::vec3 center = (p0 + p1 + p2) / 3.0f;
+
+			clusterCenters[c] += center * area;
+			clusterNormals[c] += normal;
+			clusterAreas[c] += area;
+			meshCenter += center * area;
+			meshArea += area;
+		}
+	}
+	if (meshArea <= 0.0f)
+	{
+		return;
+	}
+	meshCenter /= meshArea;
+
+	std::vector<float> sortKeys(nClusters, 0.0f);
+	std::vector<GLuint> clusterOrder(nClusters);
+	for (size_t c = 0; c < nClusters; c++)
+	{
+		clusterOrder[c] = (GLuint)c;
+
+		float normalLength = glm::length(clusterNormals[c]);
+		if ((clusterAreas[c] > 0.0f) && (normalLength > 0.0f))
+		{
+			glm::vec3 center = clusterCenters[c] / clusterAreas[c];
+			sortKeys[c] = glm::dot(center - meshCenter, clusterNormals[c] / normalLength);
+		}
+	}
+
+	std::stable_sort(clusterOrder.begin(), clusterOrder.end(),
+		[&sortKeys](GLuint a, GLuint b) { return(sortKeys[a] > sortKeys[b]); });
+
+	std::vector<GLuint> output;
+	output.reserve(nTriangles * 3);
+	for (size_t i = 0; i < nClusters; i++)
+	{
+		GLuint c = clusterOrder[i];
+		output.insert(output.end(), indices + clusterStarts[c] * 3, indices + clusterStarts[c + 1] * 3);
+	}
+
+	memcpy(indices, output.data(), sizeof(GLuint) * nTriangles * 3);
+}
+
+/***********************************************************
+ *  OptimizeVertexFetch()
+ *
+ *  This method is used to reorder the vertices in the order
+ *  they are first used by the indices, so that the vertices
+ *  are fetched from memory mostly in sequence.  Vertices
+ *  that are not used are moved to the end.
+ ***********************************************************/
+void MeshOptimizer::OptimizeVertexFetch(
+	GLfloat* vertices,
+	GLuint nVertices,
+	GLuint* indices,
+	GLuint nIndices)
+{
+	const GLuint unused = 0xFFFFFFFF;
+	std::vector<GLuint> remap(nVertices, unused);
+	GLuint next = 0;
+
+	for (GLuint i = 0; i < nIndices; i++)
+	{
+		GLuint vertex = indices[i];
+		if (remap[vertex] == unused)
+		{
+			remap[vertex] = next++;
+		}
+		indices[i] = remap[vertex];
+	}
+	for (GLuint v = 0; v < nVertices; v++)
+	{
+		if (remap[v] == unused)
+		{
+			remap[v] = next++;
+		}
+	}
+
+	std::vector<GLfloat> reordered(nVertices * g_FloatsPerMeshVertex);
+	for (GLuint v = 0; v < nVertices; v++)
+	{
+		memcpy(&reordered[remap[v] * g_FloatsPerMeshVertex], vertices + v * g_FloatsPerMeshVertex,
+			sizeof(GLfloat) * g_FloatsPerMeshVertex);
+	}
+	memcpy(vertices, reordered.data(), sizeof(GLfloat) * nVertices * g_FloatsPerMeshVertex);
+}
+
+/***********************************************************
+ *  AnalyzeVertexCache()
+ *
+ *  This method is used to measure an index order with a
+ *  simulated FIFO vertex cache.  The ACMR is the number of
+ *  cache misses per triangle and the ATVR the number of
+ *  cache misses per vertex that is used.
+ ***********************************************************/
+MeshOptimizer::CACHE_STATS MeshOptimizer::AnalyzeVertexCache(
+	const GLuint* indices,
+	GLuint nIndices,
+	GLuint nVertices)
+{
+	CACHE_STATS stats;
+	stats.ACMR = 0.0f;
+	stats.ATVR = 0.0f;
+
+	GLuint nTriangles = nIndices / 3;
+	if (nTriangles == 0)
+	{
+		return(stats);
+	}
+
+	std::vector<GLuint> missTimes(nVertices, 0);
+	std::vector<bool> bUsed(nVertices, false);
+	GLuint time = g_AnalyzeCacheSize + 1;
+	GLuint misses = 0;
+	GLuint usedVertices = 0;
+
+	for (GLuint i = 0; i < nTriangles * 3; i++)
+	{
+		GLuint vertex = indices[i];
+		if (time - missTimes[vertex] > g_AnalyzeCacheSize)
+		{
+			missTimes[vertex] = time++;
+			misses++;
+		}
+		if (bUsed[vertex] == false)
+		{
+			bUsed[vertex] = true;
+			usedVertices++;
+		}
+	}
+
+	stats.ACMR = (float)misses / (float)nTriangles;
+	stats.ATVR = (float)misses / (float)usedVertices;
+
+	return(stats);
+}
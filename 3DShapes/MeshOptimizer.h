@@ -0,0 +1,70 @@
+///////////////////////////////////////////////////////////////////////////////
+// meshoptimizer.h
+// ============
+// reorder the triangles and vertices of indexed meshes for the post-transform
+// vertex cache, for less overdraw and for vertex fetch locality
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+/***********************************************************
+ *  MeshOptimizer
+ *
+ *  This class contains the code for optimizing the index
+ *  and vertex order of the meshes before they are uploaded.
+ *  The vertices use the interleaved position, normal and
+ *  texture coordinate layout of the ShapeMeshes meshes, and
+ *  the indices are triangle lists.
+ ***********************************************************/
+class MeshOptimizer
+{
+public:
+	// vertex cache efficiency of an index order
+	struct CACHE_STATS
+	{
+		float ACMR;		// vertex shader runs per triangle, 0.5 at best
+		float ATVR;		// vertex shader runs per used vertex, 1.0 at best
+	};
+
+	// optimize a mesh whose indices are split into consecutive
+	// ranges that are drawn on their own - the triangles only
+	// move within their range, and the vertices are reordered
+	// for all of the ranges
+	static void OptimizeMesh(
+		GLfloat* vertices,
+		GLuint nVertices,
+		GLuint* indices,
+		GLuint nIndices,
+		const GLuint* rangeCounts,
+		int nRanges);
+
+	// reorder the triangles for post-transform vertex cache hits
+	static void OptimizeVertexCache(
+		GLuint* indices,
+		GLuint nIndices,
+		GLuint nVertices);
+	// reorder clusters of cache optimized triangles so that the
+	// triangles facing out of the mesh are drawn first
+	static void OptimizeOverdraw(
+		GLuint* indices,
+		GLuint nIndices,
+		const GLfloat* vertices,
+		GLuint nVertices);
+	// reorder the vertices in the order the indices first use
+	// them and rewrite the indices to match
+	static void OptimizeVertexFetch(
+		GLfloat* vertices,
+		GLuint nVertices,
+		GLuint* indices,
+		GLuint nIndices);
+
+	// simulate a FIFO vertex cache to measure an index order
+	static CACHE_STATS AnalyzeVertexCache(
+		const GLuint* indices,
+		GLuint nIndices,
+		GLuint nVertices);
+};
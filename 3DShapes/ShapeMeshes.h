@@ -14,6 +14,10 @@
 
 #include <glm/glm.hpp>
 
+#include <vector>
+
+#include "MeshGenerator.h"
+
 /***********************************************************
  *  ShapeMeshes
  *
@@ -25,33 +29,152 @@ class ShapeMeshes
 public:
 	// constructor
 	ShapeMeshes();
+	// destructor
+	~ShapeMeshes();
+
+	// per-instance values read by the instanced draw methods,
+	// at attribute locations 3-6 (model), 7 (color) and 8 (UV scale)
+	struct INSTANCE_DATA
+	{
+		glm::mat4 model;
+		glm::vec4 color;
+		glm::vec2 UVscale;
+	};
+
+	// the shapes stored in the geometry arena - meshes added
+	// with AddMesh() get the IDs following shape_count
+	enum ShapeID
+	{
+		shape_box,
+		shape_cone,
+		shape_cylinder,
+		shape_plane,
+		shape_prism,
+		shape_pyramid3,
+		shape_pyramid4,
+		shape_sphere,
+		shape_half_sphere,
+		shape_tapered_cylinder,
+		shape_torus,
+		shape_half_torus,
+		shape_count
+	};
+
+	// parameters of one indirect draw, in the layout that
+	// glMultiDrawElementsIndirect reads them
+	struct DRAW_INDIRECT_COMMAND
+	{
+		GLuint count;
+		GLuint instanceCount;
+		GLuint firstIndex;
+		GLint baseVertex;
+		GLuint baseInstance;
+	};
+
+	// layouts the arena vertices can be uploaded in - the
+	// packed layout stores 16-bit positions scaled to the
+	// bounds of each mesh, octahedral 16-bit normals and
+	// half float texture coordinates in 16 bytes
+	enum VertexFormat
+	{
+		format_float,
+		format_packed
+	};
 
 private:
 
-	// stores the GL data relative to a given mesh
+	// index sub-ranges of the meshes that have caps, in the
+	// order they are laid out - the top cap is stored twice so
+	// that every combination of parts is one contiguous range
+	enum MeshRange
+	{
+		range_top,
+		range_sides,
+		range_bottom,
+		range_top_copy,
+		range_count
+	};
+
+	// stores the location of a given mesh in the geometry arena
 	struct GLMesh
 	{
-		GLuint vao;         // Handle for the vertex array object
-		GLuint vbos[2];     // Handles for the vertex buffer objects
+		GLint baseVertex;	// First vertex of the mesh in the vertex buffer
+		GLuint firstIndex;	// First index of the mesh in the index buffer
 		GLuint nVertices;	// Number of vertices for the mesh
 		GLuint nIndices;    // Number of indices for the mesh
+		float boundingRadius;	// Radius around the origin that contains the mesh
+		glm::vec3 boundsMin;	// Corners of the box around the mesh
+		glm::vec3 boundsMax;
+		int nextLOD;		// Shape ID of the next coarser level of detail, or -1
+		glm::vec4 decode;	// Center (xyz) and scale (w) of the packed positions
+		bool bHasParts;		// Whether the mesh has top, sides and bottom ranges
+		GLuint partFirst[range_count + 1];	// First index of each range, from firstIndex, and the end
 	};
 
-	// the available 3D shapes
-	GLMesh m_BoxMesh;
-	GLMesh m_ConeMesh;
-	GLMesh m_CylinderMesh;
-	GLMesh m_PlaneMesh;
-	GLMesh m_PrismMesh;
-	GLMesh m_Pyramid3Mesh;
-	GLMesh m_Pyramid4Mesh;
-	GLMesh m_SphereMesh;
-	GLMesh m_TaperedCylinderMesh;
-	GLMesh m_TorusMesh;
+	// one vertex of the packed layout
+	struct PACKED_VERTEX
+	{
+		GLshort position[4];	// SNORM16 position in the mesh bounds, w unused
+		GLshort normal[2];		// SNORM16 octahedral normal
+		GLhalf texCoord[2];		// half float texture coordinates
+	};
+
+	// the available 3D shapes, indexed by shape ID
+	std::vector<GLMesh> m_meshes;
+
+	// vertex and index data of every mesh, kept so that the
+	// buffers can be rebuilt when a mesh is added
+	std::vector<GLfloat> m_arenaVertices;
+	std::vector<GLuint> m_arenaIndices;
+
+	// the single VAO and buffers shared by every mesh
+	GLuint m_arenaVAO;
+	GLuint m_arenaVBO;
+	GLuint m_arenaIBO;
+	bool m_bArenaDirty;
+	// set to print the vertex cache statistics of the meshes
+	static bool s_bReportMeshStats;
+	// layout of the vertices in the arena vertex buffer
+	VertexFormat m_vertexFormat;
 
 	bool m_bMemoryLayoutDone;
 
+	// buffer holding the per-instance values, shared by every mesh
+	GLuint m_instanceBuffer;
+	// number of instances the instance buffer has room for
+	GLsizei m_instanceCapacity;
+	// copy of the instance values, used to upload the instances
+	// of each draw when base instance is not supported
+	std::vector<INSTANCE_DATA> m_instanceData;
+	// buffer holding the position decode of the mesh drawn by
+	// each instance, used with the packed vertex layout
+	GLuint m_decodeBuffer;
+	std::vector<glm::vec4> m_instanceDecode;
+
+	// commands of the direct draw methods, kept so that
+	// drawing does not allocate
+	std::vector<DRAW_INDIRECT_COMMAND> m_shapeCommands;
+
+	// buffer holding the commands of the multi-draw calls
+	GLuint m_indirectBuffer;
+	// number of commands the indirect buffer has room for
+	GLsizei m_indirectCapacity;
+
+	// optional features of the GL context
+	bool m_bBaseInstance;
+	bool m_bMultiDrawIndirect;
+
 public:
+	// select the layout the arena vertices are uploaded in -
+	// with the packed layout the shaders have to decode the
+	// normals (bPackedVertices) and apply the per-instance
+	// position decode at attribute location 9
+	void SetVertexFormat(VertexFormat format);
+	VertexFormat GetVertexFormat() const { return(m_vertexFormat); }
+	// print the vertex cache statistics of every mesh before
+	// and after it is optimized
+	static void SetReportMeshStats(bool bReport) { s_bReportMeshStats = bReport; }
+
 	// methods for loading the shape mesh data 
 	// into memory
 	void LoadBoxMesh();
@@ -87,6 +210,107 @@ public:
 	void DrawTorusMesh();
 	void DrawHalfTorusMesh();
 
+	// upload the per-instance values used by the
+	// instanced draw methods
+	void SetInstanceData(
+		const INSTANCE_DATA* instances,
+		GLsizei count);
+
+	// methods for drawing many copies of a shape mesh
+	// with one draw call - firstInstance selects where
+	// the copies start in the uploaded instance data
+	void DrawBoxMeshInstanced(
+		GLsizei count,
+		GLuint firstInstance = 0);
+	void DrawConeMeshInstanced(
+		GLsizei count,
+		GLuint firstInstance = 0,
+		bool bDrawBottom = true);
+	void DrawCylinderMeshInstanced(
+		GLsizei count,
+		GLuint firstInstance = 0,
+		bool bDrawTop = true,
+		bool bDrawBottom = true,
+		bool bDrawSides = true);
+	void DrawPlaneMeshInstanced(
+		GLsizei count,
+		GLuint firstInstance = 0);
+	void DrawPrismMeshInstanced(
+		GLsizei count,
+		GLuint firstInstance = 0);
+	void DrawPyramid3MeshInstanced(
+		GLsizei count,
+		GLuint firstInstance = 0);
+	void DrawPyramid4MeshInstanced(
+		GLsizei count,
+		GLuint firstInstance = 0);
+	void DrawSphereMeshInstanced(
+		GLsizei count,
+		GLuint firstInstance = 0);
+	void DrawHalfSphereMeshInstanced(
+		GLsizei count,
+		GLuint firstInstance = 0);
+	void DrawTaperedCylinderMeshInstanced(
+		GLsizei count,
+		GLuint firstInstance = 0,
+		bool bDrawTop = true,
+		bool bDrawBottom = true,
+		bool bDrawSides = true);
+	void DrawTorusMeshInstanced(
+		GLsizei count,
+		GLuint firstInstance = 0);
+	void DrawHalfTorusMeshInstanced(
+		GLsizei count,
+		GLuint firstInstance = 0);
+
+	// add a mesh of interleaved position, normal and texture
+	// coordinate vertices to the geometry arena and return
+	// its shape ID
+	int AddMesh(
+		const GLfloat* verts,
+		GLuint nVertices,
+		const GLuint* indices,
+		GLuint nIndices);
+
+	// append the indirect draw commands for count instances
+	// of a shape, or the selected parts of it
+	void AddIndirectDraws(
+		int shape,
+		GLuint count,
+		GLuint firstInstance,
+		std::vector<DRAW_INDIRECT_COMMAND>& commands,
+		bool bDrawTop = true,
+		bool bDrawBottom = true,
+		bool bDrawSides = true);
+	// get the shape ID of a level of detail of a shape,
+	// where level 0 is the shape itself
+	int GetLODShape(int shape, int lod) const;
+	// get the radius around the origin that contains a shape
+	float GetBoundingRadius(int shape) const;
+	// get the center and half extents of the box around
+	// the untransformed shape
+	void GetBoundingBox(
+		int shape,
+		glm::vec3& center,
+		glm::vec3& extent) const;
+
+	// submit indirect draw commands with one multi-draw call
+	void DrawIndirect(
+		const DRAW_INDIRECT_COMMAND* commands,
+		GLsizei count);
+	// submit up to maxCount indirect draw commands that are
+	// already in a buffer, reading the number of commands to
+	// draw from a second buffer (GL 4.6)
+	void DrawIndirectCount(
+		GLuint commandBuffer,
+		GLintptr commandOffset,
+		GLuint countBuffer,
+		GLintptr countOffset,
+		GLsizei maxCount);
+	// buffer holding the per-instance values, which the draws
+	// read starting at the base instance of each command
+	GLuint GetInstanceBuffer() const { return(m_instanceBuffer); }
+
 
 private:
 
@@ -95,7 +319,62 @@ private:
 	glm::vec3 CalculateTriangleNormal(
 		glm::vec3 px, glm::vec3 py, glm::vec3 pz);
 
+	// called to optimize a loaded mesh and store it in the
+	// geometry arena - the triangles only move within the
+	// passed in index ranges, which are drawn on their own
+	void StoreMesh(
+		int shape,
+		const GLfloat* verts,
+		GLuint nVertices,
+		const GLuint* indices,
+		GLuint nIndices,
+		const GLuint* rangeCounts = NULL,
+		int nRanges = 0);
+	// called to store one level of detail of a generated
+	// mesh and return its shape ID - a mesh whose first half
+	// is drawn on its own keeps its halves apart
+	int StoreGeneratedMesh(
+		int shape,
+		int lod,
+		const MeshGenerator::MESH_DATA& mesh,
+		bool bSplitHalves = false);
+	// called to add a mesh at the end of the level of
+	// detail chain of a shape and return its shape ID
+	int AppendLOD(int shape);
+	// called to set the top, sides, bottom and top copy index
+	// ranges of a stored mesh, which are laid out in that order
+	void SetMeshParts(
+		int shape,
+		GLuint nTopIndices,
+		GLuint nSidesIndices,
+		GLuint nBottomIndices);
+
+	// called to create and fill the geometry arena buffers
+	void UploadArena();
+	// called to convert the arena vertices to the packed layout
+	void PackArenaVertices(std::vector<PACKED_VERTEX>& packed) const;
+	// called to set the position decode of the instances
+	// that draw a shape
+	void SetInstanceDecode(
+		int shape,
+		GLuint firstInstance,
+		GLuint count);
+	// called to draw instances of a shape, or the selected
+	// parts of it
+	void DrawShape(
+		int shape,
+		GLsizei count,
+		GLuint firstInstance,
+		bool bDrawTop = true,
+		bool bDrawBottom = true,
+		bool bDrawSides = true);
+	// called to draw one indirect command directly
+	void DrawCommand(const DRAW_INDIRECT_COMMAND& command);
+
 	// called to set the memory layout 
 	// template for shader data
 	void SetShaderMemoryLayout();
+	// called to set the memory layout of the
+	// per-instance shader data
+	void SetInstanceMemoryLayout();
 };
\ No newline at end of file
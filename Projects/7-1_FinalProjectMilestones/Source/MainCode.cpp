@@ -1,5 +1,8 @@
 #include <iostream>         // error handling and output
 #include <cstdlib>          // EXIT_FAILURE
+#include <cstring>          // strcmp, strncmp
+#include <cmath>            // placement of the local lights
+#include <vector>           // timer queries of the benchmark
 
 #include <GL/glew.h>        // GLEW library
 #include "GLFW/glfw3.h"     // GLFW library
@@ -13,6 +16,13 @@
 #include "ViewManager.h"
 #include "ShapeMeshes.h"
 #include "ShaderManager.h"
+#include "UniformBufferManager.h"
+#include "ShadowManager.h"
+#include "ShadowAtlas.h"
+#include "PointShadowMaps.h"
+#include "LightClusters.h"
+#include "ShaderVariants.h"
+#include "ProgramCache.h"
 
 // Namespace for declaring global variables
 namespace
@@ -28,14 +38,45 @@ namespace
 	// shader manager object for dynamic interaction with the shader code
 	ShaderManager* g_ShaderManager = nullptr;
 	ShaderManager* g_DepthShaderManager = nullptr;
+	// variants of the main shader program, built for the features
+	// of the draws that use them
+	ShaderVariants* g_ShaderVariants = nullptr;
+	// binaries of the linked shader programs, kept between launches
+	ProgramCache* g_ProgramCache = nullptr;
+	// uniform buffers shared by the main and depth shader programs
+	UniformBufferManager* g_UniformBufferManager = nullptr;
+	// shadow map of the scene light, redrawn only when it changes
+	ShadowManager* g_ShadowManager = nullptr;
+	// shadow tiles of the other lights, packed into one atlas
+	ShadowAtlas* g_ShadowAtlas = nullptr;
+	// shadow cubes of the lights that are among the objects they light
+	PointShadowMaps* g_PointShadows = nullptr;
+	// local lights, assigned to the clusters of the view volume
+	LightClusters* g_LightClusters = nullptr;
 	// view manager object for managing the 3D view setup and projection to 2D
 	ViewManager* g_ViewManager = nullptr;
+
+	// paths of the main shader program, which is built once for
+	// each shadow filter
+	const char* const g_VertexShaderPath = "../../Utilities/shaders/vertexShader.glsl";
+	const char* const g_FragmentShaderPath = "../../Utilities/shaders/fragShader.glsl";
+	// directory of the compute shaders of the shadow filters and
+	// the light clusters
+	const char* const g_ComputeShaderDirectory = "../../Utilities/shaders/";
+	// directory the program binaries are cached in
+	const char* const g_ProgramCacheDirectory = "ShaderCache/";
+	// frames drawn with each filter by the shadow benchmark
+	const int g_BenchmarkFrames = 120;
 }
 
 // Function declarations - all functions that are called manually
 // need to be pre-declared at the beginning of the source code.
 bool InitializeGLFW();
 bool InitializeGLEW();
+bool LoadMainShader(ShadowManager::ShadowFilter filter, bool bWait = true);
+void RunShadowBenchmark();
+void AddLocalLights(int nLights);
+void ReloadChangedShaders();
 
 
 /***********************************************************
@@ -52,12 +93,87 @@ int main(int argc, char* argv[])
 		return(EXIT_FAILURE);
 	}
 
+	// --shadow-filter=<name> selects how the shadows are filtered,
+	// --shadow-benchmark times every filter and then exits, and
+	// --point-shadows gives every other light a shadow cube,
+	// --local-lights=<n> scatters n small lights over the table,
+	// --no-shader-variants draws with the uniforms of the main shader,
+	// --no-program-cache compiles every shader from source,
+	// --watch-shaders reloads the shaders when their files change, and
+	// --mesh-stats prints the vertex cache statistics of the meshes
+	ShadowManager::ShadowFilter shadowFilter = ShadowManager::filter_hardware;
+	bool bShadowBenchmark = false;
+	bool bPointShadows = false;
+	int nLocalLights = 0;
+	bool bShaderVariants = true;
+	bool bProgramCache = true;
+	bool bWatchShaders = false;
+	for (int i = 1; i < argc; i++)
+	{
+		const char* filterOption = "--shadow-filter=";
+		if (strncmp(argv[i], filterOption, strlen(filterOption)) == 0)
+		{
+			const char* filterName = argv[i] + strlen(filterOption);
+			bool bFound = false;
+			for (int filter = 0; filter < ShadowManager::filter_count; filter++)
+			{
+				if (strcmp(filterName, ShadowManager::GetFilterName((ShadowManager::ShadowFilter)filter)) == 0)
+				{
+					shadowFilter = (ShadowManager::ShadowFilter)filter;
+					bFound = true;
+				}
+			}
+			if (bFound == false)
+			{
+				std::cout << "ERROR: unknown shadow filter " << filterName << ", using hardware" << std::endl;
+			}
+		}
+		else if (strcmp(argv[i], "--shadow-benchmark") == 0)
+		{
+			bShadowBenchmark = true;
+		}
+		else if (strcmp(argv[i], "--point-shadows") == 0)
+		{
+			bPointShadows = true;
+		}
+		else if (strncmp(argv[i], "--local-lights=", strlen("--local-lights=")) == 0)
+		{
+			nLocalLights = atoi(argv[i] + strlen("--local-lights="));
+		}
+		else if (strcmp(argv[i], "--no-shader-variants") == 0)
+		{
+			bShaderVariants = false;
+		}
+		else if (strcmp(argv[i], "--no-program-cache") == 0)
+		{
+			bProgramCache = false;
+		}
+		else if (strcmp(argv[i], "--watch-shaders") == 0)
+		{
+			bWatchShaders = true;
+		}
+		else if (strcmp(argv[i], "--mesh-stats") == 0)
+		{
+			ShapeMeshes::SetReportMeshStats(true);
+		}
+	}
+
 	// try to create a new shader manager object
 	g_ShaderManager = new ShaderManager();
 	g_DepthShaderManager = new ShaderManager();
+	// the variants are compiled from the files of the main shader
+	// when they are first drawn with
+	if (bShaderVariants == true)
+	{
+		g_ShaderVariants = new ShaderVariants();
+		g_ShaderVariants->SetSources(g_VertexShaderPath, g_FragmentShaderPath);
+	}
+	// try to create a new uniform buffer manager object
+	g_UniformBufferManager = new UniformBufferManager();
 	// try to create a new view manager object
 	g_ViewManager = new ViewManager(
-		g_ShaderManager);
+		g_ShaderManager,
+		g_UniformBufferManager);
 
 	// try to create the main display window
 	g_Window = g_ViewManager->CreateDisplayWindow(WINDOW_TITLE);
@@ -68,12 +184,40 @@ int main(int argc, char* argv[])
 		return(EXIT_FAILURE);
 	}
 
-	// load the shader code from the external GLSL files
-	g_ShaderManager->LoadShaders(
-		"../../Utilities/shaders/vertexShader.glsl",
-		// "../../Utilities/shaders/fragmentShader.glsl");
-		// Comment out above line and uncomment below line (and vice versa) to use other frag shader
-		"Source/fragShader.glsl");
+	// the programs linked on an earlier launch by the same driver
+	// are loaded from their binaries instead of being compiled
+	if (bProgramCache == true)
+	{
+		g_ProgramCache = new ProgramCache(g_ProgramCacheDirectory);
+		if (g_ProgramCache->IsSupported() == true)
+		{
+			ShaderManager::SetProgramCache(g_ProgramCache);
+		}
+		else
+		{
+			std::cout << "INFO: the driver has no program binary formats, compiling the shaders from source" << std::endl;
+		}
+	}
+
+	// let the driver compile on threads of its own, so that the
+	// programs started here compile while the buffers, shadow maps,
+	// textures and meshes are created
+	if (ShaderManager::SetParallelCompile(0xFFFFFFFF) == false)
+	{
+		std::cout << "INFO: the driver has no parallel shader compile, compiling the shaders in turn" << std::endl;
+	}
+
+	// load the shader code from the external GLSL files, built
+	// with the lookups of the selected shadow filter
+	// (fragmentShader.glsl is the other, unshadowed frag shader)
+	LoadMainShader(shadowFilter, false);
+
+	// the geometry shader draws every cascade, or every face of a
+	// cube, in one layered pass
+	g_DepthShaderManager->BeginLoadShaders(
+		"Source/shaders/depthVertexShader.glsl",
+		"Source/shaders/depthFragShader.glsl",
+		"Source/shaders/depthGeometryShader.glsl");
 
 	// Attempt at trying to use the working shaders from OpenGL tutorial
 	// needs to have shadowMap and diffuseTexture set in while loop
@@ -82,106 +226,159 @@ int main(int argc, char* argv[])
 	//	// "../../Utilities/shaders/fragmentShader.glsl");
 	//	// Comment out above line and uncomment below line (and vice versa) to use other frag shader
 	//	"Source/shaders/3.1.3.shadow_mapping.fs");
-	g_ShaderManager->use();
+
+	// create the uniform buffers, which the blocks of the shaders
+	// are connected to once they are linked
+	g_UniformBufferManager->CreateUniformBuffers();
 
 	// Moved to outside 
 	glEnable(GL_DEPTH_TEST);
 
-	// configure depth map FBO
-	const unsigned int SHADOW_WIDTH = 1024, SHADOW_HEIGHT = 1024;
-	unsigned int depthMapFBO;
-	glGenFramebuffers(1, &depthMapFBO);
-
-	// create depth texture
-	unsigned int depthMap;
-	glGenTextures(1, &depthMap);
-	glBindTexture(GL_TEXTURE_2D, depthMap);
-	glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT, SHADOW_WIDTH, SHADOW_HEIGHT, 0, GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
-	float borderColor[] = { 1.0f, 1.0f, 1.0f, 1.0f };
-	glTexParameterfv(GL_TEXTURE_2D, GL_TEXTURE_BORDER_COLOR, borderColor);
-
-	// attach depth texture as FBO framebuffer
-	glBindFramebuffer(GL_FRAMEBUFFER, depthMapFBO);
-	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, depthMap, 0);
-	glDrawBuffer(GL_NONE);
-	glReadBuffer(GL_NONE);
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	// create the shadow cascades of the scene light - four 512x512
+	// layers take the memory of a single 1024x1024 map
+	const unsigned int SHADOW_WIDTH = 512, SHADOW_HEIGHT = 512;
+	const int SHADOW_CASCADES = 4;
+	g_ShadowManager = new ShadowManager(g_UniformBufferManager);
+	g_ShadowManager->CreateShadowMap(SHADOW_WIDTH, SHADOW_HEIGHT, SHADOW_CASCADES);
+	g_ShadowManager->LoadFilterShaders(g_ComputeShaderDirectory);
+	if (g_ShadowManager->SetFilter(shadowFilter) == false)
+	{
+		// the fragment shader has to match the filter in use
+		LoadMainShader(ShadowManager::filter_hardware, false);
+	}
+
+	// the other lights share one atlas - their tiles are sized by
+	// how much of the screen they light, from 128 to 1024 texels
+	g_ShadowAtlas = new ShadowAtlas(g_UniformBufferManager);
+	g_ShadowAtlas->CreateAtlas(2048, 128, 1024);
+	// a light among the objects it lights casts shadows all around
+	// it, into a 512x512 cube drawn in one pass
+	g_PointShadows = new PointShadowMaps(g_UniformBufferManager);
+	g_PointShadows->CreateCubeMaps(512, TOTAL_LIGHTS - 1);
+	// the local lights are only looped over in the clusters they
+	// reach, so their number does not change the cost of a pixel
+	g_LightClusters = new LightClusters(g_UniformBufferManager);
+	if (g_LightClusters->LoadShaders(g_ComputeShaderDirectory) == false)
+	{
+		std::cout << "ERROR: could not load the light cluster shader, local lights are off" << std::endl;
+	}
+	g_LightClusters->CreateClusters();
+	AddLocalLights(nLocalLights);
 
 	// Load shaders for depth map and debugging
 	//Shader simpleDepthShader("Source/shaders/depthVertexShader.glsl", "Source/shaders/depthFragShader.glsl");
 	//Shader debugDepthQuad("Source/shaders/debugQuadVertexShader.glsl", "Source/shaders/debugQuadFragShader.glsl");
 
-	g_DepthShaderManager->LoadShaders(
-		"Source/shaders/depthVertexShader.glsl",
-		"Source/shaders/depthFragShader.glsl");
-
-	// try to create a new scene manager object and prepare the 3D scene
-	g_SceneManager = new SceneManager(g_ShaderManager, g_DepthShaderManager);
-	g_SceneManager->PrepareScene();
-
-	// Calculate lightspace matrix for shaders
-	float near_plane = 0.0f, far_plane = 40.0f;
-
-	glm::mat4 lightProjection = glm::ortho(
-		-10.0f, 10.0f, -10.0f, 10.0f, near_plane, far_plane);
-
-	glm::mat4 lightView = glm::lookAt(
-		glm::vec3(-10.0f, 4.0f, 2.0f),
-		glm::vec3(0.0f, 0.0f, 0.0f),
-		glm::vec3(0.0f, 1.0f, 0.0f));
-
-	glm::mat4 lightSpaceMatrix = lightProjection * lightView;
-
-	// Pass in matrix to main shader and depth shader
+	// the main and depth programs are needed from here on
+	g_ShaderManager->FinishLoadShaders();
 	g_ShaderManager->use();
-	g_ShaderManager->setMat4Value("lightSpaceMatrix", lightSpaceMatrix);
-
-	g_DepthShaderManager->use();
-	g_DepthShaderManager->setMat4Value("lightSpaceMatrix", lightSpaceMatrix);
-
-	// Clear the frame and z buffers
-	glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
-	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
-	// Render to depth map
-	glViewport(0, 0, SHADOW_WIDTH, SHADOW_HEIGHT);
-	glBindFramebuffer(GL_FRAMEBUFFER, depthMapFBO);
-	glClear(GL_DEPTH_BUFFER_BIT);
-
-	g_SceneManager->RenderScene("depthMap");
-	//g_SceneManager->RenderSceneFromLight(simpleDepthShader);
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
-
-	// Clear the frame and z buffers
-	glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
-	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+	g_UniformBufferManager->BindUniformBlocks(g_ShaderManager);
+	g_DepthShaderManager->FinishLoadShaders();
+	g_UniformBufferManager->BindUniformBlocks(g_DepthShaderManager);
+
+	// try to create a new scene manager object and prepare the 3D scene,
+	// with the variants of the main shader compiling in the meantime
+	g_SceneManager = new SceneManager(g_ShaderManager, g_DepthShaderManager, g_UniformBufferManager, g_ShadowManager, g_ShadowAtlas, g_PointShadows);
+	g_SceneManager->SetShaderVariants(g_ShaderVariants);
+	g_SceneManager->PrepareScene();
+	// cull the draws with compute shaders when the context supports it
+	g_SceneManager->SetGPUCulling(true);
+
+	// the light shines from its position towards the origin, and
+	// the cascades reach as far as the fixed light projection did
+	float far_plane = 40.0f;
+	glm::vec3 lightPosition = glm::vec3(-10.0f, 4.0f, 2.0f);
+	g_ShadowManager->SetLightDirection(glm::vec3(0.0f, 0.0f, 0.0f) - lightPosition);
+	g_ShadowManager->SetShadowDistance(far_plane);
+	// the other lights cast shadows over the table and the objects
+	// on it - a light inside of that sphere has casters on every
+	// side, so it gets a cube that reaches past the far side of the
+	// sphere, and one outside of it a tile of the atlas that looks
+	// at the sphere - a light without diffuse color gets neither
+	const glm::vec3 shadowBoundsCenter = glm::vec3(0.0f, 1.0f, 3.0f);
+	const float shadowBoundsRadius = 12.0f;
+	const UniformBufferManager::LIGHT_BLOCK& lights = g_UniformBufferManager->GetLightData();
+	for (int light = 1; light < TOTAL_LIGHTS; light++)
+	{
+		float distance = glm::length(lights.lightSources[light].position - shadowBoundsCenter);
+		if ((bPointShadows == true) || (distance < shadowBoundsRadius))
+		{
+			g_PointShadows->SetPointLight(light, distance + shadowBoundsRadius);
+		}
+		else
+		{
+			g_ShadowAtlas->SetLightBounds(light, shadowBoundsCenter, shadowBoundsRadius);
+		}
+	}
 
 	// Load scene textures, including depth map
 	g_ShaderManager->use();
+	unsigned int depthMap = g_ShadowManager->GetDepthMap();
 	g_SceneManager->LoadSceneTextures(depthMap);
 	unsigned int depthMapID = g_SceneManager->GetDepthMapSlot();
 	g_ShaderManager->setSampler2DValue("depthMap", depthMapID);
 
+	if (bShadowBenchmark == true)
+	{
+		RunShadowBenchmark();
+	}
+
 	// loop will keep running until the application is closed 
 	// or until an error has occurred
-	while (!glfwWindowShouldClose(g_Window))
+	while ((bShadowBenchmark == false) && !glfwWindowShouldClose(g_Window))
 	{
 
+		// swap in the shader programs whose files were changed and
+		// that compiled again in the background
+		if (bWatchShaders == true)
+		{
+			ReloadChangedShaders();
+		}
+
 		// Clear the frame and z buffers
 		glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
 		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
 		// convert from 3D object space to 2D view
 		g_ViewManager->PrepareSceneView();
+		g_SceneManager->SetBlinnShading(g_ViewManager->GetBlinnShading());
+		// fit the shadow cascades to the new camera view
+		g_ShadowManager->UpdateCascades();
+		// size and place the shadow tiles of the other lights, and
+		// fit the cubes to the lights that have one
+		g_ShadowAtlas->UpdateTiles();
+		g_PointShadows->UpdateLights();
+		// upload the uniform blocks that changed this frame
+		g_UniformBufferManager->UploadChanges();
+		// assign the local lights to the clusters of the new view
+		g_LightClusters->UpdateClusters();
+
+		// draw the shadow map again when the light or a caster
+		// in its view has changed, otherwise keep the last one
+		g_DepthShaderManager->use();
+		g_SceneManager->RenderScene("depthMap");
 
 		// refresh the 3D scene
 		g_ShaderManager->use();
 		g_SceneManager->RenderScene("main");
 
+		// pick the object in the center of the view on a click,
+		// from the draws of the pass that was just recorded
+		glm::vec3 pickOrigin;
+		glm::vec3 pickDirection;
+		if (g_ViewManager->GetPickRay(pickOrigin, pickDirection) == true)
+		{
+			int picked = g_SceneManager->PickObject(pickOrigin, pickDirection);
+			if (picked >= 0)
+			{
+				std::cout << "INFO: picked draw " << picked << std::endl;
+			}
+			else
+			{
+				std::cout << "INFO: no object picked" << std::endl;
+			}
+		}
+
 		// render Depth map to quad for visual debugging
 		// ---------------------------------------------
 		//debugDepthQuad.use();
@@ -218,6 +415,54 @@ int main(int argc, char* argv[])
 		delete g_DepthShaderManager;
 		g_DepthShaderManager = NULL;
 	}
+	if (NULL != g_ShaderVariants)
+	{
+		std::cout << "INFO: " << g_ShaderVariants->GetVariantCount() << " shader variants compiled" << std::endl;
+		delete g_ShaderVariants;
+		g_ShaderVariants = NULL;
+	}
+	if (NULL != g_ShadowManager)
+	{
+		std::cout << "INFO: " << g_ShadowManager->GetRenderedPasses() << " shadow passes drawn, "
+			<< g_ShadowManager->GetSkippedPasses() << " skipped" << std::endl;
+		delete g_ShadowManager;
+		g_ShadowManager = NULL;
+	}
+	if (NULL != g_ShadowAtlas)
+	{
+		std::cout << "INFO: " << g_ShadowAtlas->GetRenderedTiles() << " shadow atlas tiles drawn, "
+			<< g_ShadowAtlas->GetReusedTiles() << " reused" << std::endl;
+		delete g_ShadowAtlas;
+		g_ShadowAtlas = NULL;
+	}
+	if (NULL != g_PointShadows)
+	{
+		std::cout << "INFO: " << g_PointShadows->GetRenderedFaces() << " shadow cube faces drawn, "
+			<< g_PointShadows->GetSkippedFaces() << " skipped" << std::endl;
+		delete g_PointShadows;
+		g_PointShadows = NULL;
+	}
+	if (NULL != g_LightClusters)
+	{
+		std::cout << "INFO: " << g_LightClusters->GetAssignedPasses() << " light cluster assignments run, "
+			<< g_LightClusters->GetReusedPasses() << " reused" << std::endl;
+		delete g_LightClusters;
+		g_LightClusters = NULL;
+	}
+	if (NULL != g_UniformBufferManager)
+	{
+		delete g_UniformBufferManager;
+		g_UniformBufferManager = NULL;
+	}
+	if (NULL != g_ProgramCache)
+	{
+		std::cout << "INFO: " << g_ProgramCache->GetLoadedPrograms() << " shader programs loaded from the cache, "
+			<< g_ProgramCache->GetSavedPrograms() << " compiled, "
+			<< g_ProgramCache->GetRejectedPrograms() << " rejected" << std::endl;
+		ShaderManager::SetProgramCache(NULL);
+		delete g_ProgramCache;
+		g_ProgramCache = NULL;
+	}
 
 	// Terminates the program successfully
 	exit(EXIT_SUCCESS); 
@@ -275,4 +520,196 @@ bool InitializeGLEW()
 	std::cout << "INFO: OpenGL Version: " << glGetString(GL_VERSION) << "\n" << std::endl;
 
 	return(true);
-}
\ No newline at end of file
+}
+/***********************************************************
+ *	LoadMainShader()
+ *
+ *  This function is used to build the main shader program
+ *  with the lookups of a shadow filter, replacing the
+ *  program that was loaded before.  The variants of the
+ *  main program are built with the same lookups.  Without
+ *  waiting, the program is only started, and has to be
+ *  finished before it is used.
+ ***********************************************************/
+bool LoadMainShader(ShadowManager::ShadowFilter filter, bool bWait)
+{
+	// a program that was started is finished, so it is freed
+	g_ShaderManager->FinishLoadShaders();
+	if (g_ShaderManager->m_programID != 0)
+	{
+		glDeleteProgram(g_ShaderManager->m_programID);
+		g_ShaderManager->m_programID = 0;
+	}
+
+	g_ShaderManager->BeginLoadShaders(
+		g_VertexShaderPath,
+		g_FragmentShaderPath,
+		NULL,
+		ShadowManager::GetFilterDefines(filter));
+	if (NULL != g_ShaderVariants)
+	{
+		g_ShaderVariants->SetBaseDefines(ShadowManager::GetFilterDefines(filter));
+	}
+	if (bWait == false)
+	{
+		return(g_ShaderManager->IsLoadPending() || (g_ShaderManager->m_programID != 0));
+	}
+
+	g_ShaderManager->FinishLoadShaders();
+	return(g_ShaderManager->m_programID != 0);
+}
+
+/***********************************************************
+ *	RunShadowBenchmark()
+ *
+ *  This function is used to time the shadow pass and the
+ *  main pass with each shadow filter.  Every cascade is
+ *  drawn in every frame, so the shadow pass is timed with
+ *  its full cost, and the GPU times are read back after the
+ *  last frame of a filter so that the frames do not wait
+ *  for them.
+ ***********************************************************/
+void RunShadowBenchmark()
+{
+	std::vector<GLuint> timerQueries(g_BenchmarkFrames * 2);
+	glGenQueries((GLsizei)timerQueries.size(), timerQueries.data());
+
+	for (int filter = 0; filter < ShadowManager::filter_count; filter++)
+	{
+		ShadowManager::ShadowFilter shadowFilter = (ShadowManager::ShadowFilter)filter;
+		if (g_ShadowManager->SetFilter(shadowFilter) == false)
+		{
+			continue;
+		}
+		LoadMainShader(shadowFilter);
+		g_ShaderManager->use();
+		g_UniformBufferManager->BindUniformBlocks(g_ShaderManager);
+		g_SceneManager->RefreshShaderBindings();
+		// the frames are timed with the variants of the filter, not
+		// with the main program standing in for them
+		if (NULL != g_ShaderVariants)
+		{
+			g_SceneManager->SetShaderVariants(g_ShaderVariants);
+			g_ShaderVariants->FinishVariants();
+		}
+
+		int frame = 0;
+		for (; (frame < g_BenchmarkFrames) && !glfwWindowShouldClose(g_Window); frame++)
+		{
+			glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+			g_ViewManager->PrepareSceneView();
+			g_ShadowManager->UpdateCascades();
+			g_ShadowAtlas->UpdateTiles();
+			g_PointShadows->UpdateLights();
+			g_UniformBufferManager->UploadChanges();
+			g_LightClusters->UpdateClusters();
+			g_ShadowManager->Invalidate();
+
+			glBeginQuery(GL_TIME_ELAPSED, timerQueries[frame * 2]);
+			g_DepthShaderManager->use();
+			g_SceneManager->RenderScene("depthMap");
+			glEndQuery(GL_TIME_ELAPSED);
+
+			glBeginQuery(GL_TIME_ELAPSED, timerQueries[frame * 2 + 1]);
+			g_ShaderManager->use();
+			g_SceneManager->RenderScene("main");
+			glEndQuery(GL_TIME_ELAPSED);
+
+			glfwSwapBuffers(g_Window);
+			glfwPollEvents();
+		}
+
+		GLuint64 shadowTime = 0;
+		GLuint64 mainTime = 0;
+		for (int i = 0; i < frame; i++)
+		{
+			GLuint64 elapsed = 0;
+			glGetQueryObjectui64v(timerQueries[i * 2], GL_QUERY_RESULT, &elapsed);
+			shadowTime += elapsed;
+			glGetQueryObjectui64v(timerQueries[i * 2 + 1], GL_QUERY_RESULT, &elapsed);
+			mainTime += elapsed;
+		}
+		if (frame > 0)
+		{
+			std::cout << "INFO: shadow filter " << ShadowManager::GetFilterName(shadowFilter)
+				<< ": shadow pass " << (double)shadowTime / frame / 1.0e6
+				<< " ms, main pass " << (double)mainTime / frame / 1.0e6 << " ms" << std::endl;
+		}
+	}
+
+	glDeleteQueries((GLsizei)timerQueries.size(), timerQueries.data());
+}
+
+/***********************************************************
+ *	AddLocalLights()
+ *
+ *  This function is used to scatter small lights over the
+ *  table, on a spiral that spreads them evenly, with colors
+ *  that go around the hue circle.  They are the same in
+ *  every run, so that the frame times can be compared.
+ ***********************************************************/
+void AddLocalLights(int nLights)
+{
+	const float goldenAngle = 2.39996323f;
+	const glm::vec3 tableCenter = glm::vec3(0.0f, 0.0f, 3.0f);
+	const float tableRadius = 10.0f;
+
+	for (int i = 0; i < nLights; i++)
+	{
+		float angle = goldenAngle * (float)i;
+		float distance = tableRadius * sqrtf(((float)i + 0.5f) / (float)nLights);
+		float hue = fmodf((float)i * 0.61803399f, 1.0f) * 6.0f;
+
+		LightClusters::LOCAL_LIGHT light;
+		light.position = tableCenter + glm::vec3(
+			distance * cosf(angle),
+			0.5f + 1.5f * fmodf((float)i * 0.7548777f, 1.0f),
+			distance * sinf(angle));
+		light.radius = 2.5f;
+		light.color = glm::clamp(glm::vec3(
+			fabsf(hue - 3.0f) - 1.0f,
+			2.0f - fabsf(hue - 2.0f),
+			2.0f - fabsf(hue - 4.0f)), 0.0f, 1.0f);
+		light.specularIntensity = 0.1f;
+		g_LightClusters->AddLight(light);
+	}
+}
+
+/***********************************************************
+ *	ReloadChangedShaders()
+ *
+ *  This function is used between frames to let the shader
+ *  programs watch their files.  A program whose files were
+ *  changed is compiled in the background while the frames
+ *  are drawn with the one in use, and once it has linked
+ *  it replaces that one, so its uniform blocks, uniforms
+ *  and texture slots are set up again.
+ ***********************************************************/
+void ReloadChangedShaders()
+{
+	bool bMainReloaded = g_ShaderManager->UpdateHotReload();
+	bool bDepthReloaded = g_DepthShaderManager->UpdateHotReload();
+
+	if (bMainReloaded == true)
+	{
+		g_ShaderManager->use();
+		g_UniformBufferManager->BindUniformBlocks(g_ShaderManager);
+	}
+	if (bDepthReloaded == true)
+	{
+		g_UniformBufferManager->BindUniformBlocks(g_DepthShaderManager);
+	}
+	if ((bMainReloaded == true) || (bDepthReloaded == true))
+	{
+		g_SceneManager->RefreshShaderBindings();
+	}
+
+	// the variants are set up again by the scene when it draws
+	// with them
+	if (NULL != g_ShaderVariants)
+	{
+		g_ShaderVariants->UpdateHotReload();
+	}
+}
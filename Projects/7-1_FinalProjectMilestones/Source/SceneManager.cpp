@@ -26,6 +26,50 @@ namespace
 	const char* g_TextureValueName = "objectTexture";
 	const char* g_UseTextureName = "bUseTexture";
 	const char* g_UseLightingName = "bUseLighting";
+	const char* g_InstancedName = "bInstanced";
+	const char* g_PackedVerticesName = "bPackedVertices";
+
+	// shapes in the ShapeMeshes geometry arena, indexed by the
+	// MeshID of the scene meshes that are stored there
+	const int g_MeshShapes[] = {
+		ShapeMeshes::shape_plane,
+		ShapeMeshes::shape_box,
+		ShapeMeshes::shape_cylinder,
+		ShapeMeshes::shape_torus,
+		ShapeMeshes::shape_half_torus,
+		ShapeMeshes::shape_sphere,
+		ShapeMeshes::shape_tapered_cylinder
+	};
+
+	// smallest projected size, as a fraction of the screen
+	// height, of each level of detail before the coarsest
+	const float g_LODScreenSizes[LOD_LEVELS - 1] = { 0.5f, 0.2f, 0.08f };
+	// finest level of detail used for the shadow pass
+	const int g_ShadowLOD = 2;
+	// directory of the compute shaders used for GPU culling
+	const char* g_ComputeShaderDirectory = "../../Utilities/shaders/";
+	// local boxes of the meshes that are not in the geometry
+	// arena, indexed from mesh_half_cylinder and used for their
+	// culling, picking and occlusion proxies - the half
+	// cylinder is given the box of the whole ShapeMeshes
+	// cylinder
+	const glm::vec3 g_MeshCenters[] = {
+		glm::vec3(0.0f, 0.5f, 0.0f),
+		glm::vec3(0.0f),
+		glm::vec3(0.0f)
+	};
+	const glm::vec3 g_MeshExtents[] = {
+		glm::vec3(1.0f, 0.5f, 1.0f),
+		glm::vec3(0.5f),
+		glm::vec3(0.5f)
+	};
+	// growth of the proxy boxes, so that their faces are in
+	// front of the surfaces of the objects inside them and
+	// are not hidden by them
+	const float g_ProxyMargin = 0.01f;
+	// starting corner of the boxes of the occlusion groups,
+	// which are grown around their draws
+	const float g_UnboundedExtent = 1.0e30f;
 }
 
 /***********************************************************
@@ -33,10 +77,20 @@ namespace
  *
  *  The constructor for the class
  ***********************************************************/
-SceneManager::SceneManager(ShaderManager *pShaderManager, ShaderManager* pDepthShaderManager)
+SceneManager::SceneManager(
+	ShaderManager *pShaderManager,
+	ShaderManager* pDepthShaderManager,
+	UniformBufferManager* pUniformBuffers,
+	ShadowManager* pShadowManager,
+	ShadowAtlas* pShadowAtlas,
+	PointShadowMaps* pPointShadows)
 {
 	m_pShaderManager = pShaderManager;
 	m_pDepthShaderManager = pDepthShaderManager;
+	m_pUniformBuffers = pUniformBuffers;
+	m_pShadowManager = pShadowManager;
+	m_pShadowAtlas = pShadowAtlas;
+	m_pPointShadows = pPointShadows;
 	m_basicMeshes = new ShapeMeshes();
 	// Added for using half cylinder without editing ShapeMeshes
 	m_halfCylinder = new HalfCylinder();
@@ -44,6 +98,13 @@ SceneManager::SceneManager(ShaderManager *pShaderManager, ShaderManager* pDepthS
 	m_boxAlbumTextures = new BoxAlbumTextures();
 	// Added for using box with puzzle textures
 	m_boxPuzzleTextures = new BoxPuzzleTextures();
+	m_pGPUCuller = NULL;
+	m_pendingGroup = group_none;
+	m_pShaderVariants = NULL;
+	m_programFeatures = 0;
+
+	// the shader programs are already linked at this point
+	ResolveUniformHandles();
 }
 
 /***********************************************************
@@ -55,11 +116,51 @@ SceneManager::~SceneManager()
 {
 	m_pShaderManager = NULL;
 	m_pDepthShaderManager = NULL;
+	m_pShadowManager = NULL;
+	m_pShadowAtlas = NULL;
+	m_pPointShadows = NULL;
+	m_pShaderVariants = NULL;
+	m_pUniformBuffers = NULL;
 	delete m_basicMeshes;
 	m_basicMeshes = NULL;
 	// Added for using half cylinder without editing ShapeMeshes
 	delete m_halfCylinder;
 	m_halfCylinder = NULL;
+	delete m_pGPUCuller;
+	m_pGPUCuller = NULL;
+}
+
+/***********************************************************
+ *  ResolveUniformHandles()
+ *
+ *  This method is used for looking up the locations of the
+ *  uniforms that are set for every drawn mesh, so that no
+ *  lookup by name is needed while rendering.
+ ***********************************************************/
+void SceneManager::ResolveUniformHandles()
+{
+	if (NULL != m_pShaderManager)
+	{
+		m_uniforms.model = m_pShaderManager->GetUniformHandle(g_ModelName);
+		m_uniforms.objectColor = m_pShaderManager->GetUniformHandle(g_ColorValueName);
+		m_uniforms.objectTexture = m_pShaderManager->GetUniformHandle(g_TextureValueName);
+		m_uniforms.useTexture = m_pShaderManager->GetUniformHandle(g_UseTextureName);
+		m_uniforms.UVscale = m_pShaderManager->GetUniformHandle("UVscale");
+		m_uniforms.instanced = m_pShaderManager->GetUniformHandle(g_InstancedName);
+		m_uniforms.packedVertices = m_pShaderManager->GetUniformHandle(g_PackedVerticesName);
+	}
+	if (NULL != m_pDepthShaderManager)
+	{
+		m_uniforms.depthModel = m_pDepthShaderManager->GetUniformHandle(g_ModelName);
+		m_uniforms.depthInstanced = m_pDepthShaderManager->GetUniformHandle(g_InstancedName);
+		m_uniforms.depthCascadeMask = m_pDepthShaderManager->GetUniformHandle("cascadeMask");
+		m_uniforms.depthAtlasTile = m_pDepthShaderManager->GetUniformHandle("bAtlasTile");
+		m_uniforms.depthAtlasMatrix = m_pDepthShaderManager->GetUniformHandle("atlasMatrix");
+		m_uniforms.depthCubeFaces = m_pDepthShaderManager->GetUniformHandle("bCubeFaces");
+		m_uniforms.depthCubeMatrices = m_pDepthShaderManager->GetUniformHandle("cubeMatrices");
+		m_uniforms.depthFaceMask = m_pDepthShaderManager->GetUniformHandle("faceMask");
+		m_uniforms.depthCubeLayer = m_pDepthShaderManager->GetUniformHandle("cubeLayer");
+	}
 }
 
 /***********************************************************
@@ -146,6 +247,8 @@ bool SceneManager::CreateGLTexture(const char* filename, std::string tag, enum W
 		// register the loaded texture and associate it with the special tag string
 		m_textureIDs[m_loadedTextures].ID = textureID;
 		m_textureIDs[m_loadedTextures].tag = tag;
+		m_textureIDs[m_loadedTextures].target = GL_TEXTURE_2D;
+		m_textureIDs[m_loadedTextures].sampler = 0;
 		m_loadedTextures++;
 
 		return true;
@@ -169,7 +272,8 @@ void SceneManager::BindGLTextures()
 	{
 		// bind textures on corresponding texture units
 		glActiveTexture(GL_TEXTURE0 + i);
-		glBindTexture(GL_TEXTURE_2D, m_textureIDs[i].ID);
+		glBindTexture(m_textureIDs[i].target, m_textureIDs[i].ID);
+		glBindSampler(i, m_textureIDs[i].sampler);
 		//std::cout << m_textureIDs[i].ID << std::endl;
 		//std::cout << m_textureIDs[i].tag << std::endl;
 	}
@@ -266,6 +370,7 @@ bool SceneManager::FindMaterial(std::string tag, OBJECT_MATERIAL& material)
 			material.diffuseColor = m_objectMaterials[index].diffuseColor;
 			material.specularColor = m_objectMaterials[index].specularColor;
 			material.shininess = m_objectMaterials[index].shininess;
+			material.bufferSlot = m_objectMaterials[index].bufferSlot;
 		}
 		else
 		{
@@ -276,6 +381,27 @@ bool SceneManager::FindMaterial(std::string tag, OBJECT_MATERIAL& material)
 	return(true);
 }
 
+/***********************************************************
+ *  FindMaterialIndex()
+ *
+ *  This method is used for getting the index of a material
+ *  in the previously defined materials list that is
+ *  associated with the passed in tag, or -1 if not found.
+ ***********************************************************/
+int SceneManager::FindMaterialIndex(std::string tag)
+{
+	int materialCount = (int)m_objectMaterials.size();
+	for (int index = 0; index < materialCount; index++)
+	{
+		if (m_objectMaterials[index].tag.compare(tag) == 0)
+		{
+			return(index);
+		}
+	}
+
+	return(-1);
+}
+
 /***********************************************************
  *  LoadSceneTextures()
  *
@@ -391,6 +517,24 @@ void SceneManager::DefineObjectMaterials()
 	marbleMaterial.tag = "marble";
 
 	m_objectMaterials.push_back(marbleMaterial);
+
+	// copy the materials into the material uniform buffer so
+	// that each draw only has to select a slot
+	for (size_t i = 0; i < m_objectMaterials.size(); i++)
+	{
+		UniformBufferManager::MATERIAL_BLOCK materialBlock = {};
+		materialBlock.ambientColor = m_objectMaterials[i].ambientColor;
+		materialBlock.ambientStrength = m_objectMaterials[i].ambientStrength;
+		materialBlock.diffuseColor = m_objectMaterials[i].diffuseColor;
+		materialBlock.specularColor = m_objectMaterials[i].specularColor;
+		materialBlock.shininess = m_objectMaterials[i].shininess;
+
+		m_objectMaterials[i].bufferSlot = -1;
+		if (NULL != m_pUniformBuffers)
+		{
+			m_objectMaterials[i].bufferSlot = m_pUniformBuffers->AddMaterial(materialBlock);
+		}
+	}
 }
 
 /***********************************************************
@@ -405,36 +549,48 @@ void SceneManager::SetupSceneLights()
 	// the 3D scene with custom lighting - to use the default rendered 
 	// lighting then comment out the following line
 	m_pShaderManager->setBoolValue(g_UseLightingName, true);
+	m_programFeatures |= ShaderVariants::feature_lighting;
+
+	if (NULL == m_pUniformBuffers)
+	{
+		return;
+	}
 
-	m_pShaderManager->setVec3Value("lightSources[0].position", -10.0f, 4.0f, 2.0f);
-	m_pShaderManager->setVec3Value("lightSources[0].ambientColor", 0.4296875f, 0.55859375f, 0.6484375f);
-	m_pShaderManager->setVec3Value("lightSources[0].diffuseColor", 1.0f, 0.83203125f, 0.1484375f);
-	m_pShaderManager->setVec3Value("lightSources[0].specularColor", 1.0f, 0.83203125f, 0.1484375f);
-	m_pShaderManager->setFloatValue("lightSources[0].focalStrength", 1.0f);
-	m_pShaderManager->setFloatValue("lightSources[0].specularIntensity", 0.1f);
+	// the light values are stored in the light uniform buffer, which
+	// is shared by all of the shader programs
+	UniformBufferManager::LIGHT_SOURCE light = {};
+
+	light.position = glm::vec3(-10.0f, 4.0f, 2.0f);
+	light.ambientColor = glm::vec3(0.4296875f, 0.55859375f, 0.6484375f);
+	light.diffuseColor = glm::vec3(1.0f, 0.83203125f, 0.1484375f);
+	light.specularColor = glm::vec3(1.0f, 0.83203125f, 0.1484375f);
+	light.focalStrength = 1.0f;
+	light.specularIntensity = 0.1f;
+	m_pUniformBuffers->SetLightSource(0, light);
 
 	// FIXME: Changed -- Commented out ambient light while debugging shadow mapping
-	m_pShaderManager->setVec3Value("lightSources[1].position", 6.0f, 8.0f, 20.0f);
-	m_pShaderManager->setVec3Value("lightSources[1].ambientColor", 0.01f, 0.01f, 0.01f);
-	m_pShaderManager->setVec3Value("lightSources[1].diffuseColor", 0.37890625f, 0.41796875f, 1.0f);
-	m_pShaderManager->setVec3Value("lightSources[1].specularColor", 0.37890625f, 0.41796875f, 1.0f);
-	m_pShaderManager->setFloatValue("lightSources[1].focalStrength", 32.0f);
-	m_pShaderManager->setFloatValue("lightSources[1].specularIntensity", 0.2f);
+	light.position = glm::vec3(6.0f, 8.0f, 20.0f);
+	light.ambientColor = glm::vec3(0.01f, 0.01f, 0.01f);
+	light.diffuseColor = glm::vec3(0.37890625f, 0.41796875f, 1.0f);
+	light.specularColor = glm::vec3(0.37890625f, 0.41796875f, 1.0f);
+	light.focalStrength = 32.0f;
+	light.specularIntensity = 0.2f;
+	m_pUniformBuffers->SetLightSource(1, light);
 }
 
 /***********************************************************
  *  SetTransformations()
  *
- *  This method is used for setting the transform buffer
- *  using the passed in transformation values.
+ *  This method is used for setting the transform of the
+ *  next recorded draw command using the passed in
+ *  transformation values.
  ***********************************************************/
 void SceneManager::SetTransformations(
 	glm::vec3 scaleXYZ,
 	float XrotationDegrees,
 	float YrotationDegrees,
 	float ZrotationDegrees,
-	glm::vec3 positionXYZ,
-	std::string shaderName)
+	glm::vec3 positionXYZ)
 {
 	// variables for this method
 	glm::mat4 modelView;
@@ -455,25 +611,14 @@ void SceneManager::SetTransformations(
 
 	modelView = translation * rotationX * rotationY * rotationZ * scale;
 
-	if (shaderName == "depthMap") {
-		if (NULL != m_pDepthShaderManager)
-		{
-			m_pDepthShaderManager->setMat4Value(g_ModelName, modelView);
-		}
-	}
-	else {
-		if (NULL != m_pShaderManager)
-		{
-			m_pShaderManager->setMat4Value(g_ModelName, modelView);
-		}
-	}
+	m_pendingDraw.model = modelView;
 }
 
 /***********************************************************
  *  SetShaderColor()
  *
  *  This method is used for setting the passed in color
- *  into the shader for the next draw command
+ *  for the next draw command
  ***********************************************************/
 void SceneManager::SetShaderColor(
 	float redColorValue,
@@ -489,79 +634,1116 @@ void SceneManager::SetShaderColor(
 	currentColor.b = blueColorValue;
 	currentColor.a = alphaValue;
 
-	if (NULL != m_pShaderManager)
-	{
-		m_pShaderManager->setIntValue(g_UseTextureName, false);
-		m_pShaderManager->setVec4Value(g_ColorValueName, currentColor);
-	}
+	m_pendingDraw.color = currentColor;
+	m_pendingTexture = -1;
 }
 
 /***********************************************************
  *  SetShaderTexture()
  *
- *  This method is used for setting the texture data
- *  associated with the passed in ID into the shader.
+ *  This method is used for setting the texture slot
+ *  associated with the passed in tag for the next draw
+ *  command.
  ***********************************************************/
 void SceneManager::SetShaderTexture(
 	std::string textureTag)
 {
-	if (NULL != m_pShaderManager)
-	{
-		m_pShaderManager->setIntValue(g_UseTextureName, true);
+	m_pendingTexture = FindTextureSlot(textureTag);
+}
 
+void SceneManager::SetDepthMapTexture(ShaderManager* pShader)
+{
+	if (NULL == pShader)
+	{
+		pShader = m_pShaderManager;
+	}
+	if (NULL != pShader)
+	{
 		int textureID = -1;
-		textureID = FindTextureSlot(textureTag);
-		m_pShaderManager->setSampler2DValue(g_TextureValueName, textureID);
+		textureID = FindTextureSlot("depthMap");
+		pShader->setSampler2DValue("depthMap", textureID);
+		// every sampler of the shadow filters needs a unit of its
+		// own, as a unit cannot be read as two sampler types
+		textureID = FindTextureSlot("shadowMap");
+		pShader->setSampler2DValue("shadowMap", textureID);
+		textureID = FindTextureSlot("momentMap");
+		pShader->setSampler2DValue("momentMap", textureID);
+		textureID = FindTextureSlot("shadowAtlas");
+		pShader->setSampler2DValue("shadowAtlas", textureID);
+		textureID = FindTextureSlot("shadowCubes");
+		pShader->setSampler2DValue("shadowCubes", textureID);
 	}
 }
 
-void SceneManager::SetDepthMapTexture()
+/***********************************************************
+ *  RefreshShaderBindings()
+ *
+ *  This method is used for setting up the main shader
+ *  program again after it was reloaded, or after the filter
+ *  of the shadow map changed.  The uniform handles are
+ *  looked up again, the lighting is turned on and the
+ *  shadow textures, whose moment map is created with the
+ *  filter, are bound to their slots again.
+ ***********************************************************/
+void SceneManager::RefreshShaderBindings()
 {
-	if (NULL != m_pShaderManager)
+	if (NULL == m_pShaderManager)
 	{
-		int textureID = -1;
-		textureID = FindTextureSlot("depthMap");
-		m_pShaderManager->setSampler2DValue("depthMap", textureID);
+		return;
+	}
+
+	ResolveUniformHandles();
+	m_pShaderManager->use();
+	m_pShaderManager->setBoolValue(g_UseLightingName, true);
+	m_programFeatures |= ShaderVariants::feature_lighting;
+
+	if (NULL != m_pShadowManager)
+	{
+		int shadowSlot = FindTextureSlot("shadowMap");
+		if (shadowSlot >= 0)
+		{
+			m_textureIDs[shadowSlot].ID = m_pShadowManager->GetDepthMap();
+			m_textureIDs[shadowSlot].sampler = m_pShadowManager->GetCompareSampler();
+		}
+		int momentSlot = FindTextureSlot("momentMap");
+		if (momentSlot >= 0)
+		{
+			m_textureIDs[momentSlot].ID = m_pShadowManager->GetMomentMap();
+		}
 	}
+
+	BindGLTextures();
+	SetDepthMapTexture();
 }
 
 /***********************************************************
  *  SetTextureUVScale()
  *
  *  This method is used for setting the texture UV scale
- *  values into the shader.
+ *  values for the next draw command.
  ***********************************************************/
 void SceneManager::SetTextureUVScale(float u, float v)
 {
-	if (NULL != m_pShaderManager)
-	{
-		m_pShaderManager->setVec2Value("UVscale", glm::vec2(u, v));
-	}
+	m_pendingDraw.UVscale = glm::vec2(u, v);
 }
 
 /***********************************************************
  *  SetShaderMaterial()
  *
- *  This method is used for passing the material values
- *  into the shader.
+ *  This method is used for setting the material for the
+ *  next draw command.
  ***********************************************************/
 void SceneManager::SetShaderMaterial(
 	std::string materialTag)
 {
-	if (m_objectMaterials.size() > 0)
+	m_pendingMaterial = FindMaterialIndex(materialTag);
+}
+
+/***********************************************************
+ *  SelectVariant()
+ *
+ *  This method is used for getting the variant of the main
+ *  program that is built for the features of a draw and the
+ *  ones of the whole program.  A variant returned for the
+ *  first time is bound to the uniform blocks and texture
+ *  slots, and its uniform handles are looked up, since it
+ *  is a program of its own.  NULL is returned while the
+ *  variant is still compiling.
+ ***********************************************************/
+ShaderManager* SceneManager::SelectVariant(uint32_t features)
+{
+	if (NULL == m_pShaderVariants)
+	{
+		return(NULL);
+	}
+
+	uint32_t key = (features | m_programFeatures) & (ShaderVariants::variant_count - 1);
+	bool bCreated = false;
+	ShaderManager* pVariant = m_pShaderVariants->GetVariant(key, &bCreated);
+	if ((NULL != pVariant) && (bCreated == true))
+	{
+		pVariant->use();
+		if (NULL != m_pUniformBuffers)
+		{
+			m_pUniformBuffers->BindUniformBlocks(pVariant);
+		}
+		SetDepthMapTexture(pVariant);
+
+		VARIANT_UNIFORMS& uniforms = m_variantUniforms[key];
+		uniforms.model = pVariant->GetUniformHandle(g_ModelName);
+		uniforms.objectColor = pVariant->GetUniformHandle(g_ColorValueName);
+		uniforms.objectTexture = pVariant->GetUniformHandle(g_TextureValueName);
+		uniforms.UVscale = pVariant->GetUniformHandle("UVscale");
+	}
+
+	return(pVariant);
+}
+
+/***********************************************************
+ *  SetShaderVariants()
+ *
+ *  This method is used for drawing the main pass with the
+ *  variants of the main program, each one compiled for the
+ *  features of the draws that use it, instead of testing
+ *  uniforms for the features in the shaders.  The variants
+ *  the scene draws with are requested at once, so that the
+ *  driver compiles them while the scene is prepared.
+ ***********************************************************/
+void SceneManager::SetShaderVariants(ShaderVariants* pShaderVariants)
+{
+	m_pShaderVariants = pShaderVariants;
+	if (NULL == m_pShaderVariants)
+	{
+		return;
+	}
+
+	// the main pass is always lit, and the arena meshes are
+	// always instanced
+	uint32_t features = m_programFeatures | ShaderVariants::feature_lighting;
+	uint32_t arenaFeatures = ShaderVariants::feature_instanced;
+	if (m_basicMeshes->GetVertexFormat() == ShapeMeshes::format_packed)
+	{
+		arenaFeatures |= ShaderVariants::feature_packed;
+	}
+	for (int texture = 0; texture < 2; texture++)
+	{
+		uint32_t textureFeatures = (texture == 1) ? ShaderVariants::feature_texture : 0;
+		m_pShaderVariants->RequestVariant(features | textureFeatures);
+		m_pShaderVariants->RequestVariant(features | textureFeatures | arenaFeatures);
+	}
+}
+
+/***********************************************************
+ *  SetBlinnShading()
+ *
+ *  This method is used for selecting the Blinn-Phong
+ *  specular highlights in the variants of the main program,
+ *  which read it as a constant instead of a uniform.
+ ***********************************************************/
+void SceneManager::SetBlinnShading(bool bBlinn)
+{
+	if (bBlinn == true)
+	{
+		m_programFeatures |= ShaderVariants::feature_blinn;
+	}
+	else
+	{
+		m_programFeatures &= ~(uint32_t)ShaderVariants::feature_blinn;
+	}
+}
+
+/***********************************************************
+ *  AddDrawCommand()
+ *
+ *  This method is used for recording a draw command for the
+ *  passed in mesh, using the transform, color, texture and
+ *  material that were set for the next draw.
+ ***********************************************************/
+void SceneManager::AddDrawCommand(
+	MeshID mesh,
+	unsigned int parts)
+{
+	RenderQueue::DRAW_COMMAND command = {};
+
+	command.transformIndex = (uint32_t)m_drawInstances.size();
+	command.meshID = (uint16_t)mesh;
+	command.meshParts = (uint16_t)parts;
+	command.pass = (uint8_t)m_currentPass;
+
+	// the depth pass only needs the transform, so leaving the
+	// state out of its commands lets them sort by mesh alone
+	if (m_currentPass == RenderQueue::pass_main)
+	{
+		command.materialID = (int16_t)m_pendingMaterial;
+		command.textureID = (int16_t)m_pendingTexture;
+		command.bTranslucent = ((m_pendingTexture < 0) && (m_pendingDraw.color.a < 1.0f)) ? 1 : 0;
+
+		// features of the shader variant the draw needs - the
+		// depth pass has a program of its own
+		uint32_t features = (m_pendingTexture >= 0) ? ShaderVariants::feature_texture : 0;
+		if (mesh < mesh_half_cylinder)
+		{
+			features |= ShaderVariants::feature_instanced;
+			if (m_basicMeshes->GetVertexFormat() == ShapeMeshes::format_packed)
+			{
+				features |= ShaderVariants::feature_packed;
+			}
+		}
+		command.variant = (uint8_t)features;
+	}
+	else
+	{
+		command.materialID = -1;
+		command.textureID = -1;
+		command.bTranslucent = 0;
+		command.variant = 0;
+	}
+
+	// distance of the mesh origin in front of the camera
+	float viewDepth = 0.0f;
+	if (NULL != m_pUniformBuffers)
+	{
+		glm::vec4 viewPosition = m_pUniformBuffers->GetCameraData().view * m_pendingDraw.model[3];
+		viewDepth = -viewPosition.z;
+	}
+
+	command.lod = (uint8_t)SelectLOD(mesh, viewDepth);
+
+	// world space box of the mesh, for the culling and the
+	// picking - the meshes outside of the arena are given
+	// the boxes of the table above
+	glm::vec3 center(0.0f);
+	glm::vec3 extent(0.0f);
+	if (mesh >= mesh_half_cylinder)
+	{
+		Frustum::TransformBox(m_pendingDraw.model,
+			g_MeshCenters[mesh - mesh_half_cylinder],
+			g_MeshExtents[mesh - mesh_half_cylinder],
+			center, extent);
+	}
+	else
+	{
+		glm::vec3 localCenter;
+		glm::vec3 localExtent;
+		m_basicMeshes->GetBoundingBox(g_MeshShapes[mesh], localCenter, localExtent);
+		Frustum::TransformBox(m_pendingDraw.model, localCenter, localExtent, center, extent);
+
+		// the planes and boxes fill their bounding boxes, so the
+		// boxes of the solid ones can hide the draws behind them
+		if (((mesh == mesh_plane) || (mesh == mesh_box)) && (command.bTranslucent == 0))
+		{
+			m_occlusionCuller.AddOccluderBox(m_pendingDraw.model, localCenter, localExtent);
+		}
+	}
+	m_drawBounds.centerX.push_back(center.x);
+	m_drawBounds.centerY.push_back(center.y);
+	m_drawBounds.centerZ.push_back(center.z);
+	m_drawBounds.extentX.push_back(extent.x);
+	m_drawBounds.extentY.push_back(extent.y);
+	m_drawBounds.extentZ.push_back(extent.z);
+
+	// the objects hidden from the camera still cast shadows,
+	// so only the draws of the main pass are conditional
+	if ((m_currentPass == RenderQueue::pass_main) && (m_pendingGroup != group_none))
+	{
+		command.occlusionGroup = (uint8_t)m_pendingGroup;
+
+		m_groupMin[m_pendingGroup] = glm::min(m_groupMin[m_pendingGroup], center - extent);
+		m_groupMax[m_pendingGroup] = glm::max(m_groupMax[m_pendingGroup], center + extent);
+	}
+
+	m_drawInstances.push_back(m_pendingDraw);
+	m_recordedCommands.push_back(command);
+	m_recordedDepths.push_back(viewDepth);
+}
+
+/***********************************************************
+ *  UpdateDrawHierarchy()
+ *
+ *  This method is used for fitting the bounding volume
+ *  hierarchy to the boxes of the recorded draw commands.
+ *  Every pass records the same objects in the same order,
+ *  so the tree is only rebuilt when the objects change, is
+ *  refit when their boxes moved, and is kept as it is when
+ *  a pass recorded the same boxes as the last one - the
+ *  views of the cascades, atlas tiles and cubes then all
+ *  cull through the same tree.
+ ***********************************************************/
+void SceneManager::UpdateDrawHierarchy()
+{
+	size_t count = m_recordedCommands.size();
+	bool bSameCount = (count == m_drawHierarchy.GetPrimitiveCount()) &&
+		(count == m_hierarchyBounds.centerX.size());
+	if ((bSameCount == true) &&
+		(m_drawBounds.centerX == m_hierarchyBounds.centerX) &&
+		(m_drawBounds.centerY == m_hierarchyBounds.centerY) &&
+		(m_drawBounds.centerZ == m_hierarchyBounds.centerZ) &&
+		(m_drawBounds.extentX == m_hierarchyBounds.extentX) &&
+		(m_drawBounds.extentY == m_hierarchyBounds.extentY) &&
+		(m_drawBounds.extentZ == m_hierarchyBounds.extentZ))
+	{
+		return;
+	}
+
+	m_hierarchyBounds = m_drawBounds;
+
+	Frustum::BOX_ARRAYS boxes;
+	boxes.centerX = m_hierarchyBounds.centerX.data();
+	boxes.centerY = m_hierarchyBounds.centerY.data();
+	boxes.centerZ = m_hierarchyBounds.centerZ.data();
+	boxes.extentX = m_hierarchyBounds.extentX.data();
+	boxes.extentY = m_hierarchyBounds.extentY.data();
+	boxes.extentZ = m_hierarchyBounds.extentZ.data();
+
+	if (bSameCount == true)
+	{
+		m_drawHierarchy.Refit(boxes);
+	}
+	else
+	{
+		m_drawHierarchy.Build(boxes, count);
+	}
+}
+
+/***********************************************************
+ *  CullDrawCommands()
+ *
+ *  This method is used for testing the boxes of the recorded
+ *  draw commands against the view volume of the current
+ *  pass - the camera for the main pass and the light for the
+ *  depth pass.  The boxes are tested through the bounding
+ *  volume hierarchy, so whole groups of objects outside of
+ *  the view volume are rejected together, and the draws
+ *  hidden behind the large planes and boxes of the scene
+ *  are rejected with the CPU depth buffer.  Only the visible
+ *  commands are added to the render queue, so the others set
+ *  no shader values and are not drawn.  The views that are
+ *  not the one of a pass, such as the tiles of the shadow
+ *  atlas, pass their matrix in.  A matrix that only bounds
+ *  the reach of a light, such as the box around a point
+ *  light, does not look the way the light does, so its
+ *  occluders would hide casters the light sees - those
+ *  views skip the occlusion test.
+ ***********************************************************/
+void SceneManager::CullDrawCommands()
+{
+	glm::mat4 viewProjection = glm::mat4(1.0f);
+	if (NULL != m_pUniformBuffers)
+	{
+		const UniformBufferManager::CAMERA_BLOCK& camera = m_pUniformBuffers->GetCameraData();
+		if (m_currentPass == RenderQueue::pass_depth)
+		{
+			viewProjection = camera.lightSpaceMatrix;
+		}
+		else
+		{
+			viewProjection = camera.projection * camera.view;
+		}
+	}
+
+	CullDrawCommands(viewProjection);
+}
+
+void SceneManager::CullDrawCommands(
+	const glm::mat4& viewProjection,
+	bool bOcclusion)
+{
+	size_t count = m_recordedCommands.size();
+	m_drawVisible.resize(count);
+	m_frustum.SetMatrix(viewProjection);
+
+	Frustum::BOX_ARRAYS boxes;
+	boxes.centerX = m_drawBounds.centerX.data();
+	boxes.centerY = m_drawBounds.centerY.data();
+	boxes.centerZ = m_drawBounds.centerZ.data();
+	boxes.extentX = m_drawBounds.extentX.data();
+	boxes.extentY = m_drawBounds.extentY.data();
+	boxes.extentZ = m_drawBounds.extentZ.data();
+
+	// the tree was fit to the boxes of the pass when they were
+	// recorded, and is shared by every view of the pass
+	m_drawHierarchy.CullFrustum(m_frustum, m_drawVisible.data());
+
+	// the draws that are in the view volume are then tested
+	// against the occluders drawn for the same view
+	if (bOcclusion == true)
+	{
+		m_occlusionCuller.RasterizeOccluders(viewProjection);
+		m_occlusionCuller.CullBoxes(boxes, count, m_drawVisible.data());
+	}
+
+	// the opaque arena draws are all queued when they are
+	// culled on the GPU as they are submitted, while the
+	// translucent draws and the other meshes are still drawn
+	// on the CPU path and keep the tests above
+	for (size_t i = 0; i < count; i++)
+	{
+		const RenderQueue::DRAW_COMMAND& command = m_recordedCommands[i];
+		bool bCulledOnGPU = (NULL != m_pGPUCuller) &&
+			(command.meshID < mesh_half_cylinder) &&
+			(command.bTranslucent == 0);
+		if ((bCulledOnGPU == true) || (m_drawVisible[i] != 0))
+		{
+			m_renderQueue.AddCommand(command, m_recordedDepths[i]);
+		}
+	}
+}
+
+/***********************************************************
+ *  GatherArenaDraws()
+ *
+ *  This method is used for gathering the sorted arena draws
+ *  from first that share its bindings, adding one indirect
+ *  draw for each run of the same mesh.
+ ***********************************************************/
+size_t SceneManager::GatherArenaDraws(
+	size_t first,
+	size_t commandCount)
+{
+	const RenderQueue::DRAW_COMMAND& command = m_renderQueue.GetSortedCommand(first);
+
+	while ((first < commandCount) &&
+		(m_renderQueue.GetSortedCommand(first).meshID < mesh_half_cylinder) &&
+		(RenderQueue::HasSameBindings(command, m_renderQueue.GetSortedCommand(first)) == true))
+	{
+		const RenderQueue::DRAW_COMMAND& batch = m_renderQueue.GetSortedCommand(first);
+
+		size_t last = first + 1;
+		while ((last < commandCount) &&
+			(RenderQueue::HasSameState(batch, m_renderQueue.GetSortedCommand(last)) == true))
+		{
+			last++;
+		}
+
+		m_basicMeshes->AddIndirectDraws(
+			m_basicMeshes->GetLODShape(g_MeshShapes[batch.meshID], batch.lod),
+			(GLuint)(last - first),
+			(GLuint)first,
+			m_indirectCommands,
+			(batch.meshParts & part_top) != 0,
+			(batch.meshParts & part_bottom) != 0,
+			(batch.meshParts & part_sides) != 0);
+
+		first = last;
+	}
+
+	return(first);
+}
+
+/***********************************************************
+ *  CullDrawsOnGPU()
+ *
+ *  This method is used for gathering the batches of opaque
+ *  arena draws of the current pass, with the box of every
+ *  instance, and culling them on the GPU.  The translucent
+ *  draws are left to the CPU path, since the compacted
+ *  instances would lose their back to front order.
+ ***********************************************************/
+void SceneManager::CullDrawsOnGPU()
+{
+	size_t commandCount = m_renderQueue.GetCommandCount();
+
+	m_indirectCommands.clear();
+	m_commandBatches.clear();
+	m_culledBatches.clear();
+
+	GPUCuller::INSTANCE_BOUNDS unculled = {};
+	unculled.command = GPUCuller::no_command;
+	m_cullBounds.assign(commandCount, unculled);
+
+	size_t first = 0;
+	while (first < commandCount)
+	{
+		const RenderQueue::DRAW_COMMAND& command = m_renderQueue.GetSortedCommand(first);
+		if ((command.meshID >= mesh_half_cylinder) || (command.bTranslucent != 0))
+		{
+			first++;
+			continue;
+		}
+
+		CULLED_BATCH batch;
+		batch.begin = first;
+		batch.firstCommand = (GLuint)m_indirectCommands.size();
+		first = GatherArenaDraws(first, commandCount);
+		batch.end = first;
+		batch.commandCount = (GLsizei)(m_indirectCommands.size() - batch.firstCommand);
+
+		for (size_t i = batch.firstCommand; i < m_indirectCommands.size(); i++)
+		{
+			GPUCuller::COMMAND_BATCH commandBatch;
+			commandBatch.batch = (GLuint)m_culledBatches.size();
+			commandBatch.firstCommand = batch.firstCommand;
+			m_commandBatches.push_back(commandBatch);
+
+			// the instances of a command are the sorted draws
+			// starting at its base instance
+			const ShapeMeshes::DRAW_INDIRECT_COMMAND& indirect = m_indirectCommands[i];
+			for (GLuint instance = indirect.baseInstance; instance < indirect.baseInstance + indirect.instanceCount; instance++)
+			{
+				uint32_t draw = m_renderQueue.GetSortedCommand(instance).transformIndex;
+				GPUCuller::INSTANCE_BOUNDS& bounds = m_cullBounds[instance];
+				bounds.center = glm::vec3(m_drawBounds.centerX[draw], m_drawBounds.centerY[draw], m_drawBounds.centerZ[draw]);
+				bounds.extent = glm::vec3(m_drawBounds.extentX[draw], m_drawBounds.extentY[draw], m_drawBounds.extentZ[draw]);
+				bounds.command = (GLuint)i;
+			}
+		}
+
+		m_culledBatches.push_back(batch);
+	}
+
+	if (m_culledBatches.empty() == false)
+	{
+		// only the main pass has a depth pyramid of the last frame
+		m_pGPUCuller->CullDraws(
+			m_basicMeshes->GetInstanceBuffer(),
+			sizeof(ShapeMeshes::INSTANCE_DATA),
+			(GLsizei)commandCount,
+			m_cullBounds.data(),
+			m_indirectCommands.data(),
+			m_commandBatches.data(),
+			(GLsizei)m_indirectCommands.size(),
+			(GLsizei)m_culledBatches.size(),
+			m_frustum,
+			m_currentPass == RenderQueue::pass_main);
+	}
+}
+
+/***********************************************************
+ *  UpdateShadowCasters()
+ *
+ *  This method is used for passing the recorded draws whose
+ *  boxes are inside each shadow cascade to the shadow
+ *  manager, which compares them with the draws the layer
+ *  of the cascade was drawn with, and the ones inside the
+ *  view of each atlas tile and cube face to the shadow
+ *  atlas and point shadow maps in the same way.  The boxes
+ *  are tested here rather than taken from the culling, so
+ *  that the test is the same when the draws are culled on
+ *  the GPU.
+ ***********************************************************/
+void SceneManager::UpdateShadowCasters()
+{
+	if (NULL != m_pShadowManager)
+	{
+		for (int cascade = 0; cascade < m_pShadowManager->GetCascadeCount(); cascade++)
+		{
+			GatherShadowCasters(m_pShadowManager->GetCascadeMatrix(cascade));
+			m_pShadowManager->UpdateCasters(cascade, m_shadowCasters.data(), m_shadowCasters.size());
+		}
+	}
+
+	if (NULL != m_pShadowAtlas)
+	{
+		for (int light = 0; light < TOTAL_LIGHTS; light++)
+		{
+			if (m_pShadowAtlas->HasTile(light) == true)
+			{
+				GatherShadowCasters(m_pShadowAtlas->GetTileMatrix(light));
+				m_pShadowAtlas->UpdateCasters(light, m_shadowCasters.data(), m_shadowCasters.size());
+			}
+		}
+	}
+
+	if (NULL != m_pPointShadows)
+	{
+		for (int light = 0; light < TOTAL_LIGHTS; light++)
+		{
+			if (m_pPointShadows->HasCube(light) == false)
+			{
+				continue;
+			}
+			// a face without casters is left out of the pass
+			const glm::mat4* faceMatrices = m_pPointShadows->GetFaceMatrices(light);
+			for (int face = 0; face < CUBE_FACES; face++)
+			{
+				GatherShadowCasters(faceMatrices[face]);
+				m_pPointShadows->UpdateCasters(light, face, m_shadowCasters.data(), m_shadowCasters.size());
+			}
+		}
+	}
+}
+
+/***********************************************************
+ *  GatherShadowCasters()
+ *
+ *  This method is used for gathering the recorded draws
+ *  whose boxes are inside the view volume of a shadow
+ *  matrix into the caster list.
+ ***********************************************************/
+void SceneManager::GatherShadowCasters(const glm::mat4& shadowMatrix)
+{
+	Frustum shadowFrustum;
+	shadowFrustum.SetMatrix(shadowMatrix);
+	m_shadowCasters.clear();
+
+	for (size_t i = 0; i < m_recordedCommands.size(); i++)
+	{
+		glm::vec3 center(m_drawBounds.centerX[i], m_drawBounds.centerY[i], m_drawBounds.centerZ[i]);
+		glm::vec3 extent(m_drawBounds.extentX[i], m_drawBounds.extentY[i], m_drawBounds.extentZ[i]);
+		if (shadowFrustum.IsBoxVisible(center, extent) == false)
+		{
+			continue;
+		}
+
+		const RenderQueue::DRAW_COMMAND& command = m_recordedCommands[i];
+		ShadowManager::SHADOW_CASTER caster;
+		caster.model = m_drawInstances[command.transformIndex].model;
+		caster.meshID = command.meshID;
+		caster.meshParts = command.meshParts;
+		caster.lod = command.lod;
+		m_shadowCasters.push_back(caster);
+	}
+}
+
+/***********************************************************
+ *  RenderShadowAtlas()
+ *
+ *  This method is used for drawing the tiles of the shadow
+ *  atlas that changed.  Each tile is culled and drawn on
+ *  its own, with the recorded draws of the depth pass and
+ *  the matrix of its light.
+ ***********************************************************/
+void SceneManager::RenderShadowAtlas()
+{
+	if ((NULL == m_pShadowAtlas) || (m_pShadowAtlas->BeginAtlasPass() == false))
+	{
+		return;
+	}
+
+	m_pDepthShaderManager->setBoolValue(m_uniforms.depthAtlasTile, true);
+	for (int light = 0; light < TOTAL_LIGHTS; light++)
+	{
+		if (m_pShadowAtlas->BeginTile(light) == false)
+		{
+			continue;
+		}
+
+		const glm::mat4& tileMatrix = m_pShadowAtlas->GetTileMatrix(light);
+		m_pDepthShaderManager->setMat4Value(m_uniforms.depthAtlasMatrix, tileMatrix);
+
+		m_renderQueue.Clear();
+		CullDrawCommands(tileMatrix);
+		m_renderQueue.Sort();
+		SubmitDrawCommands();
+	}
+	m_pDepthShaderManager->setBoolValue(m_uniforms.depthAtlasTile, false);
+
+	m_pShadowAtlas->EndAtlasPass();
+}
+
+/***********************************************************
+ *  RenderPointShadows()
+ *
+ *  This method is used for drawing the cubes of the point
+ *  lights that changed.  The draws inside the reach of a
+ *  light are submitted once, and the geometry shader sends
+ *  each triangle to the faces of the cube that are drawn.
+ ***********************************************************/
+void SceneManager::RenderPointShadows()
+{
+	if (NULL == m_pPointShadows)
+	{
+		return;
+	}
+
+	m_pDepthShaderManager->setBoolValue(m_uniforms.depthCubeFaces, true);
+	for (int light = 0; light < TOTAL_LIGHTS; light++)
+	{
+		if (m_pPointShadows->BeginLightPass(light) == false)
+		{
+			continue;
+		}
+
+		m_pDepthShaderManager->setMat4ArrayValue(m_uniforms.depthCubeMatrices, m_pPointShadows->GetFaceMatrices(light), CUBE_FACES);
+		m_pDepthShaderManager->setIntValue(m_uniforms.depthFaceMask, m_pPointShadows->GetFaceMask());
+		m_pDepthShaderManager->setIntValue(m_uniforms.depthCubeLayer, m_pPointShadows->GetCubeLayer(light));
+
+		m_renderQueue.Clear();
+		// the bounds matrix is a box around the light rather than
+		// the view of any face, so only its volume is tested
+		CullDrawCommands(m_pPointShadows->GetBoundsMatrix(light), false);
+		m_renderQueue.Sort();
+		SubmitDrawCommands();
+
+		m_pPointShadows->EndLightPass();
+	}
+	m_pDepthShaderManager->setBoolValue(m_uniforms.depthCubeFaces, false);
+}
+
+/***********************************************************
+ *  SetGPUCulling()
+ *
+ *  This method is used for switching the culling of the
+ *  arena draws to compute shaders.  It needs OpenGL 4.6 and
+ *  falls back to the CPU culling when the shaders cannot
+ *  be loaded.
+ ***********************************************************/
+bool SceneManager::SetGPUCulling(bool bEnable)
+{
+	if (bEnable == false)
+	{
+		delete m_pGPUCuller;
+		m_pGPUCuller = NULL;
+		return(false);
+	}
+	if (NULL != m_pGPUCuller)
+	{
+		return(true);
+	}
+
+	if (GPUCuller::IsSupported() == false)
+	{
+		std::cout << "INFO: GPU culling needs OpenGL 4.6, culling on the CPU" << std::endl;
+		return(false);
+	}
+
+	m_pGPUCuller = new GPUCuller();
+	if (m_pGPUCuller->LoadShaders(g_ComputeShaderDirectory) == false)
+	{
+		std::cout << "ERROR: could not load the GPU culling shaders, culling on the CPU" << std::endl;
+		delete m_pGPUCuller;
+		m_pGPUCuller = NULL;
+		return(false);
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  SelectLOD()
+ *
+ *  This method is used for picking the level of detail of
+ *  a recorded mesh from its projected size on the screen.
+ *  The shadow pass does not need the full detail, so its
+ *  draws never use the finest levels.
+ ***********************************************************/
+int SceneManager::SelectLOD(
+	MeshID mesh,
+	float viewDepth)
+{
+	if ((mesh >= mesh_half_cylinder) || (NULL == m_pUniformBuffers))
+	{
+		return(0);
+	}
+
+	// the largest scale of the model matrix scales the radius
+	// of the sphere around the untransformed mesh
+	const glm::mat4& model = m_pendingDraw.model;
+	float scale = glm::max(glm::length(glm::vec3(model[0])),
+		glm::max(glm::length(glm::vec3(model[1])), glm::length(glm::vec3(model[2]))));
+	float radius = m_basicMeshes->GetBoundingRadius(g_MeshShapes[mesh]) * scale;
+
+	int lod = 0;
+	if (viewDepth > radius)
+	{
+		// projected diameter as a fraction of the screen height
+		float screenSize = radius * m_pUniformBuffers->GetCameraData().projection[1][1] / viewDepth;
+		while ((lod < LOD_LEVELS - 1) && (screenSize < g_LODScreenSizes[lod]))
+		{
+			lod++;
+		}
+	}
+
+	if (m_currentPass == RenderQueue::pass_depth)
+	{
+		lod = glm::max(lod, g_ShadowLOD);
+	}
+
+	return(lod);
+}
+
+/***********************************************************
+ *  SubmitDrawCommands()
+ *
+ *  This method is used for drawing the sorted commands of
+ *  the current pass.  Neighbouring commands that share the
+ *  same texture and material are submitted with one multi-
+ *  draw call, in which commands for the same mesh become
+ *  one indirect draw of several instances.  Shader values
+ *  are only set when they differ from the previous call.
+ *  With shader variants, the main pass only changes the
+ *  program where the variant of the sorted commands does.
+ ***********************************************************/
+void SceneManager::SubmitDrawCommands()
+{
+	size_t commandCount = m_renderQueue.GetCommandCount();
+	if (commandCount == 0)
+	{
+		return;
+	}
+
+	ShaderManager* pShader = m_pShaderManager;
+	UniformHandle modelHandle = m_uniforms.model;
+	UniformHandle instancedHandle = m_uniforms.instanced;
+	UniformHandle packedHandle = m_uniforms.packedVertices;
+	UniformHandle useTextureHandle = m_uniforms.useTexture;
+	UniformHandle colorHandle = m_uniforms.objectColor;
+	UniformHandle textureHandle = m_uniforms.objectTexture;
+	UniformHandle UVscaleHandle = m_uniforms.UVscale;
+	if (m_currentPass == RenderQueue::pass_depth)
+	{
+		pShader = m_pDepthShaderManager;
+		modelHandle = m_uniforms.depthModel;
+		instancedHandle = m_uniforms.depthInstanced;
+		// the depth shader does not read the normals
+		packedHandle = UniformHandle();
+	}
+	bool bPackedArena = (m_basicMeshes->GetVertexFormat() == ShapeMeshes::format_packed);
+	if (NULL == pShader)
+	{
+		return;
+	}
+
+	// lay the per-draw values out in sorted order, so that the
+	// instances of each indirect draw are next to each other
+	m_sortedInstances.resize(commandCount);
+	for (size_t i = 0; i < commandCount; i++)
+	{
+		m_sortedInstances[i] = m_drawInstances[m_renderQueue.GetSortedCommand(i).transformIndex];
+	}
+	m_basicMeshes->SetInstanceData(m_sortedInstances.data(), (GLsizei)commandCount);
+
+	// the opaque arena draws that are culled on the GPU are
+	// gathered up front, and the compute shaders leave the
+	// pass program unbound
+	size_t nextCulledBatch = 0;
+	if (NULL != m_pGPUCuller)
+	{
+		CullDrawsOnGPU();
+		pShader->use();
+	}
+
+	// the values that are currently set in the shader - the
+	// first call always sets them
+	int boundInstanced = -1;
+	int boundTexture = -2;
+	int boundMaterial = -2;
+	glm::vec4 boundColor(-1.0f);
+	glm::vec2 boundUVscale(-1.0f);
+	int boundGroup = group_none;
+	bool bConditional = false;
+	int boundVariant = -1;
+
+	size_t first = 0;
+	while (first < commandCount)
+	{
+		const RenderQueue::DRAW_COMMAND& command = m_renderQueue.GetSortedCommand(first);
+
+		// the draws of an occlusion group are skipped by the GPU
+		// when its proxy box had no samples in the last frame
+		if (command.occlusionGroup != boundGroup)
+		{
+			if (bConditional == true)
+			{
+				m_occlusionQueries.EndConditionalRender();
+			}
+			bConditional = (command.occlusionGroup != group_none) &&
+				m_occlusionQueries.BeginConditionalRender(command.occlusionGroup);
+			boundGroup = command.occlusionGroup;
+		}
+
+		// the main pass draws with the variant of the main program
+		// built for the features of the draw, which are sorted
+		// together - the main program and its uniforms stand in
+		// for a variant that is still compiling or failed
+		if ((command.pass == RenderQueue::pass_main) &&
+			(NULL != m_pShaderVariants) &&
+			((int)command.variant != boundVariant))
+		{
+			ShaderManager* pVariant = SelectVariant(command.variant);
+			if (NULL != pVariant)
+			{
+				const VARIANT_UNIFORMS& uniforms =
+					m_variantUniforms[(command.variant | m_programFeatures) & (ShaderVariants::variant_count - 1)];
+				pShader = pVariant;
+				modelHandle = uniforms.model;
+				colorHandle = uniforms.objectColor;
+				textureHandle = uniforms.objectTexture;
+				UVscaleHandle = uniforms.UVscale;
+				instancedHandle = UniformHandle();
+				packedHandle = UniformHandle();
+				useTextureHandle = UniformHandle();
+			}
+			else
+			{
+				pShader = m_pShaderManager;
+				modelHandle = m_uniforms.model;
+				colorHandle = m_uniforms.objectColor;
+				textureHandle = m_uniforms.objectTexture;
+				UVscaleHandle = m_uniforms.UVscale;
+				instancedHandle = m_uniforms.instanced;
+				packedHandle = m_uniforms.packedVertices;
+				useTextureHandle = m_uniforms.useTexture;
+			}
+			pShader->use();
+
+			// the values set in the last program are not set in
+			// this one
+			boundInstanced = -1;
+			boundTexture = -2;
+			boundColor = glm::vec4(-1.0f);
+			boundUVscale = glm::vec2(-1.0f);
+			boundVariant = (int)command.variant;
+		}
+
+		// the meshes that are not stored in the ShapeMeshes
+		// geometry arena are drawn one at a time
+		bool bArenaMesh = (command.meshID < mesh_half_cylinder);
+
+		if ((int)bArenaMesh != boundInstanced)
+		{
+			if (instancedHandle.IsValid() == true)
+			{
+				pShader->setBoolValue(instancedHandle, bArenaMesh);
+			}
+			if (packedHandle.IsValid() == true)
+			{
+				pShader->setBoolValue(packedHandle, bArenaMesh && bPackedArena);
+			}
+			boundInstanced = (int)bArenaMesh;
+		}
+
+		if (command.pass == RenderQueue::pass_main)
+		{
+			if (command.textureID != boundTexture)
+			{
+				if (useTextureHandle.IsValid() == true)
+				{
+					pShader->setIntValue(useTextureHandle, command.textureID >= 0);
+				}
+				if (command.textureID >= 0)
+				{
+					pShader->setSampler2DValue(textureHandle, command.textureID);
+				}
+				boundTexture = command.textureID;
+			}
+			if ((command.materialID != boundMaterial) && (command.materialID >= 0))
+			{
+				// select the slot of the material uniform buffer
+				if (NULL != m_pUniformBuffers)
+				{
+					m_pUniformBuffers->BindMaterial(m_objectMaterials[command.materialID].bufferSlot);
+				}
+				boundMaterial = command.materialID;
+			}
+		}
+
+		if ((bArenaMesh == true) &&
+			(NULL != m_pGPUCuller) &&
+			(nextCulledBatch < m_culledBatches.size()) &&
+			(m_culledBatches[nextCulledBatch].begin == first))
+		{
+			// draw the commands the GPU culling wrote for the batch
+			const CULLED_BATCH& batch = m_culledBatches[nextCulledBatch];
+			m_basicMeshes->DrawIndirectCount(
+				m_pGPUCuller->GetCommandBuffer(),
+				(GLintptr)(batch.firstCommand * sizeof(ShapeMeshes::DRAW_INDIRECT_COMMAND)),
+				m_pGPUCuller->GetCountBuffer(),
+				(GLintptr)(nextCulledBatch * sizeof(GLuint)),
+				batch.commandCount);
+
+			first = batch.end;
+			nextCulledBatch++;
+		}
+		else if (bArenaMesh == true)
+		{
+			m_indirectCommands.clear();
+			first = GatherArenaDraws(first, commandCount);
+
+			m_basicMeshes->DrawIndirect(m_indirectCommands.data(), (GLsizei)m_indirectCommands.size());
+		}
+		else
+		{
+			const ShapeMeshes::INSTANCE_DATA& instance = m_sortedInstances[first];
+
+			pShader->setMat4Value(modelHandle, instance.model);
+			if (command.pass == RenderQueue::pass_main)
+			{
+				if (instance.color != boundColor)
+				{
+					pShader->setVec4Value(colorHandle, instance.color);
+					boundColor = instance.color;
+				}
+				if (instance.UVscale != boundUVscale)
+				{
+					pShader->setVec2Value(UVscaleHandle, instance.UVscale);
+					boundUVscale = instance.UVscale;
+				}
+			}
+			DrawMeshCommand(command);
+
+			first++;
+		}
+	}
+
+	if (bConditional == true)
+	{
+		m_occlusionQueries.EndConditionalRender();
+	}
+}
+
+/***********************************************************
+ *  DrawOcclusionProxies()
+ *
+ *  This method is used for drawing the box around each
+ *  occlusion group into the depth buffer of the finished
+ *  main pass, inside the query of the group.  Only depth
+ *  testing is done, so the boxes leave no trace.  When the
+ *  camera is inside a box, its faces may all be clipped, so
+ *  no query is issued and the group is drawn next frame.
+ ***********************************************************/
+void SceneManager::DrawOcclusionProxies()
+{
+	if ((NULL == m_pShaderManager) || (NULL == m_pUniformBuffers))
 	{
-		OBJECT_MATERIAL material;
-		bool bReturn = false;
+		return;
+	}
+
+	glm::vec3 cameraPosition = glm::vec3(m_pUniformBuffers->GetCameraData().viewPosition);
+
+	m_pShaderManager->use();
+	m_pShaderManager->setBoolValue(m_uniforms.instanced, false);
+	m_pShaderManager->setBoolValue(m_uniforms.packedVertices,
+		m_basicMeshes->GetVertexFormat() == ShapeMeshes::format_packed);
+
+	glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+	glDepthMask(GL_FALSE);
 
-		bReturn = FindMaterial(materialTag, material);
-		if (bReturn == true)
+	for (int group = group_none + 1; group < group_count; group++)
+	{
+		// no draws were recorded for the group
+		if (glm::any(glm::greaterThan(m_groupMin[group], m_groupMax[group])))
 		{
-			m_pShaderManager->setVec3Value("material.ambientColor", material.ambientColor);
-			m_pShaderManager->setFloatValue("material.ambientStrength", material.ambientStrength);
-			m_pShaderManager->setVec3Value("material.diffuseColor", material.diffuseColor);
-			m_pShaderManager->setVec3Value("material.specularColor", material.specularColor);
-			m_pShaderManager->setFloatValue("material.shininess", material.shininess);
+			continue;
 		}
+
+		glm::vec3 boxMin = m_groupMin[group] - glm::vec3(g_ProxyMargin);
+		glm::vec3 boxMax = m_groupMax[group] + glm::vec3(g_ProxyMargin);
+		if (glm::all(glm::greaterThanEqual(cameraPosition, boxMin)) &&
+			glm::all(glm::lessThanEqual(cameraPosition, boxMax)))
+		{
+			continue;
+		}
+
+		// the ShapeMeshes box spans -0.5 to 0.5
+		glm::mat4 model = glm::translate((boxMin + boxMax) * 0.5f) * glm::scale(boxMax - boxMin);
+		m_pShaderManager->setMat4Value(m_uniforms.model, model);
+
+		m_occlusionQueries.BeginQuery(group);
+		m_basicMeshes->DrawBoxMesh();
+		m_occlusionQueries.EndQuery();
+	}
+
+	glDepthMask(GL_TRUE);
+	glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+}
+
+/***********************************************************
+ *  DrawMeshCommand()
+ *
+ *  This method is used for drawing the mesh, or the part of
+ *  the mesh, that is referenced by a draw command, for the
+ *  meshes that are not stored in the geometry arena.
+ ***********************************************************/
+void SceneManager::DrawMeshCommand(const RenderQueue::DRAW_COMMAND& command)
+{
+	bool bDrawTop = (command.meshParts & part_top) != 0;
+	bool bDrawBottom = (command.meshParts & part_bottom) != 0;
+	bool bDrawSides = (command.meshParts & part_sides) != 0;
+
+	switch (command.meshID)
+	{
+		case mesh_half_cylinder:
+			m_halfCylinder->DrawHalfCylinderMesh(bDrawTop, bDrawBottom, bDrawSides);
+			break;
+		case mesh_album_box:
+			m_boxAlbumTextures->DrawBoxMesh();
+			break;
+		case mesh_puzzle_box:
+			m_boxPuzzleTextures->DrawBoxMesh();
+			break;
+		default:
+			break;
 	}
 }
 
@@ -590,12 +1772,17 @@ void SceneManager::PrepareScene()
 
 	// Changed -- Removed LoadSceneTextures() to ensure depth map is rendered after meshes are loaded
 
+	// the scene is bound by vertex fetch, so the arena meshes are
+	// stored in the 16-byte packed vertex layout
+	m_basicMeshes->SetVertexFormat(ShapeMeshes::format_packed);
 	m_basicMeshes->LoadPlaneMesh();
 	m_basicMeshes->LoadBoxMesh();
 	m_basicMeshes->LoadCylinderMesh();
 	m_basicMeshes->LoadTorusMesh();
 	m_basicMeshes->LoadSphereMesh();
 	m_basicMeshes->LoadTaperedCylinderMesh();
+	// one pair of queries for each occlusion group
+	m_occlusionQueries.Create(group_count);
 	// Added for using half cylinder without editing ShapeMeshes
 	m_halfCylinder->LoadCylinderMesh();
 	// Added for using box mesh with multiple textures
@@ -609,16 +1796,116 @@ void SceneManager::PrepareScene()
  *  RenderScene()
  *
  *  This method is used for rendering the 3D scene by
- *  transforming and drawing the basic 3D shapes
+ *  recording draw commands for the basic 3D shapes, then
+ *  sorting and submitting them
  ***********************************************************/
 void SceneManager::RenderScene(std::string shaderName)
 {
-	// Call functions to render each object
-	RenderTable(shaderName);
-	RenderAlbum(shaderName);
-	RenderPuzzleBox(shaderName);
-	RenderBackdrop(shaderName);
-	RenderBottle(shaderName);
+	if (shaderName == "depthMap")
+	{
+		m_currentPass = RenderQueue::pass_depth;
+	}
+	else
+	{
+		m_currentPass = RenderQueue::pass_main;
+	}
+
+	// start the pass with the default draw values
+	m_renderQueue.Clear();
+	m_drawInstances.clear();
+	m_recordedCommands.clear();
+	m_recordedDepths.clear();
+	m_drawBounds.centerX.clear();
+	m_drawBounds.centerY.clear();
+	m_drawBounds.centerZ.clear();
+	m_drawBounds.extentX.clear();
+	m_drawBounds.extentY.clear();
+	m_drawBounds.extentZ.clear();
+	m_occlusionCuller.ClearOccluders();
+	m_pendingDraw.model = glm::mat4(1.0f);
+	m_pendingDraw.color = glm::vec4(1.0f);
+	m_pendingDraw.UVscale = glm::vec2(1.0f);
+	m_pendingMaterial = -1;
+	m_pendingTexture = -1;
+	m_pendingGroup = group_none;
+	for (int group = 0; group < group_count; group++)
+	{
+		m_groupMin[group] = glm::vec3(g_UnboundedExtent);
+		m_groupMax[group] = glm::vec3(-g_UnboundedExtent);
+	}
+	if (m_currentPass == RenderQueue::pass_main)
+	{
+		m_occlusionQueries.BeginFrame();
+	}
+
+	// Call functions to record the draw commands for each object
+	RenderTable();
+	RenderAlbum();
+	RenderPuzzleBox();
+	RenderBackdrop();
+	RenderBottle();
+
+	// fit the tree to the recorded boxes once, for all of the
+	// views culled in this pass
+	UpdateDrawHierarchy();
+
+	// draw the visible commands grouped by state
+	CullDrawCommands();
+
+	// the shadow cascades are kept when nothing inside them
+	// has changed since they were drawn, and the far ones are
+	// only drawn every few frames - the atlas tiles and cubes
+	// of the other lights are drawn after them in the same way
+	bool bShadowPass = (m_currentPass == RenderQueue::pass_depth) &&
+		((NULL != m_pShadowManager) || (NULL != m_pShadowAtlas) || (NULL != m_pPointShadows));
+	if (bShadowPass == true)
+	{
+		UpdateShadowCasters();
+		if ((NULL != m_pShadowManager) && (m_pShadowManager->BeginShadowPass() == true))
+		{
+			m_pDepthShaderManager->setIntValue(m_uniforms.depthCascadeMask, m_pShadowManager->GetDrawMask());
+			m_renderQueue.Sort();
+			SubmitDrawCommands();
+			m_pShadowManager->EndShadowPass();
+		}
+		RenderShadowAtlas();
+		RenderPointShadows();
+		return;
+	}
+
+	m_renderQueue.Sort();
+	SubmitDrawCommands();
+
+	// test the boxes of the heavy objects against the finished
+	// depth buffer, for the draws of the next frame
+	if (m_currentPass == RenderQueue::pass_main)
+	{
+		DrawOcclusionProxies();
+	}
+
+	// keep the depth of the frame for the GPU occlusion
+	// culling of the next frame
+	if ((NULL != m_pGPUCuller) && (m_currentPass == RenderQueue::pass_main) && (NULL != m_pUniformBuffers))
+	{
+		const UniformBufferManager::CAMERA_BLOCK& camera = m_pUniformBuffers->GetCameraData();
+		m_pGPUCuller->UpdateDepthPyramid(camera.projection * camera.view);
+	}
+}
+
+/***********************************************************
+ *  PickObject()
+ *
+ *  This method is used for finding the object under a ray,
+ *  such as one cast from the camera through the cursor.  The
+ *  returned index is the transform index of the draw that
+ *  was recorded in the last rendered pass.
+ ***********************************************************/
+int SceneManager::PickObject(
+	const glm::vec3& origin,
+	const glm::vec3& direction)
+{
+	float distance = 0.0f;
+	return(m_drawHierarchy.IntersectRay(origin, direction, distance));
 }
 
 /***********************************************************
@@ -627,7 +1914,7 @@ void SceneManager::RenderScene(std::string shaderName)
  *  This method is called to render the shapes for the table
  *  object.
  ***********************************************************/
-void SceneManager::RenderTable(std::string shaderName)
+void SceneManager::RenderTable()
 {
 	// declare the variables for the transformations
 	glm::vec3 scaleXYZ;
@@ -653,16 +1940,15 @@ void SceneManager::RenderTable(std::string shaderName)
 		XrotationDegrees,
 		YrotationDegrees,
 		ZrotationDegrees,
-		positionXYZ,
-		shaderName);
+		positionXYZ);
 
 	SetShaderColor(1, 1, 1, 1);
 	SetTextureUVScale(3.0, 3.0);
 	SetShaderMaterial("marble");
 	SetShaderTexture("marble");
 
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawPlaneMesh();
+	// record the mesh draw with transformation values
+	AddDrawCommand(mesh_plane);
 }
 
 /***********************************************************
@@ -671,7 +1957,7 @@ void SceneManager::RenderTable(std::string shaderName)
  *  This method is called to render the shapes for the photo
  *  album object.
  ***********************************************************/
-void SceneManager::RenderAlbum(std::string shaderName)
+void SceneManager::RenderAlbum()
 {
 	// FIXME: move album render code here
 	// declare the variables for the transformations
@@ -684,6 +1970,9 @@ void SceneManager::RenderAlbum(std::string shaderName)
 	// Add vector to position of each mesh to move entire object same amount
 	glm::vec3 photoAlbumPositionXYZ = glm::vec3(-5.0f, 0.0975f, -3.0f);
 
+	// the album is drawn only when its proxy box was visible
+	m_pendingGroup = group_album;
+
 	/****************************************************************/
 	// Half cylinder -- outside of spine
 	/****************************************************************/
@@ -707,8 +1996,7 @@ void SceneManager::RenderAlbum(std::string shaderName)
 		XrotationDegrees,
 		YrotationDegrees,
 		ZrotationDegrees,
-		positionXYZ,
-		shaderName);
+		positionXYZ);
 
 	// Set shader color
 	// Red
@@ -717,8 +2005,8 @@ void SceneManager::RenderAlbum(std::string shaderName)
 	SetShaderMaterial("cloth");
 	SetShaderTexture("album_back");
 
-	// draw the mesh with transformation values
-	m_halfCylinder->DrawHalfCylinderMesh(false, false, true);
+	// record the mesh draw with transformation values
+	AddDrawCommand(mesh_half_cylinder, part_sides);
 	/****************************************************************/
 
 	/****************************************************************/
@@ -744,8 +2032,7 @@ void SceneManager::RenderAlbum(std::string shaderName)
 		XrotationDegrees,
 		YrotationDegrees,
 		ZrotationDegrees,
-		positionXYZ,
-		shaderName);
+		positionXYZ);
 
 	// Set shader color
 	// Orange
@@ -754,8 +2041,8 @@ void SceneManager::RenderAlbum(std::string shaderName)
 	SetShaderMaterial("cloth");
 	SetShaderTexture("album_back");
 
-	// draw the mesh with transformation values
-	m_halfCylinder->DrawHalfCylinderMesh(false, false, true);
+	// record the mesh draw with transformation values
+	AddDrawCommand(mesh_half_cylinder, part_sides);
 	/****************************************************************/
 
 	/****************************************************************/
@@ -780,8 +2067,7 @@ void SceneManager::RenderAlbum(std::string shaderName)
 		XrotationDegrees,
 		YrotationDegrees,
 		ZrotationDegrees,
-		positionXYZ,
-		shaderName);
+		positionXYZ);
 
 	// Set shader color
 	// Pink
@@ -790,8 +2076,8 @@ void SceneManager::RenderAlbum(std::string shaderName)
 	SetShaderMaterial("cloth");
 	SetShaderTexture("album_back");
 
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawHalfTorusMesh();
+	// record the mesh draw with transformation values
+	AddDrawCommand(mesh_half_torus);
 	/****************************************************************/
 
 	/****************************************************************/
@@ -814,8 +2100,7 @@ void SceneManager::RenderAlbum(std::string shaderName)
 		XrotationDegrees,
 		YrotationDegrees,
 		ZrotationDegrees,
-		positionXYZ,
-		shaderName);
+		positionXYZ);
 
 	// Set shader color
 	// Pink
@@ -824,8 +2109,8 @@ void SceneManager::RenderAlbum(std::string shaderName)
 	SetShaderMaterial("cloth");
 	SetShaderTexture("album_back");
 
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawHalfTorusMesh();
+	// record the mesh draw with transformation values
+	AddDrawCommand(mesh_half_torus);
 	/****************************************************************/
 
 	/****************************************************************/
@@ -851,8 +2136,7 @@ void SceneManager::RenderAlbum(std::string shaderName)
 		XrotationDegrees,
 		YrotationDegrees,
 		ZrotationDegrees,
-		positionXYZ,
-		shaderName);
+		positionXYZ);
 
 	// Set shader color
 	// Green
@@ -861,8 +2145,8 @@ void SceneManager::RenderAlbum(std::string shaderName)
 	SetShaderMaterial("cloth");
 	SetShaderTexture("album_back");
 
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawBoxMesh();
+	// record the mesh draw with transformation values
+	AddDrawCommand(mesh_box);
 	/****************************************************************/
 
 	/****************************************************************/
@@ -888,8 +2172,7 @@ void SceneManager::RenderAlbum(std::string shaderName)
 		XrotationDegrees,
 		YrotationDegrees,
 		ZrotationDegrees,
-		positionXYZ,
-		shaderName);
+		positionXYZ);
 
 	// Set shader color
 	// Blue
@@ -898,8 +2181,8 @@ void SceneManager::RenderAlbum(std::string shaderName)
 	SetShaderMaterial("cloth");
 	SetShaderTexture("album");
 
-	// draw the mesh with transformation values
-	m_boxAlbumTextures->DrawBoxMesh();
+	// record the mesh draw with transformation values
+	AddDrawCommand(mesh_album_box);
 	/****************************************************************/
 
 	/****************************************************************/
@@ -925,8 +2208,7 @@ void SceneManager::RenderAlbum(std::string shaderName)
 		XrotationDegrees,
 		YrotationDegrees,
 		ZrotationDegrees,
-		positionXYZ,
-		shaderName);
+		positionXYZ);
 
 	// Set shader color
 	// Medium grey
@@ -935,8 +2217,10 @@ void SceneManager::RenderAlbum(std::string shaderName)
 	SetShaderMaterial("plastic");
 	SetShaderTexture("album_pages");
 
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawBoxMesh();
+	// record the mesh draw with transformation values
+	AddDrawCommand(mesh_box);
+
+	m_pendingGroup = group_none;
 }
 
 /***********************************************************
@@ -945,7 +2229,7 @@ void SceneManager::RenderAlbum(std::string shaderName)
  *  This method is called to render the shapes for the puzzle
  *  box object.
  ***********************************************************/
-void SceneManager::RenderPuzzleBox(std::string shaderName)
+void SceneManager::RenderPuzzleBox()
 {
 	// declare the variables for the transformations
 	glm::vec3 scaleXYZ;
@@ -979,16 +2263,15 @@ void SceneManager::RenderPuzzleBox(std::string shaderName)
 		XrotationDegrees,
 		YrotationDegrees,
 		ZrotationDegrees,
-		positionXYZ,
-		shaderName);
+		positionXYZ);
 
 	// Set shader color
 	// Medium grey
 	SetShaderColor(0.4, 0.804, 0.667, 1);
 	SetShaderMaterial("puzzle");
 
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawBoxMesh();
+	// record the mesh draw with transformation values
+	AddDrawCommand(mesh_box);
 
 	/****************************************************************/
 	// Box -- upper section
@@ -1013,8 +2296,7 @@ void SceneManager::RenderPuzzleBox(std::string shaderName)
 		XrotationDegrees,
 		YrotationDegrees,
 		ZrotationDegrees,
-		positionXYZ,
-		shaderName);
+		positionXYZ);
 
 	// Set shader color
 	// Medium grey
@@ -1023,8 +2305,8 @@ void SceneManager::RenderPuzzleBox(std::string shaderName)
 	SetShaderMaterial("puzzle");
 	SetShaderTexture("puzzle");
 
-	// draw the mesh with transformation values
-	m_boxPuzzleTextures->DrawBoxMesh();
+	// record the mesh draw with transformation values
+	AddDrawCommand(mesh_puzzle_box);
 }
 
 /***********************************************************
@@ -1033,7 +2315,7 @@ void SceneManager::RenderPuzzleBox(std::string shaderName)
  *  This method is called to render the shapes for the backdrop
  *  object.
  ***********************************************************/
-void SceneManager::RenderBackdrop(std::string shaderName)
+void SceneManager::RenderBackdrop()
 {
 	// declare the variables for the transformations
 	glm::vec3 scaleXYZ;
@@ -1059,16 +2341,15 @@ void SceneManager::RenderBackdrop(std::string shaderName)
 		XrotationDegrees,
 		YrotationDegrees,
 		ZrotationDegrees,
-		positionXYZ,
-		shaderName);
+		positionXYZ);
 
 	SetShaderColor(1, 1, 1, 1);
 	SetTextureUVScale(3.0, 1.0);
 	SetShaderMaterial("marble");
 	SetShaderTexture("marble");
 
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawPlaneMesh();
+	// record the mesh draw with transformation values
+	AddDrawCommand(mesh_plane);
 }
 
 /***********************************************************
@@ -1077,7 +2358,7 @@ void SceneManager::RenderBackdrop(std::string shaderName)
  *  This method is called to render the shapes for the glass
  *  bottle object.
  ***********************************************************/
-void SceneManager::RenderBottle(std::string shaderName)
+void SceneManager::RenderBottle()
 {
 	// declare the variables for the transformations
 	glm::vec3 scaleXYZ;
@@ -1088,6 +2369,9 @@ void SceneManager::RenderBottle(std::string shaderName)
 
 	// Add vector to position of each mesh to move entire object same amount
 	glm::vec3 bottlePositionXYZ = glm::vec3(0.0f, 1.15f, 5.2f);
+
+	// the bottle is drawn only when its proxy box was visible
+	m_pendingGroup = group_bottle;
 	
 	/****************************************************************/
 	// Glass bottle
@@ -1116,16 +2400,15 @@ void SceneManager::RenderBottle(std::string shaderName)
 		XrotationDegrees,
 		YrotationDegrees,
 		ZrotationDegrees,
-		positionXYZ,
-		shaderName);
+		positionXYZ);
 
 	// Set shader color
 	// Medium grey
 	SetShaderColor(.7, .7, .8, 0.3);
 	SetShaderMaterial("glass");
 
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawSphereMesh();
+	// record the mesh draw with transformation values
+	AddDrawCommand(mesh_sphere);
 	/****************************************************************/
 
 	/****************************************************************/
@@ -1151,16 +2434,15 @@ void SceneManager::RenderBottle(std::string shaderName)
 		XrotationDegrees,
 		YrotationDegrees,
 		ZrotationDegrees,
-		positionXYZ,
-		shaderName);
+		positionXYZ);
 
 	// Set shader color
 	// Medium grey
 	SetShaderColor(.7, .7, .8, 0.3);
 	SetShaderMaterial("glass");
 
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawCylinderMesh(false, false, true);
+	// record the mesh draw with transformation values
+	AddDrawCommand(mesh_cylinder, part_sides);
 	/****************************************************************/
 
 	/****************************************************************/
@@ -1186,16 +2468,15 @@ void SceneManager::RenderBottle(std::string shaderName)
 		XrotationDegrees,
 		YrotationDegrees,
 		ZrotationDegrees,
-		positionXYZ,
-		shaderName);
+		positionXYZ);
 
 	// Set shader color
 	// Medium grey
 	SetShaderColor(.7, .7, .8, 0.3);
 	SetShaderMaterial("glass");
 
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawTorusMesh();
+	// record the mesh draw with transformation values
+	AddDrawCommand(mesh_torus);
 	/****************************************************************/
 
 	/****************************************************************/
@@ -1221,8 +2502,7 @@ void SceneManager::RenderBottle(std::string shaderName)
 		XrotationDegrees,
 		YrotationDegrees,
 		ZrotationDegrees,
-		positionXYZ,
-		shaderName);
+		positionXYZ);
 
 	// Set shader color
 	// Medium grey
@@ -1231,8 +2511,10 @@ void SceneManager::RenderBottle(std::string shaderName)
 	SetShaderTexture("cork");
 	SetShaderMaterial("cork");
 
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawTaperedCylinderMesh();
+	// record the mesh draw with transformation values
+	AddDrawCommand(mesh_tapered_cylinder);
+
+	m_pendingGroup = group_none;
 }
 
 // renderQuad() renders a 1x1 XY quad in NDC
@@ -1271,6 +2553,49 @@ void SceneManager::LoadDepthMapTexture(unsigned int &depthmap) {
 	// register the loaded texture and associate it with the special tag string
 	m_textureIDs[m_loadedTextures].ID = depthmap;
 	m_textureIDs[m_loadedTextures].tag = "depthMap";
+	// the shadow map holds one layer for each cascade
+	m_textureIDs[m_loadedTextures].target = GL_TEXTURE_2D_ARRAY;
+	m_textureIDs[m_loadedTextures].sampler = 0;
+	m_loadedTextures++;
+
+	// the tiles of the other lights, which compare by themselves
+	if (NULL != m_pShadowAtlas)
+	{
+		m_textureIDs[m_loadedTextures].ID = m_pShadowAtlas->GetDepthMap();
+		m_textureIDs[m_loadedTextures].tag = "shadowAtlas";
+		m_textureIDs[m_loadedTextures].target = GL_TEXTURE_2D;
+		m_textureIDs[m_loadedTextures].sampler = 0;
+		m_loadedTextures++;
+	}
+
+	// the cubes of the point lights, which compare by themselves
+	if (NULL != m_pPointShadows)
+	{
+		m_textureIDs[m_loadedTextures].ID = m_pPointShadows->GetDepthMap();
+		m_textureIDs[m_loadedTextures].tag = "shadowCubes";
+		m_textureIDs[m_loadedTextures].target = GL_TEXTURE_CUBE_MAP_ARRAY;
+		m_textureIDs[m_loadedTextures].sampler = 0;
+		m_loadedTextures++;
+	}
+
+	if (NULL == m_pShadowManager)
+	{
+		return;
+	}
+
+	// the same layers read with the hardware depth compare
+	m_textureIDs[m_loadedTextures].ID = depthmap;
+	m_textureIDs[m_loadedTextures].tag = "shadowMap";
+	m_textureIDs[m_loadedTextures].target = GL_TEXTURE_2D_ARRAY;
+	m_textureIDs[m_loadedTextures].sampler = m_pShadowManager->GetCompareSampler();
+	m_loadedTextures++;
+
+	// the blurred moments of the EVSM filter, which only exist
+	// while that filter is selected
+	m_textureIDs[m_loadedTextures].ID = m_pShadowManager->GetMomentMap();
+	m_textureIDs[m_loadedTextures].tag = "momentMap";
+	m_textureIDs[m_loadedTextures].target = GL_TEXTURE_2D_ARRAY;
+	m_textureIDs[m_loadedTextures].sampler = 0;
 	m_loadedTextures++;
 }
 
@@ -11,6 +11,17 @@
 #pragma once
 
 #include "ShaderManager.h"
+#include "UniformBufferManager.h"
+#include "RenderQueue.h"
+#include "Frustum.h"
+#include "BoundingVolumeHierarchy.h"
+#include "OcclusionCuller.h"
+#include "GPUCuller.h"
+#include "OcclusionQueryPool.h"
+#include "ShadowManager.h"
+#include "ShadowAtlas.h"
+#include "PointShadowMaps.h"
+#include "ShaderVariants.h"
 #include "ShapeMeshes.h"
 // Added to include half cylinder mesh without editing ShapeMeshes.h and ShapeMeshes.cpp
 #include "HalfCylinder.h"
@@ -33,7 +44,13 @@ class SceneManager
 {
 public:
 	// constructor
-	SceneManager(ShaderManager* pShaderManager, ShaderManager* pDepthShaderManager);
+	SceneManager(
+		ShaderManager* pShaderManager,
+		ShaderManager* pDepthShaderManager,
+		UniformBufferManager* pUniformBuffers,
+		ShadowManager* pShadowManager,
+		ShadowAtlas* pShadowAtlas,
+		PointShadowMaps* pPointShadows);
 	// destructor
 	~SceneManager();
 
@@ -41,6 +58,11 @@ public:
 	{
 		std::string tag;
 		uint32_t ID;
+		// kind of texture the ID is bound as
+		GLenum target;
+		// sampler object the texture is read through, or 0 for
+		// the parameters of the texture itself
+		GLuint sampler;
 	};
 
 	struct OBJECT_MATERIAL
@@ -51,6 +73,8 @@ public:
 		glm::vec3 specularColor;
 		float shininess;
 		std::string tag;
+		// slot of the material in the material uniform buffer
+		int bufferSlot;
 	};
 
 	// enum for different texture wrapping options
@@ -62,10 +86,57 @@ public:
 		clamp_to_border
 	};
 
+	// meshes that can be referenced by a draw command - the
+	// meshes before mesh_half_cylinder are stored in the
+	// ShapeMeshes geometry arena
+	enum MeshID
+	{
+		mesh_plane,
+		mesh_box,
+		mesh_cylinder,
+		mesh_torus,
+		mesh_half_torus,
+		mesh_sphere,
+		mesh_tapered_cylinder,
+		mesh_half_cylinder,
+		mesh_album_box,
+		mesh_puzzle_box
+	};
+
+	// parts of the meshes that have caps
+	enum MeshParts
+	{
+		part_top = 1,
+		part_bottom = 2,
+		part_sides = 4,
+		part_all = part_top | part_bottom | part_sides
+	};
+
+	// heavy objects whose draws are skipped when their proxy
+	// box had no visible samples in the last frame
+	enum OcclusionGroup
+	{
+		group_none,
+		group_album,
+		group_bottle,
+		group_count
+	};
+
 private:
 	// pointer to shader manager object
 	ShaderManager* m_pShaderManager;
 	ShaderManager* m_pDepthShaderManager;
+	// pointer to the shared uniform buffers
+	UniformBufferManager* m_pUniformBuffers;
+	// pointer to the shadow map of the scene light
+	ShadowManager* m_pShadowManager;
+	// pointer to the shadow tiles of the other lights
+	ShadowAtlas* m_pShadowAtlas;
+	// pointer to the shadow cubes of the point lights
+	PointShadowMaps* m_pPointShadows;
+	// pointer to the variants of the main shader program, or
+	// NULL to draw with its uniforms
+	ShaderVariants* m_pShaderVariants;
 	// pointer to basic shapes object
 	ShapeMeshes* m_basicMeshes;
 	// Added -- pointer to half cylinder object
@@ -81,6 +152,113 @@ private:
 	// defined object materials
 	std::vector<OBJECT_MATERIAL> m_objectMaterials;
 
+	// uniform locations used for every drawn mesh, resolved
+	// once after the shader programs have been linked
+	struct SHADER_UNIFORMS
+	{
+		UniformHandle model;
+		UniformHandle depthModel;
+		UniformHandle objectColor;
+		UniformHandle objectTexture;
+		UniformHandle useTexture;
+		UniformHandle UVscale;
+		UniformHandle instanced;
+		UniformHandle depthInstanced;
+		UniformHandle depthCascadeMask;
+		UniformHandle depthAtlasTile;
+		UniformHandle depthAtlasMatrix;
+		UniformHandle depthCubeFaces;
+		UniformHandle depthCubeMatrices;
+		UniformHandle depthFaceMask;
+		UniformHandle depthCubeLayer;
+		UniformHandle packedVertices;
+	};
+	SHADER_UNIFORMS m_uniforms;
+	// uniform locations of each variant of the main program,
+	// indexed by its feature bits
+	struct VARIANT_UNIFORMS
+	{
+		UniformHandle model;
+		UniformHandle objectColor;
+		UniformHandle objectTexture;
+		UniformHandle UVscale;
+	};
+	VARIANT_UNIFORMS m_variantUniforms[ShaderVariants::variant_count];
+	// features of the main program that are the same for
+	// every draw, such as the lighting
+	uint32_t m_programFeatures;
+
+	// draw commands recorded for the pass being rendered
+	RenderQueue m_renderQueue;
+	// per-draw values of the recorded commands, referenced
+	// by the transform index of a command
+	std::vector<ShapeMeshes::INSTANCE_DATA> m_drawInstances;
+	// per-draw values in sorted order, uploaded as instance data
+	std::vector<ShapeMeshes::INSTANCE_DATA> m_sortedInstances;
+	// indirect draws of the multi-draw call being gathered
+	std::vector<ShapeMeshes::DRAW_INDIRECT_COMMAND> m_indirectCommands;
+	// draw commands and view depths recorded for the pass,
+	// before they are culled and added to the render queue
+	std::vector<RenderQueue::DRAW_COMMAND> m_recordedCommands;
+	std::vector<float> m_recordedDepths;
+	// world space boxes of the recorded commands, with each
+	// component in its own array for the SIMD culling
+	struct DRAW_BOUNDS
+	{
+		std::vector<float> centerX;
+		std::vector<float> centerY;
+		std::vector<float> centerZ;
+		std::vector<float> extentX;
+		std::vector<float> extentY;
+		std::vector<float> extentZ;
+	};
+	DRAW_BOUNDS m_drawBounds;
+	// result of culling the recorded commands
+	std::vector<uint8_t> m_drawVisible;
+	// view volume of the pass being rendered
+	Frustum m_frustum;
+	// tree over the boxes of the recorded commands, used for
+	// the culling and for picking
+	BoundingVolumeHierarchy m_drawHierarchy;
+	// boxes the tree was last fit to, so that a pass that
+	// records the same boxes keeps the tree as it is
+	DRAW_BOUNDS m_hierarchyBounds;
+	// depth buffer of the large occluders of the pass, drawn
+	// on the CPU to drop the draws hidden behind them
+	OcclusionCuller m_occlusionCuller;
+	// pass the draw commands are recorded for
+	RenderQueue::RenderPass m_currentPass;
+	// values used for the next recorded draw command
+	ShapeMeshes::INSTANCE_DATA m_pendingDraw;
+	int m_pendingMaterial;
+	int m_pendingTexture;
+	// culling of the opaque arena draws on the GPU, which is
+	// NULL unless it is enabled and supported
+	GPUCuller* m_pGPUCuller;
+	// boxes of the sorted instances and the batch of each
+	// command that is culled on the GPU
+	std::vector<GPUCuller::INSTANCE_BOUNDS> m_cullBounds;
+	std::vector<GPUCuller::COMMAND_BATCH> m_commandBatches;
+	// sorted commands of each batch culled on the GPU and
+	// its range of the culled command buffer
+	struct CULLED_BATCH
+	{
+		size_t begin;
+		size_t end;
+		GLuint firstCommand;
+		GLsizei commandCount;
+	};
+	std::vector<CULLED_BATCH> m_culledBatches;
+	// occlusion queries of the proxy boxes of the groups
+	OcclusionQueryPool m_occlusionQueries;
+	// group of the draws being recorded
+	OcclusionGroup m_pendingGroup;
+	// world space box around the draws of each group
+	glm::vec3 m_groupMin[group_count];
+	glm::vec3 m_groupMax[group_count];
+	// casters inside a shadow cascade in the depth pass
+	std::vector<ShadowManager::SHADOW_CASTER> m_shadowCasters;
+
 	// load texture images and convert to OpenGL texture data
 	// edited to take extra parameter for texture wrapping
 	bool CreateGLTexture(const char* filename, std::string tag, enum Wrapping wrapping);
@@ -91,8 +269,13 @@ private:
 	// find a loaded texture by tag
 	int FindTextureID(std::string tag);
 	
+	// look up the uniform handles used while rendering
+	void ResolveUniformHandles();
+
 	// find a defined material by tag
 	bool FindMaterial(std::string tag, OBJECT_MATERIAL& material);
+	// find the index of a defined material by tag
+	int FindMaterialIndex(std::string tag);
 	// load textures from directory
 	
 	// Configure material settings
@@ -101,14 +284,13 @@ private:
 	void SetupSceneLights();
 
 	// set the transformation values 
-	// into the transform buffer
+	// for the next draw command
 	void SetTransformations(
 		glm::vec3 scaleXYZ,
 		float XrotationDegrees,
 		float YrotationDegrees,
 		float ZrotationDegrees,
-		glm::vec3 positionXYZ,
-		std::string shaderName);
+		glm::vec3 positionXYZ);
 
 	// set the color values into the shader
 	void SetShaderColor(
@@ -121,7 +303,9 @@ private:
 	void SetShaderTexture(
 		std::string textureTag);
 
-	void SetDepthMapTexture();
+	// set the shadow texture slots into a program, or into
+	// the main program when it is NULL
+	void SetDepthMapTexture(ShaderManager* pShader = NULL);
 
 	// set the UV scale for the texture mapping
 	void SetTextureUVScale(
@@ -130,20 +314,98 @@ private:
 	// set the object material into the shader
 	void SetShaderMaterial(
 		std::string materialTag);
+	// get the variant of the main program for the features of
+	// a draw, setting up a variant that was just compiled -
+	// returns NULL when variants are not used or it failed
+	ShaderManager* SelectVariant(uint32_t features);
+
+	// record a draw command for a mesh with the values
+	// that were set for the next draw
+	void AddDrawCommand(
+		MeshID mesh,
+		unsigned int parts = part_all);
+	// pick the level of detail of a mesh for the next
+	// recorded draw command
+	int SelectLOD(
+		MeshID mesh,
+		float viewDepth);
+	// build or refit the tree over the boxes of the recorded
+	// draw commands when they changed
+	void UpdateDrawHierarchy();
+	// cull the recorded draw commands against the view volume
+	// of the current pass and queue the visible ones
+	void CullDrawCommands();
+	// cull the recorded draw commands against the view volume
+	// of a matrix and queue the visible ones - the occluders
+	// are only tested when the matrix is the view of the pass
+	void CullDrawCommands(
+		const glm::mat4& viewProjection,
+		bool bOcclusion = true);
+	// submit the sorted draw commands of the current pass
+	void SubmitDrawCommands();
+	// draw the mesh referenced by a draw command, for the
+	// meshes that are not in the geometry arena
+	void DrawMeshCommand(const RenderQueue::DRAW_COMMAND& command);
+	// add the indirect draws of the sorted arena commands from
+	// first that share its bindings, and return the command
+	// after them
+	size_t GatherArenaDraws(
+		size_t first,
+		size_t commandCount);
+	// gather the opaque arena draws of the current pass and
+	// cull them on the GPU
+	void CullDrawsOnGPU();
+	// draw the proxy boxes of the occlusion groups inside
+	// their queries, for the draws of the next frame
+	void DrawOcclusionProxies();
+	// pass the casters inside each shadow cascade to the
+	// shadow manager, the ones inside each atlas tile to the
+	// shadow atlas and the ones inside each cube face to the
+	// point shadow maps
+	void UpdateShadowCasters();
+	// gather the recorded draws inside the view volume of a
+	// shadow matrix
+	void GatherShadowCasters(const glm::mat4& shadowMatrix);
+	// draw the tiles of the shadow atlas that changed, each
+	// with the draws inside of its own view
+	void RenderShadowAtlas();
+	// draw the cubes of the point lights that changed, one
+	// layered pass for each light
+	void RenderPointShadows();
 
 public:
 
 	// The following methods are for the students to 
 	// customize for their own 3D scene
 	void PrepareScene();
+	// cull the opaque arena draws on the GPU instead of the
+	// CPU, when the GL context supports it - returns whether
+	// it is enabled
+	bool SetGPUCulling(bool bEnable);
+	// draw the main pass with the variants of the main program
+	// built for the features of each draw, or NULL to draw
+	// with the uniforms of the main program - the variants of
+	// the scene start compiling at once
+	void SetShaderVariants(ShaderVariants* pShaderVariants);
+	// select the Blinn-Phong highlights of the variants
+	void SetBlinnShading(bool bBlinn);
 	void RenderScene(std::string shaderName);
+	// set up a main shader program that was loaded again, or
+	// the shadow textures after the shadow filter changed
+	void RefreshShaderBindings();
+
+	// find the draw recorded in the last pass whose box a ray
+	// hits first, or -1 when the ray hits nothing
+	int PickObject(
+		const glm::vec3& origin,
+		const glm::vec3& direction);
 
 	// methods for rendering the various objects in the 3D scene
-	void RenderTable(std::string shaderName);
-	void RenderAlbum(std::string shaderName);
-	void RenderPuzzleBox(std::string shaderName);
-	void RenderBackdrop(std::string shaderName);
-	void RenderBottle(std::string shaderName);
+	void RenderTable();
+	void RenderAlbum();
+	void RenderPuzzleBox();
+	void RenderBackdrop();
+	void RenderBottle();
 
 	// methods for rendering shadows and setting depthMap
 	void renderQuad();
@@ -20,8 +20,6 @@ namespace
 	// Variables for window width and height
 	const int WINDOW_WIDTH = 1000;
 	const int WINDOW_HEIGHT = 800;
-	const char* g_ViewName = "view";
-	const char* g_ProjectionName = "projection";
 
 	// camera object used for viewing and interacting with
 	// the 3D scene
@@ -42,6 +40,11 @@ namespace
 
 	bool blinn = false;
 	bool blinnKeyPressed = false;
+
+	// set when the left mouse button was pressed, until the
+	// ray through the view center is taken for picking
+	bool bPickRequested = false;
+	bool pickButtonPressed = false;
 }
 
 /***********************************************************
@@ -50,10 +53,12 @@ namespace
  *  The constructor for the class
  ***********************************************************/
 ViewManager::ViewManager(
-	ShaderManager *pShaderManager)
+	ShaderManager *pShaderManager,
+	UniformBufferManager* pUniformBuffers)
 {
 	// initialize the member variables
 	m_pShaderManager = pShaderManager;
+	m_pUniformBuffers = pUniformBuffers;
 	m_pWindow = NULL;
 	g_pCamera = new Camera();
 	// default camera view parameters
@@ -72,6 +77,7 @@ ViewManager::~ViewManager()
 {
 	// free up allocated memory
 	m_pShaderManager = NULL;
+	m_pUniformBuffers = NULL;
 	m_pWindow = NULL;
 	if (NULL != g_pCamera)
 	{
@@ -260,6 +266,18 @@ void ViewManager::ProcessKeyboardEvents()
 	{
 		blinnKeyPressed = false;
 	}
+
+	// the cursor is captured by the camera, so a click picks
+	// the object in the center of the view
+	if (glfwGetMouseButton(m_pWindow, GLFW_MOUSE_BUTTON_LEFT) == GLFW_PRESS && !pickButtonPressed)
+	{
+		bPickRequested = true;
+		pickButtonPressed = true;
+	}
+	if (glfwGetMouseButton(m_pWindow, GLFW_MOUSE_BUTTON_LEFT) == GLFW_RELEASE)
+	{
+		pickButtonPressed = false;
+	}
 }
 
 /***********************************************************
@@ -313,16 +331,47 @@ void ViewManager::PrepareSceneView()
 		}
 	}
 
-	// if the shader manager object is valid
-	if (NULL != m_pShaderManager)
+	// if the uniform buffer object is valid
+	if (NULL != m_pUniformBuffers)
 	{
-		// set the view matrix into the shader for proper rendering
-		m_pShaderManager->setMat4Value(g_ViewName, view);
-		// set the view matrix into the shader for proper rendering
-		m_pShaderManager->setMat4Value(g_ProjectionName, projection);
-		// set the view position of the camera into the shader for proper rendering
-		m_pShaderManager->setVec3Value("viewPosition", g_pCamera->Position);
-
-		
+		// set the view matrix, projection matrix and view position of the
+		// camera into the camera block, which is uploaded once per frame
+		m_pUniformBuffers->SetCameraView(view, projection, g_pCamera->Position);
 	}
-}
\ No newline at end of file
+}
+
+/***********************************************************
+ *  GetBlinnShading()
+ *
+ *  This method is used for getting whether the Blinn-Phong
+ *  highlights were turned on with the B key, for the
+ *  shader variants that fix it when they are compiled.
+ ***********************************************************/
+bool ViewManager::GetBlinnShading() const
+{
+	return(blinn);
+}
+
+/***********************************************************
+ *  GetPickRay()
+ *
+ *  This method is used for getting the ray from the camera
+ *  through the center of the view after the left mouse
+ *  button was clicked.  It returns false when there was no
+ *  click since the last ray was taken.
+ ***********************************************************/
+bool ViewManager::GetPickRay(
+	glm::vec3& origin,
+	glm::vec3& direction)
+{
+	if ((bPickRequested == false) || (NULL == g_pCamera))
+	{
+		return(false);
+	}
+	bPickRequested = false;
+
+	origin = g_pCamera->Position;
+	direction = glm::normalize(g_pCamera->Front);
+
+	return(true);
+}
@@ -10,6 +10,7 @@
 #pragma once
 
 #include "ShaderManager.h"
+#include "UniformBufferManager.h"
 #include "camera.h"
 
 // GLFW library
@@ -20,7 +21,8 @@ class ViewManager
 public:
 	// constructor
 	ViewManager(
-		ShaderManager* pShaderManager);
+		ShaderManager* pShaderManager,
+		UniformBufferManager* pUniformBuffers);
 	// destructor
 	~ViewManager();
 
@@ -33,6 +35,8 @@ public:
 private:
 	// pointer to shader manager object
 	ShaderManager* m_pShaderManager;
+	// pointer to the shared uniform buffers
+	UniformBufferManager* m_pUniformBuffers;
 	// active OpenGL display window
 	GLFWwindow* m_pWindow;
 
@@ -45,4 +49,11 @@ public:
 	
 	// prepare the conversion from 3D object display to 2D scene display
 	void PrepareSceneView();
+	// whether the B key turned on the Blinn-Phong highlights
+	bool GetBlinnShading() const;
+	// get the ray through the center of the view when the
+	// left mouse button was clicked since the last call
+	bool GetPickRay(
+		glm::vec3& origin,
+		glm::vec3& direction);
 };
\ No newline at end of file
@@ -0,0 +1,96 @@
+#version 410 core
+
+// number of shadow cascades - must match MAX_SHADOW_CASCADES
+// in UniformBufferManager.h
+#define MAX_CASCADES 4
+// faces of a point shadow cube - must match CUBE_FACES in
+// PointShadowMaps.h
+#define CUBE_FACES 6
+
+// one invocation per cascade or cube face, each writing its
+// own layer of the shadow map or cube array
+layout (triangles, invocations = CUBE_FACES) in;
+layout (triangle_strip, max_vertices = 3) out;
+
+layout (std140) uniform CameraBlock
+{
+    mat4 view;
+    mat4 projection;
+    mat4 lightSpaceMatrix;
+    vec4 viewPosition;
+    mat4 cascadeMatrices[MAX_CASCADES];
+    vec4 cascadeSplits;
+};
+
+// bit for each cascade that is drawn in this pass
+uniform int cascadeMask = 0;
+// set while a tile of the shadow atlas is drawn, with the
+// matrix of its light instead of the cascades
+uniform bool bAtlasTile = false;
+uniform mat4 atlasMatrix;
+// set while the cube of a point light is drawn, with the
+// matrix of each face, a bit for each face drawn in this pass
+// and the layer of the first face
+uniform bool bCubeFaces = false;
+uniform mat4 cubeMatrices[CUBE_FACES];
+uniform int faceMask = 0;
+uniform int cubeLayer = 0;
+
+void main()
+{
+    int cascade = gl_InvocationID;
+    int layer = cascade;
+    mat4 shadowMatrix;
+    if (bCubeFaces)
+    {
+        if ((faceMask & (1 << cascade)) == 0)
+        {
+            return;
+        }
+        shadowMatrix = cubeMatrices[cascade];
+        layer = cubeLayer + cascade;
+    }
+    else if (bAtlasTile)
+    {
+        if (cascade != 0)
+        {
+            return;
+        }
+        shadowMatrix = atlasMatrix;
+    }
+    else
+    {
+        if ((cascade >= MAX_CASCADES) || ((cascadeMask & (1 << cascade)) == 0))
+        {
+            return;
+        }
+        shadowMatrix = cascadeMatrices[cascade];
+    }
+
+    vec4 positions[3];
+    for (int i = 0; i < 3; i++)
+    {
+        positions[i] = shadowMatrix * gl_in[i].gl_Position;
+    }
+
+    // drop the triangles that are outside of one side of the
+    // view, which most of them are for the near cascades - the
+    // atlas tiles and cube faces are perspective, so the sides
+    // are at -w and w
+    for (int axis = 0; axis < 2; axis++)
+    {
+        if ((positions[0][axis] < -positions[0].w && positions[1][axis] < -positions[1].w && positions[2][axis] < -positions[2].w) ||
+            (positions[0][axis] > positions[0].w && positions[1][axis] > positions[1].w && positions[2][axis] > positions[2].w))
+        {
+            return;
+        }
+    }
+
+    for (int i = 0; i < 3; i++)
+    {
+        gl_Layer = layer;
+        gl_Position = positions[i];
+        EmitVertex();
+    }
+    EndPrimitive();
+}
\ No newline at end of file
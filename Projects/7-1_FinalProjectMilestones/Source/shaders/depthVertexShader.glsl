@@ -1,11 +1,19 @@
-
 #version 410 core
 layout (location = 0) in vec3 aPos;
+// per-instance model matrix, used when bInstanced is set
+layout (location = 3) in mat4 aInstanceModel;
+// center (xyz) and scale (w) of packed positions - (0, 0, 0, 1)
+// when the attribute is not enabled
+layout (location = 9) in vec4 aMeshDecode;
 
-uniform mat4 lightSpaceMatrix;
 uniform mat4 model;
+uniform bool bInstanced = false;
 
+// the world space position is passed on, and the geometry
+// shader projects it into each of the shadow cascades
 void main()
 {
-    gl_Position = lightSpaceMatrix * model * vec4(aPos, 1.0);
-} 
\ No newline at end of file
+    mat4 objectModel = bInstanced ? aInstanceModel : model;
+    vec3 position = aMeshDecode.xyz + aPos * aMeshDecode.w;
+    gl_Position = objectModel * vec4(position, 1.0);
+}
\ No newline at end of file
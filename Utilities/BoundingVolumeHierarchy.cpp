@@ -0,0 +1,550 @@
+///////////////////////////////////////////////////////////////////////////////
+// boundingvolumehierarchy.cpp
+// ============
+// a four-wide bounding volume hierarchy over the boxes of the scene objects,
+// built with the surface area heuristic and refit when the objects move
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "BoundingVolumeHierarchy.h"
+
+#include <algorithm>
+#include <float.h>
+#include <math.h>
+#include <string.h>
+
+// declaration of global variables
+namespace
+{
+	// most primitives kept in one leaf
+	const uint32_t g_MaxLeafPrimitives = 4;
+	// number of bins the surface area heuristic is evaluated on
+	const int g_SAHBins = 8;
+	// half extent of the empty child slots, which no frustum
+	// or ray test can pass
+	const float g_EmptyExtent = -1.0e30f;
+	// smallest size of a ray direction component, so that an
+	// axis aligned ray gets a large but finite inverse and a
+	// slab plane through its origin gives no 0 * inf
+	const float g_MinRayComponent = 1.0e-8f;
+
+	// half of the surface area of a box
+	float HalfArea(const glm::vec3& minimum, const glm::vec3& maximum)
+	{
+		glm::vec3 size = glm::max(maximum - minimum, glm::vec3(0.0f));
+		return((size.x * size.y) + (size.y * size.z) + (size.z * size.x));
+	}
+
+	// distance along a ray to where it enters a box, or -1
+	// when the ray misses the box
+	float RayBoxDistance(
+		const glm::vec3& origin,
+		const glm::vec3& inverseDirection,
+		const glm::vec3& minimum,
+		const glm::vec3& maximum)
+	{
+		glm::vec3 t0 = (minimum - origin) * inverseDirection;
+		glm::vec3 t1 = (maximum - origin) * inverseDirection;
+		glm::vec3 tNear = glm::min(t0, t1);
+		glm::vec3 tFar = glm::max(t0, t1);
+		float enter = glm::max(glm::max(tNear.x, tNear.y), glm::max(tNear.z, 0.0f));
+		float exit = glm::min(glm::min(tFar.x, tFar.y), tFar.z);
+
+		return((exit >= enter) ? enter : -1.0f);
+	}
+}
+
+/***********************************************************
+ *  BoundingVolumeHierarchy()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+BoundingVolumeHierarchy::BoundingVolumeHierarchy()
+{
+	m_primitiveCount = 0;
+}
+
+/***********************************************************
+ *  Build()
+ *
+ *  This method is used to build the tree over the passed
+ *  in boxes.  Every node splits its primitives into up to
+ *  four groups with the surface area heuristic, and groups
+ *  of a few primitives become leaves.
+ ***********************************************************/
+void BoundingVolumeHierarchy::Build(
+	const Frustum::BOX_ARRAYS& boxes,
+	size_t count)
+{
+	m_nodes.clear();
+	m_primitiveCount = count;
+	LoadPrimitiveBounds(boxes, count);
+
+	m_primitives.resize(count);
+	for (size_t i = 0; i < count; i++)
+	{
+		m_primitives[i] = (uint32_t)i;
+	}
+
+	if (count > 0)
+	{
+		BuildNode(0, (uint32_t)count);
+	}
+}
+
+/***********************************************************
+ *  Refit()
+ *
+ *  This method is used to update the boxes of the nodes for
+ *  primitive boxes that have moved.  The children of a node
+ *  are always stored after it, so walking the nodes from the
+ *  last one refits every child before its parent.
+ ***********************************************************/
+void BoundingVolumeHierarchy::Refit(const Frustum::BOX_ARRAYS& boxes)
+{
+	LoadPrimitiveBounds(boxes, m_primitiveCount);
+
+	for (size_t i = m_nodes.size(); i > 0; i--)
+	{
+		BVH_NODE& node = m_nodes[i - 1];
+		for (int slot = 0; slot < 4; slot++)
+		{
+			if (node.child[slot] >= 0)
+			{
+				SetChildBounds(node, slot, GetNodeBounds(m_nodes[node.child[slot]]));
+			}
+			else if (node.count[slot] > 0)
+			{
+				uint32_t first = (uint32_t)~node.child[slot];
+				SetChildBounds(node, slot, GetPrimitiveBounds(first, first + node.count[slot]));
+			}
+		}
+	}
+}
+
+/***********************************************************
+ *  CullFrustum()
+ *
+ *  This method is used to find the primitives in a view
+ *  volume.  The children of each visited node are tested
+ *  together, and only the nodes that are visible are
+ *  visited, so hidden parts of the scene cost one test.
+ ***********************************************************/
+void BoundingVolumeHierarchy::CullFrustum(
+	const Frustum& frustum,
+	uint8_t* visible)
+{
+	if (m_primitiveCount == 0)
+	{
+		return;
+	}
+	memset(visible, 0, m_primitiveCount);
+
+	m_stack.clear();
+	m_stack.push_back(0);
+
+	while (m_stack.empty() == false)
+	{
+		const BVH_NODE& node = m_nodes[m_stack.back()];
+		m_stack.pop_back();
+
+		Frustum::BOX_ARRAYS children;
+		children.centerX = node.centerX;
+		children.centerY = node.centerY;
+		children.centerZ = node.centerZ;
+		children.extentX = node.extentX;
+		children.extentY = node.extentY;
+		children.extentZ = node.extentZ;
+
+		uint8_t childVisible[4];
+		frustum.CullBoxes(children, 4, childVisible);
+
+		for (int slot = 0; slot < 4; slot++)
+		{
+			if (childVisible[slot] == 0)
+			{
+				continue;
+			}
+
+			if (node.child[slot] >= 0)
+			{
+				m_stack.push_back(node.child[slot]);
+			}
+			else
+			{
+				// a leaf that is visible can still hold primitives
+				// that are outside, so each one is tested again
+				uint32_t first = (uint32_t)~node.child[slot];
+				for (uint32_t i = first; i < first + node.count[slot]; i++)
+				{
+					const BOUNDS& bounds = m_primitiveBounds[m_primitives[i]];
+					glm::vec3 center = 0.5f * (bounds.minimum + bounds.maximum);
+					glm::vec3 extent = 0.5f * (bounds.maximum - bounds.minimum);
+					visible[m_primitives[i]] = frustum.IsBoxVisible(center, extent) ? 1 : 0;
+				}
+			}
+		}
+	}
+}
+
+/***********************************************************
+ *  IntersectRay()
+ *
+ *  This method is used to find the primitive whose box is
+ *  hit first by a ray.  Nodes that are entered farther
+ *  away than the closest hit so far are skipped.
+ ***********************************************************/
+int BoundingVolumeHierarchy::IntersectRay(
+	const glm::vec3& origin,
+	const glm::vec3& direction,
+	float& distance) const
+{
+	int closest = -1;
+	distance = FLT_MAX;
+
+	if (m_primitiveCount == 0)
+	{
+		return(closest);
+	}
+
+	glm::vec3 safeDirection = direction;
+	for (int axis = 0; axis < 3; axis++)
+	{
+		if (fabsf(safeDirection[axis]) < g_MinRayComponent)
+		{
+			safeDirection[axis] = (safeDirection[axis] < 0.0f) ? -g_MinRayComponent : g_MinRayComponent;
+		}
+	}
+	glm::vec3 inverseDirection = 1.0f / safeDirection;
+
+	std::vector<int32_t> stack;
+	stack.push_back(0);
+
+	while (stack.empty() == false)
+	{
+		const BVH_NODE& node = m_nodes[stack.back()];
+		stack.pop_back();
+
+		for (int slot = 0; slot < 4; slot++)
+		{
+			if ((node.child[slot] < 0) && (node.count[slot] == 0))
+			{
+				continue;
+			}
+
+			glm::vec3 center(node.centerX[slot], node.centerY[slot], node.centerZ[slot]);
+			glm::vec3 extent(node.extentX[slot], node.extentY[slot], node.extentZ[slot]);
+			float enter = RayBoxDistance(origin, inverseDirection, center - extent, center + extent);
+			if ((enter < 0.0f) || (enter >= distance))
+			{
+				continue;
+			}
+
+			if (node.child[slot] >= 0)
+			{
+				stack.push_back(node.child[slot]);
+				continue;
+			}
+
+			uint32_t first = (uint32_t)~node.child[slot];
+			for (uint32_t i = first; i < first + node.count[slot]; i++)
+			{
+				const BOUNDS& bounds = m_primitiveBounds[m_primitives[i]];
+				float hit = RayBoxDistance(origin, inverseDirection, bounds.minimum, bounds.maximum);
+				if ((hit >= 0.0f) && (hit < distance))
+				{
+					distance = hit;
+					closest = (int)m_primitives[i];
+				}
+			}
+		}
+	}
+
+	return(closest);
+}
+
+/***********************************************************
+ *  BuildNode()
+ *
+ *  This method is used to build the node over a range of
+ *  the primitives.  The largest group is split until there
+ *  are four groups or every group fits in a leaf.
+ ***********************************************************/
+int32_t BoundingVolumeHierarchy::BuildNode(
+	uint32_t begin,
+	uint32_t end)
+{
+	int32_t index = (int32_t)m_nodes.size();
+	m_nodes.push_back(BVH_NODE());
+
+	uint32_t groupBegin[4];
+	uint32_t groupEnd[4];
+	int nGroups = 1;
+	groupBegin[0] = begin;
+	groupEnd[0] = end;
+
+	while (nGroups < 4)
+	{
+		int largest = -1;
+		for (int group = 0; group < nGroups; group++)
+		{
+			uint32_t size = groupEnd[group] - groupBegin[group];
+			if ((size > g_MaxLeafPrimitives) &&
+				((largest < 0) || (size > groupEnd[largest] - groupBegin[largest])))
+			{
+				largest = group;
+			}
+		}
+		if (largest < 0)
+		{
+			break;
+		}
+
+		uint32_t middle = SplitPrimitives(groupBegin[largest], groupEnd[largest]);
+		groupBegin[nGroups] = middle;
+		groupEnd[nGroups] = groupEnd[largest];
+		groupEnd[largest] = middle;
+		nGroups++;
+	}
+
+	for (int slot = 0; slot < 4; slot++)
+	{
+		if (slot >= nGroups)
+		{
+			BVH_NODE& node = m_nodes[index];
+			node.child[slot] = -1;
+			node.count[slot] = 0;
+			node.centerX[slot] = node.centerY[slot] = node.centerZ[slot] = 0.0f;
+			node.extentX[slot] = node.extentY[slot] = node.extentZ[slot] = g_EmptyExtent;
+			continue;
+		}
+
+		uint32_t size = groupEnd[slot] - groupBegin[slot];
+		int32_t child = ~(int32_t)groupBegin[slot];
+		uint32_t count = size;
+		if (size > g_MaxLeafPrimitives)
+		{
+			// building the child can grow the node list, so the
+			// node is only looked up again afterwards
+			child = BuildNode(groupBegin[slot], groupEnd[slot]);
+			count = 0;
+		}
+
+		BVH_NODE& node = m_nodes[index];
+		node.child[slot] = child;
+		node.count[slot] = count;
+		SetChildBounds(node, slot, GetPrimitiveBounds(groupBegin[slot], groupEnd[slot]));
+	}
+
+	return(index);
+}
+
+/***********************************************************
+ *  SplitPrimitives()
+ *
+ *  This method is used to split a range of primitives in
+ *  two along the longest axis of their centers.  The split
+ *  positions between the bins are costed with the surface
+ *  area heuristic, and primitives that cannot be told apart
+ *  are split at their median.
+ ***********************************************************/
+uint32_t BoundingVolumeHierarchy::SplitPrimitives(
+	uint32_t begin,
+	uint32_t end)
+{
+	glm::vec3 centerMin = m_primitiveCenters[m_primitives[begin]];
+	glm::vec3 centerMax = centerMin;
+	for (uint32_t i = begin + 1; i < end; i++)
+	{
+		centerMin = glm::min(centerMin, m_primitiveCenters[m_primitives[i]]);
+		centerMax = glm::max(centerMax, m_primitiveCenters[m_primitives[i]]);
+	}
+
+	glm::vec3 size = centerMax - centerMin;
+	int axis = 0;
+	if (size.y > size[axis])
+	{
+		axis = 1;
+	}
+	if (size.z > size[axis])
+	{
+		axis = 2;
+	}
+
+	uint32_t middle = begin + (end - begin) / 2;
+
+	if (size[axis] > 0.0f)
+	{
+		float binScale = (float)g_SAHBins / size[axis];
+		int bins[g_SAHBins];
+		BOUNDS binBounds[g_SAHBins];
+		for (int bin = 0; bin < g_SAHBins; bin++)
+		{
+			bins[bin] = 0;
+			binBounds[bin].minimum = glm::vec3(FLT_MAX);
+			binBounds[bin].maximum = glm::vec3(-FLT_MAX);
+		}
+
+		for (uint32_t i = begin; i < end; i++)
+		{
+			uint32_t primitive = m_primitives[i];
+			int bin = glm::min((int)((m_primitiveCenters[primitive][axis] - centerMin[axis]) * binScale), g_SAHBins - 1);
+			bins[bin]++;
+			binBounds[bin].minimum = glm::min(binBounds[bin].minimum, m_primitiveBounds[primitive].minimum);
+			binBounds[bin].maximum = glm::max(binBounds[bin].maximum, m_primitiveBounds[primitive].maximum);
+		}
+
+		// areas and counts on the right of every split, swept
+		// from the last bin
+		float rightArea[g_SAHBins];
+		int rightCount[g_SAHBins];
+		BOUNDS right = binBounds[g_SAHBins - 1];
+		int count = bins[g_SAHBins - 1];
+		for (int bin = g_SAHBins - 1; bin > 0; bin--)
+		{
+			rightArea[bin] = HalfArea(right.minimum, right.maximum);
+			rightCount[bin] = count;
+			right.minimum = glm::min(right.minimum, binBounds[bin - 1].minimum);
+			right.maximum = glm::max(right.maximum, binBounds[bin - 1].maximum);
+			count += bins[bin - 1];
+		}
+
+		int bestSplit = -1;
+		float bestCost = FLT_MAX;
+		BOUNDS left = binBounds[0];
+		count = bins[0];
+		for (int split = 1; split < g_SAHBins; split++)
+		{
+			if ((count > 0) && (rightCount[split] > 0))
+			{
+				float cost = HalfArea(left.minimum, left.maximum) * count + rightArea[split] * rightCount[split];
+				if (cost < bestCost)
+				{
+					bestCost = cost;
+					bestSplit = split;
+				}
+			}
+			left.minimum = glm::min(left.minimum, binBounds[split].minimum);
+			left.maximum = glm::max(left.maximum, binBounds[split].maximum);
+			count += bins[split];
+		}
+
+		if (bestSplit > 0)
+		{
+			uint32_t* first = m_primitives.data() + begin;
+			uint32_t* last = m_primitives.data() + end;
+			uint32_t* partition = std::partition(first, last, [&](uint32_t primitive) {
+				int bin = glm::min((int)((m_primitiveCenters[primitive][axis] - centerMin[axis]) * binScale), g_SAHBins - 1);
+				return(bin < bestSplit);
+			});
+			uint32_t split = begin + (uint32_t)(partition - first);
+
+			if ((split > begin) && (split < end))
+			{
+				return(split);
+			}
+		}
+	}
+
+	// split at the median of the centers along the axis
+	std::nth_element(m_primitives.data() + begin, m_primitives.data() + middle, m_primitives.data() + end,
+		[&](uint32_t a, uint32_t b) { return(m_primitiveCenters[a][axis] < m_primitiveCenters[b][axis]); });
+
+	return(middle);
+}
+
+/***********************************************************
+ *  GetPrimitiveBounds()
+ *
+ *  This method is used to get the box around a range of
+ *  the primitives.
+ ***********************************************************/
+BoundingVolumeHierarchy::BOUNDS BoundingVolumeHierarchy::GetPrimitiveBounds(
+	uint32_t begin,
+	uint32_t end) const
+{
+	BOUNDS bounds = m_primitiveBounds[m_primitives[begin]];
+	for (uint32_t i = begin + 1; i < end; i++)
+	{
+		const BOUNDS& primitive = m_primitiveBounds[m_primitives[i]];
+		bounds.minimum = glm::min(bounds.minimum, primitive.minimum);
+		bounds.maximum = glm::max(bounds.maximum, primitive.maximum);
+	}
+
+	return(bounds);
+}
+
+/***********************************************************
+ *  GetNodeBounds()
+ *
+ *  This method is used to get the box around the children
+ *  of a node.
+ ***********************************************************/
+BoundingVolumeHierarchy::BOUNDS BoundingVolumeHierarchy::GetNodeBounds(const BVH_NODE& node) const
+{
+	BOUNDS bounds;
+	bounds.minimum = glm::vec3(FLT_MAX);
+	bounds.maximum = glm::vec3(-FLT_MAX);
+
+	for (int slot = 0; slot < 4; slot++)
+	{
+		if ((node.child[slot] < 0) && (node.count[slot] == 0))
+		{
+			continue;
+		}
+
+		glm::vec3 center(node.centerX[slot], node.centerY[slot], node.centerZ[slot]);
+		glm::vec3 extent(node.extentX[slot], node.extentY[slot], node.extentZ[slot]);
+		bounds.minimum = glm::min(bounds.minimum, center - extent);
+		bounds.maximum = glm::max(bounds.maximum, center + extent);
+	}
+
+	return(bounds);
+}
+
+/***********************************************************
+ *  SetChildBounds()
+ *
+ *  This method is used to store a box in a child slot of
+ *  a node as its center and half extents.
+ ***********************************************************/
+void BoundingVolumeHierarchy::SetChildBounds(
+	BVH_NODE& node,
+	int slot,
+	const BOUNDS& bounds)
+{
+	glm::vec3 center = 0.5f * (bounds.minimum + bounds.maximum);
+	glm::vec3 extent = 0.5f * (bounds.maximum - bounds.minimum);
+
+	node.centerX[slot] = center.x;
+	node.centerY[slot] = center.y;
+	node.centerZ[slot] = center.z;
+	node.extentX[slot] = extent.x;
+	node.extentY[slot] = extent.y;
+	node.extentZ[slot] = extent.z;
+}
+
+/***********************************************************
+ *  LoadPrimitiveBounds()
+ *
+ *  This method is used to convert the primitive boxes from
+ *  centers and half extents to corners.
+ ***********************************************************/
+void BoundingVolumeHierarchy::LoadPrimitiveBounds(
+	const Frustum::BOX_ARRAYS& boxes,
+	size_t count)
+{
+	m_primitiveBounds.resize(count);
+	m_primitiveCenters.resize(count);
+
+	for (size_t i = 0; i < count; i++)
+	{
+		glm::vec3 center(boxes.centerX[i], boxes.centerY[i], boxes.centerZ[i]);
+		glm::vec3 extent(boxes.extentX[i], boxes.extentY[i], boxes.extentZ[i]);
+
+		m_primitiveCenters[i] = center;
+		m_primitiveBounds[i].minimum = center - extent;
+		m_primitiveBounds[i].maximum = center + extent;
+	}
+}
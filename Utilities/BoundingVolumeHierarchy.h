@@ -0,0 +1,117 @@
+///////////////////////////////////////////////////////////////////////////////
+// boundingvolumehierarchy.h
+// ============
+// a four-wide bounding volume hierarchy over the boxes of the scene objects,
+// built with the surface area heuristic and refit when the objects move
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+
+#include "Frustum.h"
+
+/***********************************************************
+ *  BoundingVolumeHierarchy
+ *
+ *  This class holds a tree of boxes over a set of object
+ *  boxes, which are called primitives here.  Every node has
+ *  up to four children whose boxes are stored with each
+ *  component in its own array, so that the four children
+ *  of a node are culled with one SIMD frustum test.
+ ***********************************************************/
+class BoundingVolumeHierarchy
+{
+public:
+	// constructor
+	BoundingVolumeHierarchy();
+
+	// build the tree over count primitive boxes
+	void Build(
+		const Frustum::BOX_ARRAYS& boxes,
+		size_t count);
+	// update the node boxes after the primitive boxes moved,
+	// keeping the tree structure
+	void Refit(const Frustum::BOX_ARRAYS& boxes);
+
+	// write 1 for each primitive whose box is in the view
+	// volume and 0 for the others
+	void CullFrustum(
+		const Frustum& frustum,
+		uint8_t* visible);
+	// find the primitive whose box a ray hits first, or -1,
+	// along with the distance to the hit
+	int IntersectRay(
+		const glm::vec3& origin,
+		const glm::vec3& direction,
+		float& distance) const;
+
+	// number of primitives the tree was built over
+	size_t GetPrimitiveCount() const { return(m_primitiveCount); }
+
+private:
+	// one node of the tree - a child is either another node,
+	// when its index is not negative, or a leaf that holds
+	// count primitives starting at ~child in the primitive list
+	struct BVH_NODE
+	{
+		float centerX[4];
+		float centerY[4];
+		float centerZ[4];
+		float extentX[4];
+		float extentY[4];
+		float extentZ[4];
+		int32_t child[4];
+		uint32_t count[4];
+	};
+
+	// corners of a box while building and refitting
+	struct BOUNDS
+	{
+		glm::vec3 minimum;
+		glm::vec3 maximum;
+	};
+
+	std::vector<BVH_NODE> m_nodes;
+	// primitive indices, grouped by leaf
+	std::vector<uint32_t> m_primitives;
+	// primitive boxes and centers used while building
+	std::vector<BOUNDS> m_primitiveBounds;
+	std::vector<glm::vec3> m_primitiveCenters;
+	// nodes left to visit while traversing
+	std::vector<int32_t> m_stack;
+	size_t m_primitiveCount;
+
+	// build the node over the primitives between begin and
+	// end and return its index
+	int32_t BuildNode(
+		uint32_t begin,
+		uint32_t end);
+	// split the primitives between begin and end where the
+	// surface area heuristic costs the least, and return the
+	// first primitive of the second half
+	uint32_t SplitPrimitives(
+		uint32_t begin,
+		uint32_t end);
+	// get the box around the primitives between begin and end
+	BOUNDS GetPrimitiveBounds(
+		uint32_t begin,
+		uint32_t end) const;
+	// get the box around the children of a node
+	BOUNDS GetNodeBounds(const BVH_NODE& node) const;
+	// store a box in a child slot of a node
+	static void SetChildBounds(
+		BVH_NODE& node,
+		int slot,
+		const BOUNDS& bounds);
+	// make the primitive bounds from the box arrays
+	void LoadPrimitiveBounds(
+		const Frustum::BOX_ARRAYS& boxes,
+		size_t count);
+};
@@ -0,0 +1,183 @@
+///////////////////////////////////////////////////////////////////////////////
+// frustum.cpp
+// ============
+// extract the clip planes of a view-projection matrix and test bounding boxes
+// against them, four boxes at a time with SSE
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "Frustum.h"
+
+#include <cmath>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE__)
+#define FRUSTUM_USE_SSE
+#include <xmmintrin.h>
+#endif
+
+/***********************************************************
+ *  Frustum()
+ *
+ *  The constructor for the class - every box is visible
+ *  until the planes are set.
+ ***********************************************************/
+Frustum::Frustum()
+{
+	for (int plane = 0; plane < plane_count; plane++)
+	{
+		m_planes[plane] = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+	}
+}
+
+/***********************************************************
+ *  SetMatrix()
+ *
+ *  This method is used to extract the six planes from the
+ *  rows of a projection * view matrix.  The planes are
+ *  normalized so that the box tests compare distances.
+ ***********************************************************/
+void Frustum::SetMatrix(const glm::mat4& viewProjection)
+{
+	// glm matrices are column major, so gather the rows first
+	glm::vec4 row0(viewProjection[0][0], viewProjection[1][0], viewProjection[2][0], viewProjection[3][0]);
+	glm::vec4 row1(viewProjection[0][1], viewProjection[1][1], viewProjection[2][1], viewProjection[3][1]);
+	glm::vec4 row2(viewProjection[0][2], viewProjection[1][2], viewProjection[2][2], viewProjection[3][2]);
+	glm::vec4 row3(viewProjection[0][3], viewProjection[1][3], viewProjection[2][3], viewProjection[3][3]);
+
+	m_planes[plane_left] = row3 + row0;
+	m_planes[plane_right] = row3 - row0;
+	m_planes[plane_bottom] = row3 + row1;
+	m_planes[plane_top] = row3 - row1;
+	m_planes[plane_near] = row3 + row2;
+	m_planes[plane_far] = row3 - row2;
+
+	for (int plane = 0; plane < plane_count; plane++)
+	{
+		float length = glm::length(glm::vec3(m_planes[plane]));
+		if (length > 0.0f)
+		{
+			m_planes[plane] /= length;
+		}
+	}
+}
+
+/***********************************************************
+ *  IsBoxVisible()
+ *
+ *  This method is used to test one box against the planes.
+ *  The box is outside when its corner that is farthest
+ *  along a plane normal is still behind that plane.
+ ***********************************************************/
+bool Frustum::IsBoxVisible(
+	const glm::vec3& center,
+	const glm::vec3& extent) const
+{
+	for (int plane = 0; plane < plane_count; plane++)
+	{
+		glm::vec3 normal = glm::vec3(m_planes[plane]);
+		float distance = glm::dot(normal, center) + m_planes[plane].w;
+		float radius = glm::dot(glm::abs(normal), extent);
+
+		if (distance + radius < 0.0f)
+		{
+			return(false);
+		}
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  CullBoxes()
+ *
+ *  This method is used to test many boxes against the
+ *  planes.  With SSE four boxes are tested at a time, and
+ *  the boxes that are left over use the scalar test.
+ ***********************************************************/
+void Frustum::CullBoxes(
+	const BOX_ARRAYS& boxes,
+	size_t count,
+	uint8_t* visible) const
+{
+	size_t i = 0;
+
+#ifdef FRUSTUM_USE_SSE
+	__m128 planeX[plane_count];
+	__m128 planeY[plane_count];
+	__m128 planeZ[plane_count];
+	__m128 planeW[plane_count];
+	__m128 absX[plane_count];
+	__m128 absY[plane_count];
+	__m128 absZ[plane_count];
+
+	for (int plane = 0; plane < plane_count; plane++)
+	{
+		planeX[plane] = _mm_set1_ps(m_planes[plane].x);
+		planeY[plane] = _mm_set1_ps(m_planes[plane].y);
+		planeZ[plane] = _mm_set1_ps(m_planes[plane].z);
+		planeW[plane] = _mm_set1_ps(m_planes[plane].w);
+		absX[plane] = _mm_set1_ps(fabs(m_planes[plane].x));
+		absY[plane] = _mm_set1_ps(fabs(m_planes[plane].y));
+		absZ[plane] = _mm_set1_ps(fabs(m_planes[plane].z));
+	}
+
+	__m128 zero = _mm_setzero_ps();
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128 centerX = _mm_loadu_ps(boxes.centerX + i);
+		__m128 centerY = _mm_loadu_ps(boxes.centerY + i);
+		__m128 centerZ = _mm_loadu_ps(boxes.centerZ + i);
+		__m128 extentX = _mm_loadu_ps(boxes.extentX + i);
+		__m128 extentY = _mm_loadu_ps(boxes.extentY + i);
+		__m128 extentZ = _mm_loadu_ps(boxes.extentZ + i);
+
+		// all bits set in the lanes of the boxes that are inside
+		__m128 inside = _mm_cmpeq_ps(zero, zero);
+		for (int plane = 0; plane < plane_count; plane++)
+		{
+			__m128 distance = _mm_add_ps(
+				_mm_add_ps(_mm_mul_ps(planeX[plane], centerX), _mm_mul_ps(planeY[plane], centerY)),
+				_mm_add_ps(_mm_mul_ps(planeZ[plane], centerZ), planeW[plane]));
+			__m128 radius = _mm_add_ps(
+				_mm_add_ps(_mm_mul_ps(absX[plane], extentX), _mm_mul_ps(absY[plane], extentY)),
+				_mm_mul_ps(absZ[plane], extentZ));
+
+			inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(distance, radius), zero));
+		}
+
+		int mask = _mm_movemask_ps(inside);
+		visible[i] = (uint8_t)(mask & 1);
+		visible[i + 1] = (uint8_t)((mask >> 1) & 1);
+		visible[i + 2] = (uint8_t)((mask >> 2) & 1);
+		visible[i + 3] = (uint8_t)((mask >> 3) & 1);
+	}
+#endif
+
+	for (; i < count; i++)
+	{
+		glm::vec3 center(boxes.centerX[i], boxes.centerY[i], boxes.centerZ[i]);
+		glm::vec3 extent(boxes.extentX[i], boxes.extentY[i], boxes.extentZ[i]);
+		visible[i] = IsBoxVisible(center, extent) ? 1 : 0;
+	}
+}
+
+/***********************************************************
+ *  TransformBox()
+ *
+ *  This method is used to transform a box given by its
+ *  center and half extents.  The extents of the new box
+ *  are the extents projected on the transformed axes.
+ ***********************************************************/
+void Frustum::TransformBox(
+	const glm::mat4& transform,
+	const glm::vec3& center,
+	const glm::vec3& extent,
+	glm::vec3& outCenter,
+	glm::vec3& outExtent)
+{
+	outCenter = glm::vec3(transform * glm::vec4(center, 1.0f));
+	outExtent = glm::abs(glm::vec3(transform[0])) * extent.x +
+		glm::abs(glm::vec3(transform[1])) * extent.y +
+		glm::abs(glm::vec3(transform[2])) * extent.z;
+}
@@ -0,0 +1,84 @@
+///////////////////////////////////////////////////////////////////////////////
+// frustum.h
+// ============
+// extract the clip planes of a view-projection matrix and test bounding boxes
+// against them, four boxes at a time with SSE
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <stdint.h>
+#include <stddef.h>
+
+/***********************************************************
+ *  Frustum
+ *
+ *  This class holds the six planes of a view volume, with
+ *  the normals pointing into the volume.  The boxes are
+ *  passed as centers and half extents, with every component
+ *  in its own array, so that four boxes load into one SSE
+ *  register per component.
+ ***********************************************************/
+class Frustum
+{
+public:
+	// planes of the view volume
+	enum FrustumPlane
+	{
+		plane_left,
+		plane_right,
+		plane_bottom,
+		plane_top,
+		plane_near,
+		plane_far,
+		plane_count
+	};
+
+	// bounding boxes in structure of arrays form
+	struct BOX_ARRAYS
+	{
+		const float* centerX;
+		const float* centerY;
+		const float* centerZ;
+		const float* extentX;
+		const float* extentY;
+		const float* extentZ;
+	};
+
+	// constructor
+	Frustum();
+
+	// set the planes from a projection * view matrix
+	void SetMatrix(const glm::mat4& viewProjection);
+
+	// test a box given by its center and half extents
+	bool IsBoxVisible(
+		const glm::vec3& center,
+		const glm::vec3& extent) const;
+	// test count boxes and write 1 for each visible box and
+	// 0 for each box that is outside of the view volume
+	void CullBoxes(
+		const BOX_ARRAYS& boxes,
+		size_t count,
+		uint8_t* visible) const;
+
+	// get a plane, with the normal in xyz and the distance in w
+	const glm::vec4& GetPlane(int plane) const { return(m_planes[plane]); }
+
+	// transform a box given by its center and half extents,
+	// returning the box around the transformed box
+	static void TransformBox(
+		const glm::mat4& transform,
+		const glm::vec3& center,
+		const glm::vec3& extent,
+		glm::vec3& outCenter,
+		glm::vec3& outExtent);
+
+private:
+	// plane normals (xyz) and distances (w)
+	glm::vec4 m_planes[plane_count];
+};
@@ -0,0 +1,399 @@
+///////////////////////////////////////////////////////////////////////////////
+// gpuculler.cpp
+// ============
+// cull instances with compute shaders against the view volume and the depth
+// pyramid of the last frame, and write the surviving indirect draw commands
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "GPUCuller.h"
+
+#include <string>
+
+// declaration of global variables
+namespace
+{
+	const char* g_CullShaderName = "cullInstancesCompShader.glsl";
+	const char* g_CompactShaderName = "compactDrawsCompShader.glsl";
+	const char* g_PyramidShaderName = "depthPyramidCompShader.glsl";
+
+	// threads in each work group of the culling shaders
+	const GLuint g_CullGroupSize = 64;
+	// threads along each side of the work groups of the
+	// depth pyramid shader
+	const GLuint g_PyramidGroupSize = 8;
+	// size of one DrawElementsIndirectCommand
+	const GLsizeiptr g_CommandSize = 5 * sizeof(GLuint);
+
+	// storage buffer bindings used by the culling shaders
+	enum CullBinding
+	{
+		binding_source_instances,
+		binding_culled_instances,
+		binding_bounds,
+		binding_commands,
+		binding_visible_counts,
+		binding_command_batches,
+		binding_culled_commands,
+		binding_draw_counts
+	};
+}
+
+/***********************************************************
+ *  GPUCuller()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+GPUCuller::GPUCuller()
+{
+	m_cullShader.m_programID = 0;
+	m_compactShader.m_programID = 0;
+	m_pyramidShader.m_programID = 0;
+	m_bLoaded = false;
+
+	GROWING_BUFFER empty = { 0, 0 };
+	m_sourceInstances = empty;
+	m_bounds = empty;
+	m_commands = empty;
+	m_commandBatches = empty;
+	m_visibleCounts = empty;
+	m_culledCommands = empty;
+	m_drawCounts = empty;
+
+	m_depthCopy = 0;
+	m_depthPyramid = 0;
+	m_depthWidth = 0;
+	m_depthHeight = 0;
+	m_pyramidLevels = 0;
+	m_pyramidViewProjection = glm::mat4(1.0f);
+
+	// the last texture unit is left free by the scene textures
+	GLint textureUnits = 0;
+	glGetIntegerv(GL_MAX_COMBINED_TEXTURE_IMAGE_UNITS, &textureUnits);
+	m_depthTextureUnit = glm::max(textureUnits - 1, 0);
+}
+
+/***********************************************************
+ *  ~GPUCuller()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+GPUCuller::~GPUCuller()
+{
+	DeleteBuffer(m_sourceInstances);
+	DeleteBuffer(m_bounds);
+	DeleteBuffer(m_commands);
+	DeleteBuffer(m_commandBatches);
+	DeleteBuffer(m_visibleCounts);
+	DeleteBuffer(m_culledCommands);
+	DeleteBuffer(m_drawCounts);
+
+	if (m_depthCopy != 0)
+	{
+		glDeleteTextures(1, &m_depthCopy);
+		m_depthCopy = 0;
+	}
+	if (m_depthPyramid != 0)
+	{
+		glDeleteTextures(1, &m_depthPyramid);
+		m_depthPyramid = 0;
+	}
+
+	GLuint programs[] = { m_cullShader.m_programID, m_compactShader.m_programID, m_pyramidShader.m_programID };
+	for (int i = 0; i < 3; i++)
+	{
+		if (programs[i] != 0)
+		{
+			glDeleteProgram(programs[i]);
+		}
+	}
+}
+
+/***********************************************************
+ *  IsSupported()
+ *
+ *  This method is used to check for GL 4.6, which has the
+ *  compute shaders, storage buffers and indirect count
+ *  draws that the culling needs.
+ ***********************************************************/
+bool GPUCuller::IsSupported()
+{
+	return(GLEW_VERSION_4_6 == GL_TRUE);
+}
+
+/***********************************************************
+ *  LoadShaders()
+ *
+ *  This method is used to load the three compute shaders.
+ *  The culling is only run when all of them are loaded.
+ ***********************************************************/
+bool GPUCuller::LoadShaders(const char* shaderDirectory)
+{
+	std::string directory(shaderDirectory);
+
+	m_bLoaded =
+		(m_cullShader.LoadComputeShader((directory + g_CullShaderName).c_str()) != 0) &&
+		(m_compactShader.LoadComputeShader((directory + g_CompactShaderName).c_str()) != 0) &&
+		(m_pyramidShader.LoadComputeShader((directory + g_PyramidShaderName).c_str()) != 0);
+
+	return(m_bLoaded);
+}
+
+/***********************************************************
+ *  CullDraws()
+ *
+ *  This method is used to cull the instances of the draw
+ *  commands and write the commands that are left.  The
+ *  instances are first copied aside on the GPU, since the
+ *  culling shader writes the visible ones back into the
+ *  instance buffer the draws read.
+ ***********************************************************/
+void GPUCuller::CullDraws(
+	GLuint instanceBuffer,
+	GLsizei instanceSize,
+	GLsizei nInstances,
+	const INSTANCE_BOUNDS* bounds,
+	const void* commands,
+	const COMMAND_BATCH* commandBatches,
+	GLsizei nCommands,
+	GLsizei nBatches,
+	const Frustum& frustum,
+	bool bOcclusion)
+{
+	if ((m_bLoaded == false) || (nInstances <= 0) || (nCommands <= 0) || (nBatches <= 0))
+	{
+		return;
+	}
+
+	GLsizeiptr instanceBytes = (GLsizeiptr)instanceSize * nInstances;
+	UploadBuffer(m_sourceInstances, instanceBytes, NULL);
+	glBindBuffer(GL_COPY_READ_BUFFER, instanceBuffer);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, m_sourceInstances.buffer);
+	glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, instanceBytes);
+	glBindBuffer(GL_COPY_READ_BUFFER, 0);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+	UploadBuffer(m_bounds, sizeof(INSTANCE_BOUNDS) * nInstances, bounds);
+	UploadBuffer(m_commands, g_CommandSize * nCommands, commands);
+	UploadBuffer(m_commandBatches, sizeof(COMMAND_BATCH) * nCommands, commandBatches);
+	UploadBuffer(m_visibleCounts, sizeof(GLuint) * nCommands, NULL);
+	UploadBuffer(m_culledCommands, g_CommandSize * nCommands, NULL);
+	UploadBuffer(m_drawCounts, sizeof(GLuint) * nBatches, NULL);
+
+	// every count starts at zero and is raised by the shaders
+	GLuint zero = 0;
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_visibleCounts.buffer);
+	glClearBufferSubData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, 0, sizeof(GLuint) * nCommands, GL_RED_INTEGER, GL_UNSIGNED_INT, &zero);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_drawCounts.buffer);
+	glClearBufferSubData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, 0, sizeof(GLuint) * nBatches, GL_RED_INTEGER, GL_UNSIGNED_INT, &zero);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, binding_source_instances, m_sourceInstances.buffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, binding_culled_instances, instanceBuffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, binding_bounds, m_bounds.buffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, binding_commands, m_commands.buffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, binding_visible_counts, m_visibleCounts.buffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, binding_command_batches, m_commandBatches.buffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, binding_culled_commands, m_culledCommands.buffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, binding_draw_counts, m_drawCounts.buffer);
+
+	// test the instances and compact the visible ones
+	glm::vec4 planes[Frustum::plane_count];
+	for (int plane = 0; plane < Frustum::plane_count; plane++)
+	{
+		planes[plane] = frustum.GetPlane(plane);
+	}
+
+	bool bUsePyramid = bOcclusion && (m_depthPyramid != 0);
+
+	m_cullShader.use();
+	m_cullShader.setIntValue("instanceCount", nInstances);
+	m_cullShader.setIntValue("instanceFloats", instanceSize / (GLsizei)sizeof(GLfloat));
+	glUniform4fv(m_cullShader.GetUniformHandle("frustumPlanes").location, Frustum::plane_count, &planes[0][0]);
+	m_cullShader.setBoolValue("bOcclusion", bUsePyramid);
+	if (bUsePyramid == true)
+	{
+		glActiveTexture(GL_TEXTURE0 + m_depthTextureUnit);
+		glBindTexture(GL_TEXTURE_2D, m_depthPyramid);
+		glActiveTexture(GL_TEXTURE0);
+		m_cullShader.setSampler2DValue("depthPyramid", m_depthTextureUnit);
+		m_cullShader.setIntValue("pyramidLevels", m_pyramidLevels);
+		m_cullShader.setMat4Value("pyramidViewProjection", m_pyramidViewProjection);
+	}
+	glDispatchCompute((nInstances + g_CullGroupSize - 1) / g_CullGroupSize, 1, 1);
+	glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+	// write the commands that have visible instances
+	m_compactShader.use();
+	m_compactShader.setIntValue("commandCount", nCommands);
+	glDispatchCompute((nCommands + g_CullGroupSize - 1) / g_CullGroupSize, 1, 1);
+
+	// the draws read the commands, the counts and the
+	// compacted instances
+	glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT);
+}
+
+/***********************************************************
+ *  UpdateDepthPyramid()
+ *
+ *  This method is used to copy the depth buffer that was
+ *  just drawn and reduce it into the depth pyramid.  Each
+ *  texel of a level holds the farthest depth of the texels
+ *  below it, so the next frame can test a box against a
+ *  few texels of the level that fits its size.
+ ***********************************************************/
+void GPUCuller::UpdateDepthPyramid(const glm::mat4& viewProjection)
+{
+	if (m_bLoaded == false)
+	{
+		return;
+	}
+
+	GLint viewport[4];
+	glGetIntegerv(GL_VIEWPORT, viewport);
+	if ((viewport[2] <= 1) || (viewport[3] <= 1))
+	{
+		return;
+	}
+	if ((viewport[2] != m_depthWidth) || (viewport[3] != m_depthHeight))
+	{
+		CreateDepthPyramid(viewport[2], viewport[3]);
+	}
+
+	glActiveTexture(GL_TEXTURE0 + m_depthTextureUnit);
+	glBindTexture(GL_TEXTURE_2D, m_depthCopy);
+	glCopyTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, viewport[0], viewport[1], viewport[2], viewport[3]);
+
+	m_pyramidShader.use();
+	m_pyramidShader.setSampler2DValue("sourceDepth", m_depthTextureUnit);
+
+	GLsizei levelWidth = glm::max(m_depthWidth / 2, 1);
+	GLsizei levelHeight = glm::max(m_depthHeight / 2, 1);
+	for (GLint level = 0; level < m_pyramidLevels; level++)
+	{
+		// the first level is reduced from the depth copy and
+		// every other level from the level before it
+		if (level == 0)
+		{
+			glBindTexture(GL_TEXTURE_2D, m_depthCopy);
+			m_pyramidShader.setIntValue("sourceLevel", 0);
+		}
+		else
+		{
+			glBindTexture(GL_TEXTURE_2D, m_depthPyramid);
+			m_pyramidShader.setIntValue("sourceLevel", level - 1);
+		}
+		glBindImageTexture(0, m_depthPyramid, level, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+
+		glDispatchCompute(
+			(levelWidth + g_PyramidGroupSize - 1) / g_PyramidGroupSize,
+			(levelHeight + g_PyramidGroupSize - 1) / g_PyramidGroupSize,
+			1);
+		glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+
+		levelWidth = glm::max(levelWidth / 2, 1);
+		levelHeight = glm::max(levelHeight / 2, 1);
+	}
+
+	glBindImageTexture(0, 0, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+	glBindTexture(GL_TEXTURE_2D, 0);
+	glActiveTexture(GL_TEXTURE0);
+
+	m_pyramidViewProjection = viewProjection;
+}
+
+/***********************************************************
+ *  CreateDepthPyramid()
+ *
+ *  This method is used to allocate the copy of the depth
+ *  buffer and the pyramid, which starts at half of the size
+ *  of the depth buffer.
+ ***********************************************************/
+void GPUCuller::CreateDepthPyramid(
+	GLsizei width,
+	GLsizei height)
+{
+	if (m_depthCopy != 0)
+	{
+		glDeleteTextures(1, &m_depthCopy);
+	}
+	if (m_depthPyramid != 0)
+	{
+		glDeleteTextures(1, &m_depthPyramid);
+	}
+
+	m_depthWidth = width;
+	m_depthHeight = height;
+
+	glGenTextures(1, &m_depthCopy);
+	glBindTexture(GL_TEXTURE_2D, m_depthCopy);
+	glTexStorage2D(GL_TEXTURE_2D, 1, GL_DEPTH_COMPONENT32F, width, height);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_MODE, GL_NONE);
+
+	GLsizei pyramidWidth = glm::max(width / 2, 1);
+	GLsizei pyramidHeight = glm::max(height / 2, 1);
+	m_pyramidLevels = 1;
+	while ((pyramidWidth >> m_pyramidLevels) > 0 || (pyramidHeight >> m_pyramidLevels) > 0)
+	{
+		m_pyramidLevels++;
+	}
+
+	glGenTextures(1, &m_depthPyramid);
+	glBindTexture(GL_TEXTURE_2D, m_depthPyramid);
+	glTexStorage2D(GL_TEXTURE_2D, m_pyramidLevels, GL_R32F, pyramidWidth, pyramidHeight);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+/***********************************************************
+ *  UploadBuffer()
+ *
+ *  This method is used to make room in a buffer and upload
+ *  data into it.  A buffer that is only written by the
+ *  shaders is passed NULL and keeps its storage.
+ ***********************************************************/
+void GPUCuller::UploadBuffer(
+	GROWING_BUFFER& buffer,
+	GLsizeiptr size,
+	const void* data)
+{
+	if (buffer.buffer == 0)
+	{
+		glGenBuffers(1, &buffer.buffer);
+	}
+	glBindBuffer(GL_COPY_WRITE_BUFFER, buffer.buffer);
+
+	if (size > buffer.capacity)
+	{
+		buffer.capacity = size;
+		glBufferData(GL_COPY_WRITE_BUFFER, size, data, GL_DYNAMIC_DRAW);
+	}
+	else if (NULL != data)
+	{
+		// orphan the old storage so that the upload does not wait
+		// for the shaders that are still reading it
+		glBufferData(GL_COPY_WRITE_BUFFER, buffer.capacity, NULL, GL_DYNAMIC_DRAW);
+		glBufferSubData(GL_COPY_WRITE_BUFFER, 0, size, data);
+	}
+
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
+
+/***********************************************************
+ *  DeleteBuffer()
+ *
+ *  This method is used to delete a buffer.
+ ***********************************************************/
+void GPUCuller::DeleteBuffer(GROWING_BUFFER& buffer)
+{
+	if (buffer.buffer != 0)
+	{
+		glDeleteBuffers(1, &buffer.buffer);
+	}
+	buffer.buffer = 0;
+	buffer.capacity = 0;
+}
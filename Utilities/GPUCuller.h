@@ -0,0 +1,143 @@
+///////////////////////////////////////////////////////////////////////////////
+// gpuculler.h
+// ============
+// cull instances with compute shaders against the view volume and the depth
+// pyramid of the last frame, and write the surviving indirect draw commands
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+#include <glm/glm.hpp>
+
+#include "ShaderManager.h"
+#include "Frustum.h"
+
+/***********************************************************
+ *  GPUCuller
+ *
+ *  This class runs the culling of instanced draws on the
+ *  GPU.  The first compute pass tests the box of every
+ *  instance and copies the visible instances together at
+ *  the start of the range of their draw command.  The
+ *  second pass writes the commands that still have visible
+ *  instances into the command buffer of their batch and
+ *  counts them, so that each batch is drawn with one
+ *  glMultiDrawElementsIndirectCount call.
+ ***********************************************************/
+class GPUCuller
+{
+public:
+	// constructor
+	GPUCuller();
+	// destructor
+	~GPUCuller();
+
+	// box of one instance and the command that draws it, in
+	// the std430 layout the culling shader reads
+	struct INSTANCE_BOUNDS
+	{
+		glm::vec3 center;
+		GLuint command;		// index of the draw command, or no_command
+		glm::vec3 extent;
+		GLuint padding;
+	};
+
+	// multi-draw call a draw command belongs to
+	struct COMMAND_BATCH
+	{
+		GLuint batch;			// index of the batch
+		GLuint firstCommand;	// first command of the batch
+	};
+
+	// command index of the instances that are not culled here
+	static const GLuint no_command = 0xFFFFFFFFu;
+
+	// check whether the GL context has compute shaders and
+	// indirect count draws
+	static bool IsSupported();
+
+	// load the compute shaders from a directory, which has
+	// to end with a path separator
+	bool LoadShaders(const char* shaderDirectory);
+
+	// cull the instances and write the visible draw commands -
+	// the instances are read from and compacted back into
+	// instanceBuffer, and the commands are in the layout of
+	// DrawElementsIndirectCommand, five 32-bit values each
+	void CullDraws(
+		GLuint instanceBuffer,
+		GLsizei instanceSize,
+		GLsizei nInstances,
+		const INSTANCE_BOUNDS* bounds,
+		const void* commands,
+		const COMMAND_BATCH* commandBatches,
+		GLsizei nCommands,
+		GLsizei nBatches,
+		const Frustum& frustum,
+		bool bOcclusion);
+
+	// buffers that the culled commands and the number of
+	// commands of each batch are written to
+	GLuint GetCommandBuffer() const { return(m_culledCommands.buffer); }
+	GLuint GetCountBuffer() const { return(m_drawCounts.buffer); }
+
+	// build the depth pyramid from the depth buffer of the
+	// framebuffer that is bound for reading, which was drawn
+	// with the passed in projection * view matrix
+	void UpdateDepthPyramid(const glm::mat4& viewProjection);
+	// whether a depth pyramid has been built to cull against
+	bool HasDepthPyramid() const { return(m_depthPyramid != 0); }
+
+private:
+	// a buffer that only grows
+	struct GROWING_BUFFER
+	{
+		GLuint buffer;
+		GLsizeiptr capacity;
+	};
+
+	ShaderManager m_cullShader;
+	ShaderManager m_compactShader;
+	ShaderManager m_pyramidShader;
+	bool m_bLoaded;
+
+	// copy of the instances before they are compacted
+	GROWING_BUFFER m_sourceInstances;
+	GROWING_BUFFER m_bounds;
+	GROWING_BUFFER m_commands;
+	GROWING_BUFFER m_commandBatches;
+	// number of visible instances of each command
+	GROWING_BUFFER m_visibleCounts;
+	GROWING_BUFFER m_culledCommands;
+	GROWING_BUFFER m_drawCounts;
+
+	// copy of the depth buffer and the pyramid of the farthest
+	// depths built from it
+	GLuint m_depthCopy;
+	GLuint m_depthPyramid;
+	GLsizei m_depthWidth;
+	GLsizei m_depthHeight;
+	GLint m_pyramidLevels;
+	// matrix the depth pyramid was drawn with
+	glm::mat4 m_pyramidViewProjection;
+	// texture unit used to read the depth textures, kept
+	// clear of the units of the scene textures
+	GLint m_depthTextureUnit;
+
+	// make room for size bytes in a buffer and upload data,
+	// when it is not NULL
+	static void UploadBuffer(
+		GROWING_BUFFER& buffer,
+		GLsizeiptr size,
+		const void* data);
+	// delete a buffer
+	static void DeleteBuffer(GROWING_BUFFER& buffer);
+	// allocate the depth copy and the pyramid for a size
+	void CreateDepthPyramid(
+		GLsizei width,
+		GLsizei height);
+};
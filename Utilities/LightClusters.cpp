@@ -0,0 +1,444 @@
+///////////////////////////////////////////////////////////////////////////////
+// lightclusters.cpp
+// ============
+// split the view volume into clusters and assign the local lights of the
+// scene to them with a compute shader, for clustered forward shading
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "LightClusters.h"
+
+#include <math.h>
+#include <string.h>
+#include <string>
+
+// declaration of global variables
+namespace
+{
+	const char* g_AssignShaderName = "clusterLightsCompShader.glsl";
+
+	// threads in each work group of the assignment shader,
+	// GROUP_SIZE in the shader
+	const GLuint g_AssignGroupSize = 64;
+	// pixels along each side of a screen tile, and depth slices
+	// between the near and the far plane
+	const GLint g_TilePixels = 64;
+	const GLuint g_DepthSlices = 24;
+	// light indices the index buffer has room for, on average,
+	// in each cluster
+	const GLuint g_AverageClusterLights = 32;
+
+	// storage buffer bindings read by the assignment and the
+	// main fragment shader, after the ones of the GPU culling
+	enum ClusterBinding
+	{
+		binding_local_lights = 8,
+		binding_cluster_grid,
+		binding_cluster_bounds,
+		binding_light_indices
+	};
+}
+
+/***********************************************************
+ *  LightClusters()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+LightClusters::LightClusters(UniformBufferManager* pUniformBuffers)
+{
+	m_pUniformBuffers = pUniformBuffers;
+	m_assignShader.m_programID = 0;
+	m_bLoaded = false;
+	m_bLightsDirty = true;
+
+	m_lightBuffer = 0;
+	m_lightCapacity = 0;
+	m_gridBuffer = 0;
+	m_boundsBuffer = 0;
+	m_indexBuffer = 0;
+
+	memset(&m_grid, 0, sizeof(m_grid));
+	m_nClusters = 0;
+	m_projection = glm::mat4(0.0f);
+	m_view = glm::mat4(0.0f);
+	for (int i = 0; i < 4; i++)
+	{
+		m_viewport[i] = 0;
+	}
+
+	m_assignedPasses = 0;
+	m_reusedPasses = 0;
+}
+
+/***********************************************************
+ *  ~LightClusters()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+LightClusters::~LightClusters()
+{
+	DestroyClusters();
+
+	if (m_assignShader.m_programID != 0)
+	{
+		glDeleteProgram(m_assignShader.m_programID);
+		m_assignShader.m_programID = 0;
+	}
+	m_pUniformBuffers = NULL;
+}
+
+/***********************************************************
+ *  IsSupported()
+ *
+ *  This method is used to check for GL 4.3, which has the
+ *  compute shaders and storage buffers the clusters need.
+ ***********************************************************/
+bool LightClusters::IsSupported()
+{
+	return(GLEW_VERSION_4_3 == GL_TRUE);
+}
+
+/***********************************************************
+ *  LoadShaders()
+ *
+ *  This method is used to load the compute shader that
+ *  assigns the lights, which reads the view matrix from
+ *  the camera block.
+ ***********************************************************/
+bool LightClusters::LoadShaders(const char* shaderDirectory)
+{
+	if (IsSupported() == false)
+	{
+		return(false);
+	}
+
+	std::string directory(shaderDirectory);
+	m_bLoaded = (m_assignShader.LoadComputeShader((directory + g_AssignShaderName).c_str()) != 0);
+	if (m_bLoaded == true)
+	{
+		m_pUniformBuffers->BindUniformBlocks(&m_assignShader);
+	}
+
+	return(m_bLoaded);
+}
+
+/***********************************************************
+ *  CreateClusters()
+ *
+ *  This method is used to create the storage buffers.  The
+ *  buffers that depend on the number of clusters are sized
+ *  when the clusters are first built.
+ ***********************************************************/
+void LightClusters::CreateClusters()
+{
+	DestroyClusters();
+
+	glGenBuffers(1, &m_lightBuffer);
+	glGenBuffers(1, &m_gridBuffer);
+	glGenBuffers(1, &m_boundsBuffer);
+	glGenBuffers(1, &m_indexBuffer);
+
+	// the buffers are never bound empty, so the shaders always
+	// read a valid range
+	m_lightCapacity = sizeof(LOCAL_LIGHT);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, m_lightBuffer);
+	glBufferData(GL_COPY_WRITE_BUFFER, m_lightCapacity, NULL, GL_DYNAMIC_DRAW);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+	m_bLightsDirty = true;
+	m_nClusters = 0;
+	m_projection = glm::mat4(0.0f);
+}
+
+/***********************************************************
+ *  DestroyClusters()
+ *
+ *  This method is used to free the storage buffers.  The
+ *  lights are kept.
+ ***********************************************************/
+void LightClusters::DestroyClusters()
+{
+	GLuint buffers[] = { m_lightBuffer, m_gridBuffer, m_boundsBuffer, m_indexBuffer };
+	for (int i = 0; i < 4; i++)
+	{
+		if (buffers[i] != 0)
+		{
+			glDeleteBuffers(1, &buffers[i]);
+		}
+	}
+
+	m_lightBuffer = 0;
+	m_lightCapacity = 0;
+	m_gridBuffer = 0;
+	m_boundsBuffer = 0;
+	m_indexBuffer = 0;
+	m_nClusters = 0;
+}
+
+/***********************************************************
+ *  AddLight()
+ *
+ *  This method is used to add a local light to the scene.
+ ***********************************************************/
+int LightClusters::AddLight(const LOCAL_LIGHT& light)
+{
+	m_lights.push_back(light);
+	m_bLightsDirty = true;
+	return((int)m_lights.size() - 1);
+}
+
+/***********************************************************
+ *  SetLight()
+ *
+ *  This method is used to change a local light.
+ ***********************************************************/
+void LightClusters::SetLight(
+	int index,
+	const LOCAL_LIGHT& light)
+{
+	if ((index < 0) || (index >= (int)m_lights.size()))
+	{
+		return;
+	}
+
+	m_lights[index] = light;
+	m_bLightsDirty = true;
+}
+
+/***********************************************************
+ *  ClearLights()
+ *
+ *  This method is used to remove all of the local lights.
+ ***********************************************************/
+void LightClusters::ClearLights()
+{
+	m_lights.clear();
+	m_bLightsDirty = true;
+}
+
+/***********************************************************
+ *  UpdateClusters()
+ *
+ *  This method is used to keep the clusters in step with
+ *  the camera block.  The lights are assigned again only
+ *  when the view, the clusters or a light changed, and the
+ *  lists of the last assignment are kept otherwise.
+ ***********************************************************/
+void LightClusters::UpdateClusters()
+{
+	if (m_gridBuffer == 0)
+	{
+		return;
+	}
+
+	const UniformBufferManager::CAMERA_BLOCK& camera = m_pUniformBuffers->GetCameraData();
+	GLint viewport[4];
+	glGetIntegerv(GL_VIEWPORT, viewport);
+
+	bool bAssign = m_bLightsDirty;
+	if ((camera.projection != m_projection) || (memcmp(viewport, m_viewport, sizeof(viewport)) != 0))
+	{
+		m_projection = camera.projection;
+		memcpy(m_viewport, viewport, sizeof(viewport));
+		BuildClusterBounds();
+		bAssign = true;
+	}
+	if (camera.view != m_view)
+	{
+		m_view = camera.view;
+		bAssign = true;
+	}
+	if (m_bLightsDirty == true)
+	{
+		UploadLights();
+		m_bLightsDirty = false;
+	}
+
+	BindBuffers();
+
+	if (bAssign == false)
+	{
+		m_reusedPasses++;
+		return;
+	}
+
+	// without the compute shader there are no lights to loop
+	// over, so the fragment shader skips the clusters
+	m_grid.gridSize[3] = (m_bLoaded == true) ? (GLuint)m_lights.size() : 0;
+	m_grid.indexCount = 0;
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_gridBuffer);
+	glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(CLUSTER_GRID), &m_grid);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+	if ((m_grid.gridSize[3] == 0) || (m_nClusters == 0))
+	{
+		return;
+	}
+
+	m_assignShader.use();
+	glDispatchCompute((m_nClusters + g_AssignGroupSize - 1) / g_AssignGroupSize, 1, 1);
+	// the lists are read by the fragment shader of the main pass
+	glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+	m_assignedPasses++;
+}
+
+/***********************************************************
+ *  BuildClusterBounds()
+ *
+ *  This method is used to build the view space box of every
+ *  cluster.  The corners of each screen tile are taken back
+ *  through the projection to the near and the far plane,
+ *  and a slice is cut from the lines between them at its
+ *  two depths, which works for both kinds of projection.
+ *  The slices grow with the depth, so that the clusters
+ *  stay close to cubes in view space.
+ ***********************************************************/
+void LightClusters::BuildClusterBounds()
+{
+	GLint width = glm::max(m_viewport[2], 1);
+	GLint height = glm::max(m_viewport[3], 1);
+
+	m_grid.gridSize[0] = (GLuint)((width + g_TilePixels - 1) / g_TilePixels);
+	m_grid.gridSize[1] = (GLuint)((height + g_TilePixels - 1) / g_TilePixels);
+	m_grid.gridSize[2] = g_DepthSlices;
+	int nClusters = (int)(m_grid.gridSize[0] * m_grid.gridSize[1] * m_grid.gridSize[2]);
+
+	glm::mat4 inverseProjection = glm::inverse(m_projection);
+	glm::vec4 nearCenter = inverseProjection * glm::vec4(0.0f, 0.0f, -1.0f, 1.0f);
+	glm::vec4 farCenter = inverseProjection * glm::vec4(0.0f, 0.0f, 1.0f, 1.0f);
+	float nearDepth = glm::max(-nearCenter.z / nearCenter.w, 0.001f);
+	float farDepth = glm::max(-farCenter.z / farCenter.w, nearDepth * 2.0f);
+
+	// slice = log(depth) * scale + bias
+	float logRange = logf(farDepth / nearDepth);
+	m_grid.gridScale = glm::vec4(
+		(float)g_TilePixels,
+		(float)g_TilePixels,
+		(float)g_DepthSlices / logRange,
+		-(float)g_DepthSlices * logf(nearDepth) / logRange);
+
+	// the lines through the corners of the tiles, from the
+	// near to the far plane
+	GLuint cornersX = m_grid.gridSize[0] + 1;
+	GLuint cornersY = m_grid.gridSize[1] + 1;
+	std::vector<glm::vec3> nearCorners(cornersX * cornersY);
+	std::vector<glm::vec3> farCorners(cornersX * cornersY);
+	for (GLuint y = 0; y < cornersY; y++)
+	{
+		float ndcY = (float)glm::min((GLint)y * g_TilePixels, height) / (float)height * 2.0f - 1.0f;
+		for (GLuint x = 0; x < cornersX; x++)
+		{
+			float ndcX = (float)glm::min((GLint)x * g_TilePixels, width) / (float)width * 2.0f - 1.0f;
+			glm::vec4 nearPoint = inverseProjection * glm::vec4(ndcX, ndcY, -1.0f, 1.0f);
+			glm::vec4 farPoint = inverseProjection * glm::vec4(ndcX, ndcY, 1.0f, 1.0f);
+			nearCorners[y * cornersX + x] = glm::vec3(nearPoint) / nearPoint.w;
+			farCorners[y * cornersX + x] = glm::vec3(farPoint) / farPoint.w;
+		}
+	}
+
+	// min and max corner of each cluster, x first, then y, then z
+	std::vector<glm::vec4> bounds(nClusters * 2);
+	for (GLuint z = 0; z < m_grid.gridSize[2]; z++)
+	{
+		float sliceDepths[2] =
+		{
+			nearDepth * powf(farDepth / nearDepth, (float)z / (float)g_DepthSlices),
+			nearDepth * powf(farDepth / nearDepth, (float)(z + 1) / (float)g_DepthSlices)
+		};
+
+		for (GLuint y = 0; y < m_grid.gridSize[1]; y++)
+		{
+			for (GLuint x = 0; x < m_grid.gridSize[0]; x++)
+			{
+				glm::vec3 boxMin(1.0e30f);
+				glm::vec3 boxMax(-1.0e30f);
+				for (int corner = 0; corner < 4; corner++)
+				{
+					GLuint index = (y + corner / 2) * cornersX + (x + corner % 2);
+					const glm::vec3& nearPoint = nearCorners[index];
+					const glm::vec3& farPoint = farCorners[index];
+					for (int slice = 0; slice < 2; slice++)
+					{
+						float t = (sliceDepths[slice] + nearPoint.z) / (nearPoint.z - farPoint.z);
+						glm::vec3 point = nearPoint + (farPoint - nearPoint) * t;
+						boxMin = glm::min(boxMin, point);
+						boxMax = glm::max(boxMax, point);
+					}
+				}
+
+				int cluster = (int)((z * m_grid.gridSize[1] + y) * m_grid.gridSize[0] + x);
+				bounds[cluster * 2] = glm::vec4(boxMin, 0.0f);
+				bounds[cluster * 2 + 1] = glm::vec4(boxMax, 0.0f);
+			}
+		}
+	}
+
+	// the buffers only change size with the number of clusters
+	if (nClusters != m_nClusters)
+	{
+		m_nClusters = nClusters;
+		m_grid.maxIndices = (GLuint)nClusters * g_AverageClusterLights;
+
+		glBindBuffer(GL_COPY_WRITE_BUFFER, m_gridBuffer);
+		glBufferData(GL_COPY_WRITE_BUFFER, sizeof(CLUSTER_GRID) + sizeof(GLuint) * 2 * nClusters, NULL, GL_DYNAMIC_DRAW);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, m_indexBuffer);
+		glBufferData(GL_COPY_WRITE_BUFFER, sizeof(GLuint) * m_grid.maxIndices, NULL, GL_DYNAMIC_DRAW);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, m_boundsBuffer);
+		glBufferData(GL_COPY_WRITE_BUFFER, sizeof(glm::vec4) * bounds.size(), bounds.data(), GL_STATIC_DRAW);
+	}
+	else
+	{
+		glBindBuffer(GL_COPY_WRITE_BUFFER, m_boundsBuffer);
+		glBufferSubData(GL_COPY_WRITE_BUFFER, 0, sizeof(glm::vec4) * bounds.size(), bounds.data());
+	}
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
+
+/***********************************************************
+ *  UploadLights()
+ *
+ *  This method is used to upload the lights, growing their
+ *  buffer when more lights were added.
+ ***********************************************************/
+void LightClusters::UploadLights()
+{
+	if (m_lights.empty() == true)
+	{
+		return;
+	}
+
+	GLsizeiptr size = sizeof(LOCAL_LIGHT) * m_lights.size();
+	glBindBuffer(GL_COPY_WRITE_BUFFER, m_lightBuffer);
+	if (size > m_lightCapacity)
+	{
+		m_lightCapacity = size;
+		glBufferData(GL_COPY_WRITE_BUFFER, size, m_lights.data(), GL_DYNAMIC_DRAW);
+	}
+	else
+	{
+		glBufferSubData(GL_COPY_WRITE_BUFFER, 0, size, m_lights.data());
+	}
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
+
+/***********************************************************
+ *  BindBuffers()
+ *
+ *  This method is used to bind the buffers of the clusters.
+ *  Their bindings come after the ones the GPU culling
+ *  binds again for every pass, so they stay bound for the
+ *  draws of the main pass.
+ ***********************************************************/
+void LightClusters::BindBuffers()
+{
+	if (m_nClusters == 0)
+	{
+		return;
+	}
+
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, binding_local_lights, m_lightBuffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, binding_cluster_grid, m_gridBuffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, binding_cluster_bounds, m_boundsBuffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, binding_light_indices, m_indexBuffer);
+}
@@ -0,0 +1,136 @@
+///////////////////////////////////////////////////////////////////////////////
+// lightclusters.h
+// ============
+// split the view volume into clusters and assign the local lights of the
+// scene to them with a compute shader, for clustered forward shading
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+#include "UniformBufferManager.h"
+#include "ShaderManager.h"
+
+/***********************************************************
+ *  LightClusters
+ *
+ *  This class holds any number of local lights, each one
+ *  reaching a limited distance, and the storage buffers
+ *  the main fragment shader lights a fragment from.  The
+ *  view volume is split into screen tiles and depth slices
+ *  that grow with the distance, and a compute pass writes
+ *  the list of the lights that reach each cluster, so that
+ *  a fragment only loops over the lights of its cluster.
+ *
+ *  The boxes of the clusters are built again only when the
+ *  projection or the viewport changes, and the lights are
+ *  only assigned again when the view or a light changed.
+ ***********************************************************/
+class LightClusters
+{
+public:
+	// constructor
+	LightClusters(UniformBufferManager* pUniformBuffers);
+	// destructor
+	~LightClusters();
+
+	// one local light, in the std430 layout of the shaders
+	struct LOCAL_LIGHT
+	{
+		glm::vec3 position;
+		// distance the light reaches, where it falls to zero
+		float radius;
+		glm::vec3 color;
+		float specularIntensity;
+	};
+
+	// check whether the GL context has compute shaders and
+	// storage buffers
+	static bool IsSupported();
+
+	// load the compute shader that assigns the lights from a
+	// directory, which has to end with a path separator
+	bool LoadShaders(const char* shaderDirectory);
+	// create the storage buffers - without the compute shader
+	// the clusters stay empty, so the fragment shader still
+	// reads valid buffers
+	void CreateClusters();
+	// free the storage buffers
+	void DestroyClusters();
+
+	// add a light, returning its index
+	int AddLight(const LOCAL_LIGHT& light);
+	// change a light that was added
+	void SetLight(
+		int index,
+		const LOCAL_LIGHT& light);
+	// remove all of the lights
+	void ClearLights();
+	int GetLightCount() const { return((int)m_lights.size()); }
+
+	// fit the clusters to the camera block, assign the lights
+	// to them when anything changed and bind the buffers for
+	// the main pass
+	void UpdateClusters();
+
+	// number of light assignments run and reused
+	unsigned int GetAssignedPasses() const { return(m_assignedPasses); }
+	unsigned int GetReusedPasses() const { return(m_reusedPasses); }
+
+private:
+	// header of the cluster grid buffer, in the std430 layout
+	// of the shaders, followed by the offset and number of
+	// light indices of each cluster
+	struct CLUSTER_GRID
+	{
+		// clusters along x, y and z, and the number of lights
+		GLuint gridSize[4];
+		// pixels of a tile along x and y, and the scale and bias
+		// that turn the log of the view depth into a slice
+		glm::vec4 gridScale;
+		// indices written by the assignment, and the room for them
+		GLuint indexCount;
+		GLuint maxIndices;
+	};
+
+	// pointer to the shared uniform buffers
+	UniformBufferManager* m_pUniformBuffers;
+
+	ShaderManager m_assignShader;
+	bool m_bLoaded;
+
+	std::vector<LOCAL_LIGHT> m_lights;
+	bool m_bLightsDirty;
+
+	GLuint m_lightBuffer;
+	GLsizeiptr m_lightCapacity;
+	GLuint m_gridBuffer;
+	GLuint m_boundsBuffer;
+	GLuint m_indexBuffer;
+
+	CLUSTER_GRID m_grid;
+	int m_nClusters;
+	// projection, viewport and view the clusters were built
+	// and assigned with
+	glm::mat4 m_projection;
+	GLint m_viewport[4];
+	glm::mat4 m_view;
+
+	unsigned int m_assignedPasses;
+	unsigned int m_reusedPasses;
+
+	// build the view space box of every cluster for the
+	// projection and viewport
+	void BuildClusterBounds();
+	// upload the lights, growing the buffer when needed
+	void UploadLights();
+	// bind the buffers to the bindings the shaders read
+	void BindBuffers();
+};
@@ -0,0 +1,573 @@
+///////////////////////////////////////////////////////////////////////////////
+// occlusionculler.cpp
+// ============
+// rasterize a few large occluders into a small depth buffer on the CPU and
+// test bounding boxes against its hierarchical depth levels
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "OcclusionCuller.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE__)
+#define OCCLUSION_USE_SSE
+#include <xmmintrin.h>
+#endif
+
+// declaration of global variables
+namespace
+{
+	// rows of the depth buffer in each tile handed to a thread
+	const int g_TileRows = 16;
+	// most threads used for the rasterization
+	const unsigned int g_MaxThreads = 4;
+	// smallest clip space w of a vertex in front of the camera
+	const float g_MinClipW = 1.0e-5f;
+
+	// the twelve triangles of a box, as corner indices where
+	// bit 0, 1 and 2 of a corner select the +x, +y and +z side
+	const int g_BoxTriangles[36] = {
+		0, 2, 3,  0, 3, 1,		// -z
+		4, 5, 7,  4, 7, 6,		// +z
+		0, 4, 6,  0, 6, 2,		// -x
+		1, 3, 7,  1, 7, 5,		// +x
+		0, 1, 5,  0, 5, 4,		// -y
+		2, 6, 7,  2, 7, 3		// +y
+	};
+
+	// corner of a box selected by the bits of an index
+	glm::vec3 BoxCorner(
+		const glm::vec3& center,
+		const glm::vec3& extent,
+		int corner)
+	{
+		return(center + glm::vec3(
+			(corner & 1) ? extent.x : -extent.x,
+			(corner & 2) ? extent.y : -extent.y,
+			(corner & 4) ? extent.z : -extent.z));
+	}
+}
+
+/***********************************************************
+ *  OcclusionCuller()
+ *
+ *  The constructor for the class - the depth levels are
+ *  allocated once for the size of the buffer.
+ ***********************************************************/
+OcclusionCuller::OcclusionCuller(
+	int width,
+	int height)
+{
+	m_viewProjection = glm::mat4(1.0f);
+	m_generation = 0;
+	m_nBusyWorkers = 0;
+	m_bStopping = false;
+	m_nextTile = 0;
+
+	DEPTH_LEVEL level;
+	level.width = (glm::max(width, 4) + 3) & ~3;
+	level.height = glm::max(height, 1);
+	level.depths.assign(level.width * level.height, 1.0f);
+	m_levels.push_back(level);
+
+	while ((level.width > 1) || (level.height > 1))
+	{
+		level.width = (level.width + 1) / 2;
+		level.height = (level.height + 1) / 2;
+		level.depths.assign(level.width * level.height, 1.0f);
+		m_levels.push_back(level);
+	}
+}
+
+/***********************************************************
+ *  ~OcclusionCuller()
+ *
+ *  The destructor for the class - the threads are woken to
+ *  stop and are joined.
+ ***********************************************************/
+OcclusionCuller::~OcclusionCuller()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_workerMutex);
+		m_bStopping = true;
+	}
+	m_workReady.notify_all();
+
+	for (size_t i = 0; i < m_workers.size(); i++)
+	{
+		m_workers[i].join();
+	}
+}
+
+/***********************************************************
+ *  StartWorkers()
+ *
+ *  This method is used to start the threads that help with
+ *  the rasterization.  They are started once and kept, so
+ *  that the many views drawn in a frame do not each pay
+ *  for creating and joining threads.
+ ***********************************************************/
+void OcclusionCuller::StartWorkers(unsigned int nWorkers)
+{
+	for (unsigned int i = 0; i < nWorkers; i++)
+	{
+		m_workers.push_back(std::thread(&OcclusionCuller::RunWorker, this));
+	}
+}
+
+/***********************************************************
+ *  RunWorker()
+ *
+ *  This method is run by each thread.  It sleeps until a
+ *  new generation of tiles is handed out, draws tiles until
+ *  there are none left, and tells the caller it is done.
+ ***********************************************************/
+void OcclusionCuller::RunWorker()
+{
+	unsigned int generation = 0;
+
+	for (;;)
+	{
+		{
+			std::unique_lock<std::mutex> lock(m_workerMutex);
+			while ((m_bStopping == false) && (m_generation == generation))
+			{
+				m_workReady.wait(lock);
+			}
+			if (m_bStopping == true)
+			{
+				return;
+			}
+			generation = m_generation;
+		}
+
+		RasterizeTiles();
+
+		{
+			std::lock_guard<std::mutex> lock(m_workerMutex);
+			m_nBusyWorkers--;
+		}
+		m_workDone.notify_one();
+	}
+}
+
+/***********************************************************
+ *  ClearOccluders()
+ *
+ *  This method is used to remove the occluders, so that
+ *  the occluders of a new frame can be added.
+ ***********************************************************/
+void OcclusionCuller::ClearOccluders()
+{
+	m_occluderVertices.clear();
+}
+
+/***********************************************************
+ *  AddOccluderTriangle()
+ *
+ *  This method is used to add a triangle that hides what
+ *  is behind it.  The triangle is kept in world space until
+ *  the occluders are rasterized.
+ ***********************************************************/
+void OcclusionCuller::AddOccluderTriangle(
+	const glm::vec3& a,
+	const glm::vec3& b,
+	const glm::vec3& c)
+{
+	m_occluderVertices.push_back(a);
+	m_occluderVertices.push_back(b);
+	m_occluderVertices.push_back(c);
+}
+
+/***********************************************************
+ *  AddOccluderBox()
+ *
+ *  This method is used to add the twelve triangles of a
+ *  solid box.  A flat box, such as the box of a plane,
+ *  only adds the two faces that are not degenerate.
+ ***********************************************************/
+void OcclusionCuller::AddOccluderBox(
+	const glm::mat4& model,
+	const glm::vec3& center,
+	const glm::vec3& extent)
+{
+	glm::vec3 corners[8];
+	for (int corner = 0; corner < 8; corner++)
+	{
+		corners[corner] = glm::vec3(model * glm::vec4(BoxCorner(center, extent, corner), 1.0f));
+	}
+
+	for (int i = 0; i < 36; i += 3)
+	{
+		AddOccluderTriangle(
+			corners[g_BoxTriangles[i]],
+			corners[g_BoxTriangles[i + 1]],
+			corners[g_BoxTriangles[i + 2]]);
+	}
+}
+
+/***********************************************************
+ *  RasterizeOccluders()
+ *
+ *  This method is used to draw the occluders into the depth
+ *  buffer.  The threads take tiles of rows until all of
+ *  the tiles are drawn, and since the tiles do not overlap
+ *  no two threads write the same pixel.
+ ***********************************************************/
+void OcclusionCuller::RasterizeOccluders(const glm::mat4& viewProjection)
+{
+	m_viewProjection = viewProjection;
+
+	DEPTH_LEVEL& buffer = m_levels[0];
+	std::fill(buffer.depths.begin(), buffer.depths.end(), 1.0f);
+
+	SetupTriangles();
+
+	if (m_triangles.empty() == false)
+	{
+		// the calling thread draws tiles too, so one thread
+		// fewer is started
+		if (m_workers.empty() == true)
+		{
+			int nTiles = (buffer.height + g_TileRows - 1) / g_TileRows;
+			unsigned int nThreads = std::thread::hardware_concurrency();
+			nThreads = glm::clamp(nThreads, 1u, glm::min(g_MaxThreads, (unsigned int)nTiles));
+			StartWorkers(nThreads - 1);
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(m_workerMutex);
+			m_nextTile = 0;
+			m_nBusyWorkers = (unsigned int)m_workers.size();
+			m_generation++;
+		}
+		m_workReady.notify_all();
+
+		RasterizeTiles();
+
+		std::unique_lock<std::mutex> lock(m_workerMutex);
+		while (m_nBusyWorkers > 0)
+		{
+			m_workDone.wait(lock);
+		}
+		lock.unlock();
+	}
+
+	BuildDepthLevels();
+}
+
+/***********************************************************
+ *  IsBoxVisible()
+ *
+ *  This method is used to test a box against the depth
+ *  levels.  The level is picked so that the box covers at
+ *  most 2x2 texels, and the box is hidden when its nearest
+ *  depth is behind the farthest depth of all of them.
+ *  Boxes that reach behind the camera are always visible.
+ ***********************************************************/
+bool OcclusionCuller::IsBoxVisible(
+	const glm::vec3& center,
+	const glm::vec3& extent) const
+{
+	if (m_triangles.empty())
+	{
+		return(true);
+	}
+
+	const DEPTH_LEVEL& buffer = m_levels[0];
+	glm::vec2 minimum(1.0e30f);
+	glm::vec2 maximum(-1.0e30f);
+	float nearest = 1.0f;
+
+	for (int corner = 0; corner < 8; corner++)
+	{
+		glm::vec4 clip = m_viewProjection * glm::vec4(BoxCorner(center, extent, corner), 1.0f);
+		if ((clip.w < g_MinClipW) || (clip.z < -clip.w))
+		{
+			return(true);
+		}
+
+		glm::vec3 ndc = glm::vec3(clip) / clip.w;
+		glm::vec2 pixel = (glm::vec2(ndc) * 0.5f + 0.5f) * glm::vec2(buffer.width, buffer.height);
+		minimum = glm::min(minimum, pixel);
+		maximum = glm::max(maximum, pixel);
+		nearest = glm::min(nearest, ndc.z * 0.5f + 0.5f);
+	}
+
+	// only the part of the box on the screen can be seen
+	int x0 = glm::max((int)floor(minimum.x), 0);
+	int y0 = glm::max((int)floor(minimum.y), 0);
+	int x1 = glm::min((int)floor(maximum.x), buffer.width - 1);
+	int y1 = glm::min((int)floor(maximum.y), buffer.height - 1);
+	if ((x0 > x1) || (y0 > y1))
+	{
+		return(true);
+	}
+
+	int level = 0;
+	while ((level + 1 < (int)m_levels.size()) &&
+		(((x1 >> level) - (x0 >> level) > 1) || ((y1 >> level) - (y0 >> level) > 1)))
+	{
+		level++;
+	}
+
+	const DEPTH_LEVEL& depths = m_levels[level];
+	float farthest = 0.0f;
+	for (int y = y0 >> level; y <= (y1 >> level); y++)
+	{
+		for (int x = x0 >> level; x <= (x1 >> level); x++)
+		{
+			farthest = glm::max(farthest, depths.depths[y * depths.width + x]);
+		}
+	}
+
+	return(nearest <= farthest);
+}
+
+/***********************************************************
+ *  CullBoxes()
+ *
+ *  This method is used to test the boxes that passed the
+ *  earlier culling, such as the frustum test, and clear
+ *  the ones that are hidden behind the occluders.
+ ***********************************************************/
+void OcclusionCuller::CullBoxes(
+	const Frustum::BOX_ARRAYS& boxes,
+	size_t count,
+	uint8_t* visible) const
+{
+	for (size_t i = 0; i < count; i++)
+	{
+		if (visible[i] == 0)
+		{
+			continue;
+		}
+
+		glm::vec3 center(boxes.centerX[i], boxes.centerY[i], boxes.centerZ[i]);
+		glm::vec3 extent(boxes.extentX[i], boxes.extentY[i], boxes.extentZ[i]);
+		if (IsBoxVisible(center, extent) == false)
+		{
+			visible[i] = 0;
+		}
+	}
+}
+
+/***********************************************************
+ *  SetupTriangles()
+ *
+ *  This method is used to project the occluder triangles
+ *  into pixels.  Triangles that reach behind the near plane
+ *  are left out instead of being clipped, since leaving out
+ *  an occluder can only keep more boxes visible.
+ ***********************************************************/
+void OcclusionCuller::SetupTriangles()
+{
+	const DEPTH_LEVEL& buffer = m_levels[0];
+	m_triangles.clear();
+
+	for (size_t i = 0; i + 2 < m_occluderVertices.size(); i += 3)
+	{
+		SCREEN_TRIANGLE triangle;
+		bool bVisible = true;
+
+		for (int vertex = 0; vertex < 3; vertex++)
+		{
+			glm::vec4 clip = m_viewProjection * glm::vec4(m_occluderVertices[i + vertex], 1.0f);
+			if ((clip.w < g_MinClipW) || (clip.z < -clip.w))
+			{
+				bVisible = false;
+				break;
+			}
+
+			glm::vec3 ndc = glm::vec3(clip) / clip.w;
+			triangle.vertices[vertex] = glm::vec3(
+				(ndc.x * 0.5f + 0.5f) * buffer.width,
+				(ndc.y * 0.5f + 0.5f) * buffer.height,
+				ndc.z * 0.5f + 0.5f);
+		}
+		if (bVisible == false)
+		{
+			continue;
+		}
+
+		// wind every triangle the same way, so that the inside
+		// of each edge is where its edge function is positive
+		glm::vec3 a = triangle.vertices[0];
+		glm::vec3 b = triangle.vertices[1];
+		glm::vec3 c = triangle.vertices[2];
+		float area = (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+		if (area == 0.0f)
+		{
+			continue;
+		}
+		if (area < 0.0f)
+		{
+			std::swap(triangle.vertices[1], triangle.vertices[2]);
+		}
+
+		triangle.minY = glm::min(glm::min(a.y, b.y), c.y);
+		triangle.maxY = glm::max(glm::max(a.y, b.y), c.y);
+		m_triangles.push_back(triangle);
+	}
+}
+
+/***********************************************************
+ *  RasterizeTiles()
+ *
+ *  This method is used by each thread to take the next
+ *  tile of rows and draw the triangles that overlap it.
+ ***********************************************************/
+void OcclusionCuller::RasterizeTiles()
+{
+	int height = m_levels[0].height;
+
+	for (int tile = m_nextTile++; tile * g_TileRows < height; tile = m_nextTile++)
+	{
+		int rowBegin = tile * g_TileRows;
+		int rowEnd = glm::min(rowBegin + g_TileRows, height);
+
+		for (size_t i = 0; i < m_triangles.size(); i++)
+		{
+			if ((m_triangles[i].maxY >= (float)rowBegin) && (m_triangles[i].minY < (float)rowEnd))
+			{
+				RasterizeTriangle(m_triangles[i], rowBegin, rowEnd);
+			}
+		}
+	}
+}
+
+/***********************************************************
+ *  RasterizeTriangle()
+ *
+ *  This method is used to draw a triangle between two rows
+ *  of the depth buffer.  The edge functions and the depth
+ *  are planes over the screen, so they are stepped across
+ *  each row, and a pixel keeps the nearest depth when its
+ *  center is inside all three edges.
+ ***********************************************************/
+void OcclusionCuller::RasterizeTriangle(
+	const SCREEN_TRIANGLE& triangle,
+	int rowBegin,
+	int rowEnd)
+{
+	DEPTH_LEVEL& buffer = m_levels[0];
+	const glm::vec3& a = triangle.vertices[0];
+	const glm::vec3& b = triangle.vertices[1];
+	const glm::vec3& c = triangle.vertices[2];
+
+	// edge functions A * x + B * y + C, where edge k is the
+	// one across from vertex k
+	const glm::vec3* starts[3] = { &b, &c, &a };
+	const glm::vec3* ends[3] = { &c, &a, &b };
+	float edgeA[3];
+	float edgeB[3];
+	float edgeC[3];
+	for (int edge = 0; edge < 3; edge++)
+	{
+		edgeA[edge] = starts[edge]->y - ends[edge]->y;
+		edgeB[edge] = ends[edge]->x - starts[edge]->x;
+		edgeC[edge] = -(edgeA[edge] * starts[edge]->x + edgeB[edge] * starts[edge]->y);
+	}
+
+	// depth plane from the vertex depths weighted by the
+	// edge functions
+	float inverseArea = 1.0f / (edgeA[0] * a.x + edgeB[0] * a.y + edgeC[0]);
+	float depthA = (edgeA[0] * a.z + edgeA[1] * b.z + edgeA[2] * c.z) * inverseArea;
+	float depthB = (edgeB[0] * a.z + edgeB[1] * b.z + edgeB[2] * c.z) * inverseArea;
+	float depthC = (edgeC[0] * a.z + edgeC[1] * b.z + edgeC[2] * c.z) * inverseArea;
+
+	// pixels whose centers can be inside, with the first
+	// column aligned for the four pixel steps
+	int x0 = glm::max((int)floor(glm::min(glm::min(a.x, b.x), c.x)), 0) & ~3;
+	int x1 = glm::min((int)ceil(glm::max(glm::max(a.x, b.x), c.x)), buffer.width - 1);
+	int y0 = glm::max((int)floor(triangle.minY), rowBegin);
+	int y1 = glm::min((int)ceil(triangle.maxY), rowEnd - 1);
+
+	for (int y = y0; y <= y1; y++)
+	{
+		float py = (float)y + 0.5f;
+		float* row = buffer.depths.data() + y * buffer.width;
+		int x = x0;
+
+#ifdef OCCLUSION_USE_SSE
+		__m128 zero = _mm_setzero_ps();
+		__m128 step = _mm_set_ps(3.5f, 2.5f, 1.5f, 0.5f);
+		__m128 rowEdge0 = _mm_set1_ps(edgeB[0] * py + edgeC[0]);
+		__m128 rowEdge1 = _mm_set1_ps(edgeB[1] * py + edgeC[1]);
+		__m128 rowEdge2 = _mm_set1_ps(edgeB[2] * py + edgeC[2]);
+		__m128 rowDepth = _mm_set1_ps(depthB * py + depthC);
+		__m128 edgeA0 = _mm_set1_ps(edgeA[0]);
+		__m128 edgeA1 = _mm_set1_ps(edgeA[1]);
+		__m128 edgeA2 = _mm_set1_ps(edgeA[2]);
+		__m128 depthX = _mm_set1_ps(depthA);
+
+		for (; x <= x1; x += 4)
+		{
+			__m128 px = _mm_add_ps(_mm_set1_ps((float)x), step);
+			__m128 edge0 = _mm_add_ps(_mm_mul_ps(edgeA0, px), rowEdge0);
+			__m128 edge1 = _mm_add_ps(_mm_mul_ps(edgeA1, px), rowEdge1);
+			__m128 edge2 = _mm_add_ps(_mm_mul_ps(edgeA2, px), rowEdge2);
+			__m128 inside = _mm_and_ps(
+				_mm_and_ps(_mm_cmpge_ps(edge0, zero), _mm_cmpge_ps(edge1, zero)),
+				_mm_cmpge_ps(edge2, zero));
+
+			if (_mm_movemask_ps(inside) == 0)
+			{
+				continue;
+			}
+
+			__m128 depth = _mm_add_ps(_mm_mul_ps(depthX, px), rowDepth);
+			__m128 stored = _mm_loadu_ps(row + x);
+			__m128 nearest = _mm_min_ps(stored, depth);
+			_mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(inside, nearest), _mm_andnot_ps(inside, stored)));
+		}
+#endif
+
+		for (; x <= x1; x++)
+		{
+			float px = (float)x + 0.5f;
+			if ((edgeA[0] * px + edgeB[0] * py + edgeC[0] >= 0.0f) &&
+				(edgeA[1] * px + edgeB[1] * py + edgeC[1] >= 0.0f) &&
+				(edgeA[2] * px + edgeB[2] * py + edgeC[2] >= 0.0f))
+			{
+				row[x] = glm::min(row[x], depthA * px + depthB * py + depthC);
+			}
+		}
+	}
+}
+
+/***********************************************************
+ *  BuildDepthLevels()
+ *
+ *  This method is used to reduce the depth buffer into the
+ *  smaller levels.  Each texel keeps the farthest of the
+ *  2x2 texels below it, so a box behind a texel of a level
+ *  is behind every pixel that texel covers.
+ ***********************************************************/
+void OcclusionCuller::BuildDepthLevels()
+{
+	for (size_t level = 1; level < m_levels.size(); level++)
+	{
+		const DEPTH_LEVEL& source = m_levels[level - 1];
+		DEPTH_LEVEL& target = m_levels[level];
+
+		for (int y = 0; y < target.height; y++)
+		{
+			int sourceY0 = y * 2;
+			int sourceY1 = glm::min(sourceY0 + 1, source.height - 1);
+
+			for (int x = 0; x < target.width; x++)
+			{
+				int sourceX0 = x * 2;
+				int sourceX1 = glm::min(sourceX0 + 1, source.width - 1);
+
+				target.depths[y * target.width + x] = glm::max(
+					glm::max(source.depths[sourceY0 * source.width + sourceX0], source.depths[sourceY0 * source.width + sourceX1]),
+					glm::max(source.depths[sourceY1 * source.width + sourceX0], source.depths[sourceY1 * source.width + sourceX1]));
+			}
+		}
+	}
+}
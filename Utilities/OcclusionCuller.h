@@ -0,0 +1,140 @@
+///////////////////////////////////////////////////////////////////////////////
+// occlusionculler.h
+// ============
+// rasterize a few large occluders into a small depth buffer on the CPU and
+// test bounding boxes against its hierarchical depth levels
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+
+#include "Frustum.h"
+
+/***********************************************************
+ *  OcclusionCuller
+ *
+ *  This class draws the triangles of the occluders into a
+ *  low resolution depth buffer, with the rows of the buffer
+ *  split into tiles that are rasterized on several threads
+ *  and four pixels at a time with SSE.  The threads are
+ *  started with the first rasterization and wait between
+ *  views, so that each view only wakes them.  The buffer is then
+ *  reduced into levels that hold the farthest depth of each
+ *  2x2 block, and a box is hidden when it is behind every
+ *  texel it covers on the level that fits its size.  No
+ *  OpenGL calls are made, so it runs without a GPU.
+ ***********************************************************/
+class OcclusionCuller
+{
+public:
+	// constructor - the width is rounded up to a multiple of four
+	OcclusionCuller(
+		int width = 256,
+		int height = 128);
+	// destructor - stops the rasterization threads
+	~OcclusionCuller();
+
+	// remove the occluders of the last frame
+	void ClearOccluders();
+	// add a world space triangle as an occluder
+	void AddOccluderTriangle(
+		const glm::vec3& a,
+		const glm::vec3& b,
+		const glm::vec3& c);
+	// add a solid box, given by its center and half extents
+	// in model space, as an occluder
+	void AddOccluderBox(
+		const glm::mat4& model,
+		const glm::vec3& center,
+		const glm::vec3& extent);
+
+	// draw the occluders seen through a projection * view
+	// matrix and build the depth levels
+	void RasterizeOccluders(const glm::mat4& viewProjection);
+
+	// test a world space box against the occluders
+	bool IsBoxVisible(
+		const glm::vec3& center,
+		const glm::vec3& extent) const;
+	// test the boxes that are still marked as visible and
+	// write 0 for the ones that are hidden by the occluders
+	void CullBoxes(
+		const Frustum::BOX_ARRAYS& boxes,
+		size_t count,
+		uint8_t* visible) const;
+
+	// size and values of a level of the depth buffer, where
+	// level 0 is the rasterized buffer
+	int GetLevelCount() const { return((int)m_levels.size()); }
+	int GetLevelWidth(int level) const { return(m_levels[level].width); }
+	int GetLevelHeight(int level) const { return(m_levels[level].height); }
+	const float* GetLevelDepths(int level) const { return(m_levels[level].depths.data()); }
+
+private:
+	// occluder triangle after the projection, in pixels with
+	// the depth between 0 at the near and 1 at the far plane
+	struct SCREEN_TRIANGLE
+	{
+		glm::vec3 vertices[3];
+		float minY;
+		float maxY;
+	};
+
+	// one level of the hierarchical depth buffer
+	struct DEPTH_LEVEL
+	{
+		int width;
+		int height;
+		std::vector<float> depths;
+	};
+
+	std::vector<glm::vec3> m_occluderVertices;
+	std::vector<SCREEN_TRIANGLE> m_triangles;
+	std::vector<DEPTH_LEVEL> m_levels;
+	glm::mat4 m_viewProjection;
+
+	// threads that help with the rasterization, which wait
+	// for the generation to change and count themselves off
+	// once there are no tiles left
+	std::vector<std::thread> m_workers;
+	std::mutex m_workerMutex;
+	std::condition_variable m_workReady;
+	std::condition_variable m_workDone;
+	unsigned int m_generation;
+	unsigned int m_nBusyWorkers;
+	bool m_bStopping;
+	// next tile of rows to be drawn
+	std::atomic<int> m_nextTile;
+
+	// the culler owns its threads, so it is not copied
+	OcclusionCuller(const OcclusionCuller&);
+	OcclusionCuller& operator=(const OcclusionCuller&);
+
+	// start the threads that help with the rasterization
+	void StartWorkers(unsigned int nWorkers);
+	// wait for the tiles of each rasterization and draw them
+	void RunWorker();
+	// project the occluder triangles into pixels
+	void SetupTriangles();
+	// draw the triangles that overlap the tiles handed out
+	// through the next tile, until there are no tiles left
+	void RasterizeTiles();
+	// draw the part of a triangle between two rows
+	void RasterizeTriangle(
+		const SCREEN_TRIANGLE& triangle,
+		int rowBegin,
+		int rowEnd);
+	// reduce each level into the next one
+	void BuildDepthLevels();
+};
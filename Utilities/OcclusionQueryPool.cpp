@@ -0,0 +1,152 @@
+///////////////////////////////////////////////////////////////////////////////
+// occlusionquerypool.cpp
+// ============
+// keep two occlusion queries for each tested object and reuse them across
+// frames, so that draws can be conditional on the result of the last frame
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "OcclusionQueryPool.h"
+
+/***********************************************************
+ *  OcclusionQueryPool()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+OcclusionQueryPool::OcclusionQueryPool()
+{
+	m_frame = 0;
+	m_target = GL_ANY_SAMPLES_PASSED;
+}
+
+/***********************************************************
+ *  ~OcclusionQueryPool()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+OcclusionQueryPool::~OcclusionQueryPool()
+{
+	Destroy();
+}
+
+/***********************************************************
+ *  Create()
+ *
+ *  This method is used to create two queries for each of
+ *  the objects.  The queries are kept until more objects
+ *  are needed, so no queries are created while drawing.
+ ***********************************************************/
+void OcclusionQueryPool::Create(int nObjects)
+{
+	if (nObjects <= GetObjectCount())
+	{
+		return;
+	}
+	Destroy();
+
+	// the conservative query may report samples for a hidden
+	// object, which only draws it, but it can be answered
+	// without counting the samples exactly
+	m_target = (GLEW_VERSION_4_3 || GLEW_ARB_ES3_compatibility) ?
+		GL_ANY_SAMPLES_PASSED_CONSERVATIVE : GL_ANY_SAMPLES_PASSED;
+
+	m_queries.resize(nObjects * 2);
+	m_issued.assign(nObjects * 2, 0);
+	glGenQueries((GLsizei)m_queries.size(), m_queries.data());
+}
+
+/***********************************************************
+ *  BeginFrame()
+ *
+ *  This method is used to swap the queries of this frame
+ *  and the last one.  The queries of the new frame are
+ *  marked as not issued until they are used again.
+ ***********************************************************/
+void OcclusionQueryPool::BeginFrame()
+{
+	m_frame ^= 1;
+
+	for (size_t i = m_frame; i < m_issued.size(); i += 2)
+	{
+		m_issued[i] = 0;
+	}
+}
+
+/***********************************************************
+ *  BeginQuery()
+ *
+ *  This method is used to start counting the samples of an
+ *  object for this frame.
+ ***********************************************************/
+void OcclusionQueryPool::BeginQuery(int object)
+{
+	if ((object < 0) || (object >= GetObjectCount()))
+	{
+		return;
+	}
+
+	int query = object * 2 + m_frame;
+	glBeginQuery(m_target, m_queries[query]);
+	m_issued[query] = 1;
+}
+
+/***********************************************************
+ *  EndQuery()
+ *
+ *  This method is used to stop counting the samples.
+ ***********************************************************/
+void OcclusionQueryPool::EndQuery()
+{
+	glEndQuery(m_target);
+}
+
+/***********************************************************
+ *  BeginConditionalRender()
+ *
+ *  This method is used to skip the following draws when the
+ *  object had no samples in the last frame.  The result is
+ *  not waited for - if the GPU has not finished the query,
+ *  the draws are done.
+ ***********************************************************/
+bool OcclusionQueryPool::BeginConditionalRender(int object)
+{
+	if ((object < 0) || (object >= GetObjectCount()))
+	{
+		return(false);
+	}
+
+	int query = object * 2 + (m_frame ^ 1);
+	if (m_issued[query] == 0)
+	{
+		return(false);
+	}
+
+	glBeginConditionalRender(m_queries[query], GL_QUERY_NO_WAIT);
+	return(true);
+}
+
+/***********************************************************
+ *  EndConditionalRender()
+ *
+ *  This method is used to end the conditional draws.
+ ***********************************************************/
+void OcclusionQueryPool::EndConditionalRender()
+{
+	glEndConditionalRender();
+}
+
+/***********************************************************
+ *  Destroy()
+ *
+ *  This method is used to delete the queries.
+ ***********************************************************/
+void OcclusionQueryPool::Destroy()
+{
+	if (m_queries.empty() == false)
+	{
+		glDeleteQueries((GLsizei)m_queries.size(), m_queries.data());
+	}
+	m_queries.clear();
+	m_issued.clear();
+}
@@ -0,0 +1,66 @@
+///////////////////////////////////////////////////////////////////////////////
+// occlusionquerypool.h
+// ============
+// keep two occlusion queries for each tested object and reuse them across
+// frames, so that draws can be conditional on the result of the last frame
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+#include <stdint.h>
+#include <vector>
+
+/***********************************************************
+ *  OcclusionQueryPool
+ *
+ *  This class holds the query objects of a fixed number of
+ *  objects.  Each object has one query for the frame being
+ *  drawn and one from the frame before, which swap roles
+ *  every frame, so the draws of an object are conditional
+ *  on a query that was issued a frame earlier and the GPU
+ *  never has to wait for a result.
+ ***********************************************************/
+class OcclusionQueryPool
+{
+public:
+	// constructor
+	OcclusionQueryPool();
+	// destructor
+	~OcclusionQueryPool();
+
+	// create the queries for a number of objects - the queries
+	// are only created again when more objects are needed
+	void Create(int nObjects);
+	// start a new frame, swapping the queries of the objects
+	void BeginFrame();
+
+	// count the samples drawn for an object this frame
+	void BeginQuery(int object);
+	void EndQuery();
+
+	// make the following draws conditional on the samples the
+	// object had in the last frame - returns false, and the
+	// draws are not conditional, when no query was issued
+	bool BeginConditionalRender(int object);
+	void EndConditionalRender();
+
+	int GetObjectCount() const { return((int)m_queries.size() / 2); }
+
+private:
+	// two queries per object, indexed by object * 2 + frame
+	std::vector<GLuint> m_queries;
+	// whether each query was issued in its frame
+	std::vector<uint8_t> m_issued;
+	// which of the two queries of an object is for this frame
+	int m_frame;
+	// kind of query, any samples passed when it can be
+	// answered conservatively
+	GLenum m_target;
+
+	// delete the queries
+	void Destroy();
+};
@@ -0,0 +1,434 @@
+///////////////////////////////////////////////////////////////////////////////
+// pointshadowmaps.cpp
+// ============
+// own the cube shadow maps of the point lights, drawn in one layered pass
+// for each light, and redraw only the faces whose casters changed
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "PointShadowMaps.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <iostream>
+
+// declaration of global variables
+namespace
+{
+	// near plane of the faces - OMNI_NEAR_PLANE in the fragment
+	// shader, which rebuilds the depth of a face from it
+	const float g_NearPlane = 0.05f;
+	// all of the faces of a cube
+	const int g_AllFaces = (1 << CUBE_FACES) - 1;
+
+	// direction and up vector of each face, in the order and
+	// orientation of the cube map faces
+	const glm::vec3 g_FaceDirections[CUBE_FACES] =
+	{
+		glm::vec3(1.0f, 0.0f, 0.0f),
+		glm::vec3(-1.0f, 0.0f, 0.0f),
+		glm::vec3(0.0f, 1.0f, 0.0f),
+		glm::vec3(0.0f, -1.0f, 0.0f),
+		glm::vec3(0.0f, 0.0f, 1.0f),
+		glm::vec3(0.0f, 0.0f, -1.0f)
+	};
+	const glm::vec3 g_FaceUps[CUBE_FACES] =
+	{
+		glm::vec3(0.0f, -1.0f, 0.0f),
+		glm::vec3(0.0f, -1.0f, 0.0f),
+		glm::vec3(0.0f, 0.0f, 1.0f),
+		glm::vec3(0.0f, 0.0f, -1.0f),
+		glm::vec3(0.0f, -1.0f, 0.0f),
+		glm::vec3(0.0f, -1.0f, 0.0f)
+	};
+
+	// number of bits set in a face mask
+	int CountFaces(int mask)
+	{
+		int count = 0;
+		for (int face = 0; face < CUBE_FACES; face++)
+		{
+			count += (mask >> face) & 1;
+		}
+		return(count);
+	}
+}
+
+/***********************************************************
+ *  PointShadowMaps()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+PointShadowMaps::PointShadowMaps(UniformBufferManager* pUniformBuffers)
+{
+	m_pUniformBuffers = pUniformBuffers;
+	m_depthMapFBO = 0;
+	m_depthMap = 0;
+	m_size = 0;
+	m_nCubes = 0;
+	m_faceMask = 0;
+	m_renderedFaces = 0;
+	m_skippedFaces = 0;
+
+	for (int i = 0; i < 4; i++)
+	{
+		m_savedViewport[i] = 0;
+	}
+
+	for (int i = 0; i < TOTAL_LIGHTS; i++)
+	{
+		m_lights[i].radius = 0.0f;
+		m_lights[i].cube = -1;
+		m_lights[i].bActive = false;
+		m_lights[i].position = glm::vec3(0.0f);
+		m_lights[i].dirtyFaces = g_AllFaces;
+		m_lights[i].emptyFaces = g_AllFaces;
+		for (int face = 0; face < CUBE_FACES; face++)
+		{
+			m_lights[i].faceMatrices[face] = glm::mat4(1.0f);
+		}
+	}
+}
+
+/***********************************************************
+ *  ~PointShadowMaps()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+PointShadowMaps::~PointShadowMaps()
+{
+	DestroyCubeMaps();
+	m_pUniformBuffers = NULL;
+}
+
+/***********************************************************
+ *  CreateCubeMaps()
+ *
+ *  This method is used to create the depth cube map array
+ *  and the layered framebuffer the cubes are drawn through.
+ *  The cubes are read with the hardware depth compare, and
+ *  seamless filtering blends the lookups across the edges
+ *  of the faces.
+ ***********************************************************/
+bool PointShadowMaps::CreateCubeMaps(
+	GLsizei size,
+	int nCubes)
+{
+	DestroyCubeMaps();
+
+	if ((GLEW_VERSION_4_0 == false) && (GLEW_ARB_texture_cube_map_array == false))
+	{
+		std::cout << "ERROR: cube map arrays are not supported, point lights cast no shadows" << std::endl;
+		return(false);
+	}
+
+	m_size = size;
+	m_nCubes = glm::clamp(nCubes, 1, TOTAL_LIGHTS);
+
+	glGenTextures(1, &m_depthMap);
+	glBindTexture(GL_TEXTURE_CUBE_MAP_ARRAY, m_depthMap);
+	glTexImage3D(GL_TEXTURE_CUBE_MAP_ARRAY, 0, GL_DEPTH_COMPONENT, m_size, m_size, m_nCubes * CUBE_FACES, 0, GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
+	glTexParameteri(GL_TEXTURE_CUBE_MAP_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_CUBE_MAP_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_CUBE_MAP_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_CUBE_MAP_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_CUBE_MAP_ARRAY, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_CUBE_MAP_ARRAY, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+	glTexParameteri(GL_TEXTURE_CUBE_MAP_ARRAY, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+	glBindTexture(GL_TEXTURE_CUBE_MAP_ARRAY, 0);
+	glEnable(GL_TEXTURE_CUBE_MAP_SEAMLESS);
+
+	// the whole array is attached, so gl_Layer picks the face
+	glGenFramebuffers(1, &m_depthMapFBO);
+	glBindFramebuffer(GL_FRAMEBUFFER, m_depthMapFBO);
+	glFramebufferTexture(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, m_depthMap, 0);
+	glDrawBuffer(GL_NONE);
+	glReadBuffer(GL_NONE);
+
+	bool bComplete = (glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+	if (bComplete == false)
+	{
+		std::cout << "ERROR: point shadow framebuffer is not complete" << std::endl;
+		DestroyCubeMaps();
+		return(false);
+	}
+
+	for (int i = 0; i < TOTAL_LIGHTS; i++)
+	{
+		m_lights[i].dirtyFaces = g_AllFaces;
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  DestroyCubeMaps()
+ *
+ *  This method is used to free the cube map array and the
+ *  framebuffer.  The lights keep their cubes, which are
+ *  drawn again when the array is created.
+ ***********************************************************/
+void PointShadowMaps::DestroyCubeMaps()
+{
+	if (m_depthMapFBO != 0)
+	{
+		glDeleteFramebuffers(1, &m_depthMapFBO);
+		m_depthMapFBO = 0;
+	}
+	if (m_depthMap != 0)
+	{
+		glDeleteTextures(1, &m_depthMap);
+		m_depthMap = 0;
+	}
+	m_size = 0;
+	m_nCubes = 0;
+}
+
+/***********************************************************
+ *  SetPointLight()
+ *
+ *  This method is used to give a light one of the free
+ *  cubes of the array, or to give its cube back.
+ ***********************************************************/
+bool PointShadowMaps::SetPointLight(
+	int light,
+	float radius)
+{
+	if ((light < 0) || (light >= TOTAL_LIGHTS))
+	{
+		return(false);
+	}
+
+	POINT_LIGHT& point = m_lights[light];
+	if (radius <= g_NearPlane)
+	{
+		point.radius = 0.0f;
+		point.cube = -1;
+		point.bActive = false;
+		return(true);
+	}
+
+	if (point.cube < 0)
+	{
+		for (int cube = 0; (cube < m_nCubes) && (point.cube < 0); cube++)
+		{
+			bool bFree = true;
+			for (int i = 0; i < TOTAL_LIGHTS; i++)
+			{
+				bFree = bFree && (m_lights[i].cube != cube);
+			}
+			if (bFree == true)
+			{
+				point.cube = cube;
+			}
+		}
+		if (point.cube < 0)
+		{
+			std::cout << "ERROR: no free shadow cube for light " << light << std::endl;
+			return(false);
+		}
+	}
+
+	if (point.radius != radius)
+	{
+		point.radius = radius;
+		point.dirtyFaces = g_AllFaces;
+		FitFaces(light);
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  UpdateLights()
+ *
+ *  This method is used to fit the faces of each cube to the
+ *  position of its light, and to pass the cube and its
+ *  reach to the light block.  A light without diffuse color
+ *  casts no shadows, so its cube is not drawn.
+ ***********************************************************/
+void PointShadowMaps::UpdateLights()
+{
+	const UniformBufferManager::LIGHT_BLOCK& lights = m_pUniformBuffers->GetLightData();
+
+	for (int light = 0; light < TOTAL_LIGHTS; light++)
+	{
+		POINT_LIGHT& point = m_lights[light];
+		const UniformBufferManager::LIGHT_SOURCE& source = lights.lightSources[light];
+
+		bool bWasActive = point.bActive;
+		point.bActive = (point.cube >= 0) && (m_depthMap != 0) &&
+			(glm::max(source.diffuseColor.r, glm::max(source.diffuseColor.g, source.diffuseColor.b)) > 0.0f);
+		if (point.bActive == false)
+		{
+			m_pUniformBuffers->SetLightShadowCube(light, 0.0f, 0.0f);
+			continue;
+		}
+
+		// the casters are not followed while the light is dark,
+		// so its cube is drawn again when it lights up
+		if (bWasActive == false)
+		{
+			point.dirtyFaces = g_AllFaces;
+		}
+
+		if (point.position != source.position)
+		{
+			point.position = source.position;
+			point.dirtyFaces = g_AllFaces;
+			FitFaces(light);
+		}
+
+		m_pUniformBuffers->SetLightShadowCube(light, (float)point.cube, point.radius);
+	}
+}
+
+/***********************************************************
+ *  GetBoundsMatrix()
+ *
+ *  This method is used to get an orthographic matrix of the
+ *  box around the sphere a cube reaches, so that the draws
+ *  of its pass can be culled the way the other shadow
+ *  passes are.
+ ***********************************************************/
+glm::mat4 PointShadowMaps::GetBoundsMatrix(int light) const
+{
+	const POINT_LIGHT& point = m_lights[light];
+	glm::mat4 projection = glm::ortho(
+		-point.radius, point.radius,
+		-point.radius, point.radius,
+		-point.radius, point.radius);
+	return(projection * glm::translate(glm::mat4(1.0f), -point.position));
+}
+
+/***********************************************************
+ *  UpdateCasters()
+ *
+ *  This method is used to compare the casters inside a face
+ *  of a light with the casters it was drawn with.
+ ***********************************************************/
+bool PointShadowMaps::UpdateCasters(
+	int light,
+	int face,
+	const ShadowManager::SHADOW_CASTER* casters,
+	size_t count)
+{
+	if ((light < 0) || (light >= TOTAL_LIGHTS) || (face < 0) || (face >= CUBE_FACES) ||
+		(m_lights[light].bActive == false))
+	{
+		return(false);
+	}
+
+	POINT_LIGHT& point = m_lights[light];
+	std::vector<ShadowManager::SHADOW_CASTER>& cached = point.casters[face];
+	bool bChanged = ShadowManager::CastersChanged(cached, casters, count);
+
+	if (bChanged == true)
+	{
+		cached.assign(casters, casters + count);
+		point.dirtyFaces |= (1 << face);
+		if (count == 0)
+		{
+			point.emptyFaces |= (1 << face);
+		}
+		else
+		{
+			point.emptyFaces &= ~(1 << face);
+		}
+	}
+
+	return(bChanged);
+}
+
+/***********************************************************
+ *  BeginLightPass()
+ *
+ *  This method is used to bind the framebuffer of the cube
+ *  of a light and clear the faces that no longer match the
+ *  scene.  The faces that have casters are drawn in this
+ *  pass, and an empty face stays cleared to the far plane.
+ ***********************************************************/
+bool PointShadowMaps::BeginLightPass(int light)
+{
+	m_faceMask = 0;
+	if ((light < 0) || (light >= TOTAL_LIGHTS) || (m_depthMapFBO == 0))
+	{
+		return(false);
+	}
+
+	POINT_LIGHT& point = m_lights[light];
+	if (point.bActive == false)
+	{
+		return(false);
+	}
+
+	int dirtyFaces = point.dirtyFaces;
+	m_faceMask = dirtyFaces & ~point.emptyFaces;
+	m_renderedFaces += CountFaces(m_faceMask);
+	m_skippedFaces += CUBE_FACES - CountFaces(m_faceMask);
+	if (dirtyFaces == 0)
+	{
+		return(false);
+	}
+	point.dirtyFaces = 0;
+
+	glGetIntegerv(GL_VIEWPORT, m_savedViewport);
+	glBindFramebuffer(GL_FRAMEBUFFER, m_depthMapFBO);
+	glViewport(0, 0, m_size, m_size);
+
+	// clear only the faces that change, one layer at a time,
+	// then attach the whole array again for the layered pass
+	for (int face = 0; face < CUBE_FACES; face++)
+	{
+		if ((dirtyFaces & (1 << face)) != 0)
+		{
+			glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, m_depthMap, 0, GetCubeLayer(light) + face);
+			glClear(GL_DEPTH_BUFFER_BIT);
+		}
+	}
+	glFramebufferTexture(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, m_depthMap, 0);
+
+	if (m_faceMask == 0)
+	{
+		EndLightPass();
+		return(false);
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  EndLightPass()
+ *
+ *  This method is used to go back to the default
+ *  framebuffer once the cube of a light has been drawn.
+ ***********************************************************/
+void PointShadowMaps::EndLightPass()
+{
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	glViewport(m_savedViewport[0], m_savedViewport[1], m_savedViewport[2], m_savedViewport[3]);
+}
+
+/***********************************************************
+ *  FitFaces()
+ *
+ *  This method is used to build the matrices of the faces
+ *  of a light, each looking down one axis with a quarter
+ *  turn field of view, out to the reach of the light.
+ ***********************************************************/
+void PointShadowMaps::FitFaces(int light)
+{
+	POINT_LIGHT& point = m_lights[light];
+	glm::mat4 projection = glm::perspective(glm::radians(90.0f), 1.0f, g_NearPlane, point.radius);
+
+	for (int face = 0; face < CUBE_FACES; face++)
+	{
+		point.faceMatrices[face] = projection * glm::lookAt(
+			point.position,
+			point.position + g_FaceDirections[face],
+			g_FaceUps[face]);
+	}
+}
@@ -0,0 +1,137 @@
+///////////////////////////////////////////////////////////////////////////////
+// pointshadowmaps.h
+// ============
+// own the cube shadow maps of the point lights, drawn in one layered pass
+// for each light, and redraw only the faces whose casters changed
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+#include "UniformBufferManager.h"
+#include "ShadowManager.h"
+
+// number of faces of a cube map - CUBE_FACES in the depth
+// geometry shader
+#define CUBE_FACES 6
+
+/***********************************************************
+ *  PointShadowMaps
+ *
+ *  This class holds a cube map array with one depth cube
+ *  for each point light that casts shadows all around it,
+ *  and the layered framebuffer the cubes are drawn through.
+ *  The geometry shader sends every triangle to the faces
+ *  it touches, so the six faces of a light are drawn in
+ *  one pass instead of six.
+ *
+ *  Every frame the scene passes in the casters inside each
+ *  face, and a face is only drawn again when the light has
+ *  moved or its casters changed.  A face without casters
+ *  is cleared and left out of the pass.
+ ***********************************************************/
+class PointShadowMaps
+{
+public:
+	// constructor
+	PointShadowMaps(UniformBufferManager* pUniformBuffers);
+	// destructor
+	~PointShadowMaps();
+
+	// create a cube map array of nCubes cubes with faces of
+	// size x size, and the framebuffer they are drawn through
+	bool CreateCubeMaps(
+		GLsizei size,
+		int nCubes);
+	// free the cube map array and framebuffer
+	void DestroyCubeMaps();
+
+	// give a light a cube that reaches radius around it - a
+	// radius of 0 gives the cube of the light back
+	bool SetPointLight(
+		int light,
+		float radius);
+
+	// fit the faces to the light block and pass the cubes to it
+	void UpdateLights();
+
+	// whether a light casts its shadows into a cube
+	bool HasCube(int light) const { return(m_lights[light].bActive); }
+	// view projection matrices of the faces of a light
+	const glm::mat4* GetFaceMatrices(int light) const { return(m_lights[light].faceMatrices); }
+	// box around everything the cube of a light reaches, for
+	// culling the draws of its pass
+	glm::mat4 GetBoundsMatrix(int light) const;
+
+	// compare the casters inside a face of a light with the
+	// ones it was drawn with - returns whether they changed
+	bool UpdateCasters(
+		int light,
+		int face,
+		const ShadowManager::SHADOW_CASTER* casters,
+		size_t count);
+
+	// bind the framebuffer and clear the faces of a light that
+	// are drawn again - returns false when none of them has
+	// casters to draw
+	bool BeginLightPass(int light);
+	// restore the framebuffer and viewport of the frame
+	void EndLightPass();
+	// bit for each face drawn in the current pass
+	int GetFaceMask() const { return(m_faceMask); }
+	// first layer of the cube of a light
+	int GetCubeLayer(int light) const { return(m_lights[light].cube * CUBE_FACES); }
+
+	GLuint GetDepthMap() const { return(m_depthMap); }
+	// number of faces drawn and reused
+	unsigned int GetRenderedFaces() const { return(m_renderedFaces); }
+	unsigned int GetSkippedFaces() const { return(m_skippedFaces); }
+
+private:
+	// cube of one light source
+	struct POINT_LIGHT
+	{
+		// distance the shadows reach, and the cube in the array,
+		// -1 without a cube
+		float radius;
+		int cube;
+		// set when the light has diffuse color to cast shadows
+		bool bActive;
+		// position the faces were fitted to, and their matrices
+		glm::vec3 position;
+		glm::mat4 faceMatrices[CUBE_FACES];
+		// casters each face was drawn with
+		std::vector<ShadowManager::SHADOW_CASTER> casters[CUBE_FACES];
+		// bit for each face that no longer matches the scene, and
+		// for each face without casters
+		int dirtyFaces;
+		int emptyFaces;
+	};
+
+	// pointer to the shared uniform buffers
+	UniformBufferManager* m_pUniformBuffers;
+
+	GLuint m_depthMapFBO;
+	GLuint m_depthMap;
+	GLsizei m_size;
+	int m_nCubes;
+	// viewport of the frame while a cube is drawn
+	GLint m_savedViewport[4];
+
+	POINT_LIGHT m_lights[TOTAL_LIGHTS];
+	// faces drawn in the current pass
+	int m_faceMask;
+
+	unsigned int m_renderedFaces;
+	unsigned int m_skippedFaces;
+
+	// fit the face matrices of a light to its position
+	void FitFaces(int light);
+};
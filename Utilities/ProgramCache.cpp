@@ -0,0 +1,254 @@
+///////////////////////////////////////////////////////////////////////////////
+// programcache.cpp
+// ============
+// keep the binaries of linked shader programs on disk, so that a program
+// built from the same sources by the same driver is not compiled again
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "ProgramCache.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+#include <fstream>
+#include <iostream>
+
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+// declaration of global variables
+namespace
+{
+	// marks a cache file, and its layout - a file of another
+	// version is compiled again and replaced
+	const uint32_t g_BinaryMagic = 0x4E494250;  // "PBIN"
+	const uint32_t g_BinaryVersion = 1;
+	const char* g_BinaryExtension = ".bin";
+
+	// 64-bit FNV-1a, continued from a previous hash
+	uint64_t HashBytes(const void* data, size_t size, uint64_t hash)
+	{
+		const unsigned char* bytes = (const unsigned char*)data;
+		for (size_t i = 0; i < size; i++)
+		{
+			hash = (hash ^ bytes[i]) * 1099511628211ull;
+		}
+		return(hash);
+	}
+
+	uint64_t HashString(const char* text, uint64_t hash)
+	{
+		if (NULL == text)
+		{
+			text = "";
+		}
+		// the terminator keeps "ab" + "c" apart from "a" + "bc"
+		return(HashBytes(text, strlen(text) + 1, hash));
+	}
+}
+
+/***********************************************************
+ *  ProgramCache()
+ *
+ *  The constructor for the class.  The driver strings and
+ *  binary formats are hashed once, and the cache directory
+ *  is created when it does not exist yet.
+ ***********************************************************/
+ProgramCache::ProgramCache(const char* directory)
+{
+	m_directory = directory;
+	m_driverHash = 14695981039346656037ull;
+	m_loadedPrograms = 0;
+	m_savedPrograms = 0;
+	m_rejectedPrograms = 0;
+
+	GLint formatCount = 0;
+	if ((GLEW_VERSION_4_1 == GL_TRUE) || (GLEW_ARB_get_program_binary == GL_TRUE))
+	{
+		glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+	}
+	m_bSupported = (formatCount > 0);
+	if (m_bSupported == false)
+	{
+		return;
+	}
+
+	std::vector<GLint> formats(formatCount);
+	glGetIntegerv(GL_PROGRAM_BINARY_FORMATS, formats.data());
+
+	m_driverHash = HashBytes(&g_BinaryVersion, sizeof(g_BinaryVersion), m_driverHash);
+	m_driverHash = HashString((const char*)glGetString(GL_VENDOR), m_driverHash);
+	m_driverHash = HashString((const char*)glGetString(GL_RENDERER), m_driverHash);
+	m_driverHash = HashString((const char*)glGetString(GL_VERSION), m_driverHash);
+	m_driverHash = HashBytes(formats.data(), formats.size() * sizeof(GLint), m_driverHash);
+
+	// the directory may already exist, which is not an error
+	std::string path = m_directory;
+	if ((path.empty() == false) && ((path[path.size() - 1] == '/') || (path[path.size() - 1] == '\\')))
+	{
+		path.erase(path.size() - 1);
+	}
+#ifdef _WIN32
+	_mkdir(path.c_str());
+#else
+	mkdir(path.c_str(), 0755);
+#endif
+}
+
+/***********************************************************
+ *  MakeKey()
+ *
+ *  This method is used to hash the code of the stages of a
+ *  program on top of the hash of the driver.  The code has
+ *  the defines of the program added, so every variant of a
+ *  shader has a key of its own.
+ ***********************************************************/
+uint64_t ProgramCache::MakeKey(
+	const std::string* stageCode,
+	int stageCount) const
+{
+	uint64_t key = m_driverHash;
+	for (int i = 0; i < stageCount; i++)
+	{
+		key = HashString(stageCode[i].c_str(), key);
+	}
+
+	return(key);
+}
+
+/***********************************************************
+ *  MakePath()
+ *
+ *  This method is used to build the path of the cache file
+ *  of a key, named after the key in hexadecimal.
+ ***********************************************************/
+std::string ProgramCache::MakePath(uint64_t key) const
+{
+	char name[17];
+	snprintf(name, sizeof(name), "%08x%08x", (unsigned int)(key >> 32), (unsigned int)(key & 0xFFFFFFFFu));
+
+	return(m_directory + name + g_BinaryExtension);
+}
+
+/***********************************************************
+ *  LoadProgram()
+ *
+ *  This method is used to create a program from the binary
+ *  stored for a key.  A file that does not match the key,
+ *  or a binary that the driver does not link, is deleted so
+ *  that the program is compiled and stored again.
+ ***********************************************************/
+GLuint ProgramCache::LoadProgram(uint64_t key)
+{
+	if (m_bSupported == false)
+	{
+		return(0);
+	}
+
+	std::string path = MakePath(key);
+	std::ifstream file(path.c_str(), std::ios::in | std::ios::binary);
+	if (file.is_open() == false)
+	{
+		return(0);
+	}
+
+	BINARY_HEADER header = {};
+	file.read((char*)&header, sizeof(header));
+	bool bValid = (file.good() == true) &&
+		(header.magic == g_BinaryMagic) &&
+		(header.version == g_BinaryVersion) &&
+		(header.key == key) &&
+		(header.length > 0);
+
+	std::vector<char> binary;
+	if (bValid == true)
+	{
+		binary.resize(header.length);
+		file.read(binary.data(), header.length);
+		bValid = (file.gcount() == (std::streamsize)header.length);
+	}
+	file.close();
+
+	GLuint programID = 0;
+	if (bValid == true)
+	{
+		programID = glCreateProgram();
+		glProgramBinary(programID, (GLenum)header.format, binary.data(), (GLsizei)header.length);
+
+		GLint linked = GL_FALSE;
+		glGetProgramiv(programID, GL_LINK_STATUS, &linked);
+		if (linked != GL_TRUE)
+		{
+			glDeleteProgram(programID);
+			programID = 0;
+		}
+	}
+
+	if (programID == 0)
+	{
+		std::cout << "INFO: the cached program " << path << " was rejected, compiling it again" << std::endl;
+		remove(path.c_str());
+		m_rejectedPrograms++;
+		return(0);
+	}
+
+	m_loadedPrograms++;
+	return(programID);
+}
+
+/***********************************************************
+ *  SaveProgram()
+ *
+ *  This method is used to write the binary of a program
+ *  that was linked from source into the file of its key.
+ ***********************************************************/
+void ProgramCache::SaveProgram(
+	uint64_t key,
+	GLuint programID)
+{
+	if (m_bSupported == false)
+	{
+		return;
+	}
+
+	GLint length = 0;
+	glGetProgramiv(programID, GL_PROGRAM_BINARY_LENGTH, &length);
+	if (length <= 0)
+	{
+		return;
+	}
+
+	std::vector<char> binary(length);
+	GLsizei written = 0;
+	GLenum format = GL_NONE;
+	glGetProgramBinary(programID, length, &written, &format, binary.data());
+	if (written <= 0)
+	{
+		return;
+	}
+
+	BINARY_HEADER header = {};
+	header.magic = g_BinaryMagic;
+	header.version = g_BinaryVersion;
+	header.key = key;
+	header.format = (uint32_t)format;
+	header.length = (uint32_t)written;
+
+	std::string path = MakePath(key);
+	std::ofstream file(path.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+	if (file.is_open() == false)
+	{
+		std::cout << "ERROR: could not write the cached program " << path << std::endl;
+		return;
+	}
+	file.write((const char*)&header, sizeof(header));
+	file.write(binary.data(), written);
+	file.close();
+
+	m_savedPrograms++;
+}
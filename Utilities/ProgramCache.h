@@ -0,0 +1,85 @@
+///////////////////////////////////////////////////////////////////////////////
+// programcache.h
+// ============
+// keep the binaries of linked shader programs on disk, so that a program
+// built from the same sources by the same driver is not compiled again
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+#include <string>
+#include <stdint.h>
+
+/***********************************************************
+ *  ProgramCache
+ *
+ *  This class stores the binary of every program linked
+ *  from source in a file of a cache directory, named after
+ *  a hash of the sources with their defines, the vendor,
+ *  renderer and version strings of the driver, and the
+ *  binary formats it supports.  A later launch loads the
+ *  binary instead of compiling the shaders again.
+ *
+ *  A driver may reject a binary it wrote, for example after
+ *  an update that kept the version string, so a binary that
+ *  does not link is deleted and the program is compiled
+ *  from source again.
+ ***********************************************************/
+class ProgramCache
+{
+public:
+	// constructor - needs a current GL context, and the
+	// directory has to end with a path separator
+	ProgramCache(const char* directory);
+
+	// whether the driver can save and load program binaries
+	bool IsSupported() const { return(m_bSupported); }
+
+	// build the key of a program from the code of its stages,
+	// which already has the defines added
+	uint64_t MakeKey(
+		const std::string* stageCode,
+		int stageCount) const;
+
+	// create a program from the binary stored for a key -
+	// returns 0 when there is none or the driver rejected it
+	GLuint LoadProgram(uint64_t key);
+	// store the binary of a program linked from source, which
+	// has to be linked with the retrievable hint set
+	void SaveProgram(
+		uint64_t key,
+		GLuint programID);
+
+	// number of programs loaded, compiled and rejected
+	unsigned int GetLoadedPrograms() const { return(m_loadedPrograms); }
+	unsigned int GetSavedPrograms() const { return(m_savedPrograms); }
+	unsigned int GetRejectedPrograms() const { return(m_rejectedPrograms); }
+
+private:
+	// header at the start of a cache file
+	struct BINARY_HEADER
+	{
+		uint32_t magic;
+		uint32_t version;
+		uint64_t key;
+		uint32_t format;
+		uint32_t length;
+	};
+
+	std::string m_directory;
+	bool m_bSupported;
+	// hash of the driver strings and binary formats, which
+	// every key starts from
+	uint64_t m_driverHash;
+
+	unsigned int m_loadedPrograms;
+	unsigned int m_savedPrograms;
+	unsigned int m_rejectedPrograms;
+
+	// path of the cache file of a key
+	std::string MakePath(uint64_t key) const;
+};
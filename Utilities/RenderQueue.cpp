@@ -0,0 +1,171 @@
+///////////////////////////////////////////////////////////////////////////////
+// renderqueue.cpp
+// ============
+// record compact draw commands and sort them on a 64-bit state key so that
+// submitting them groups the program, texture and mesh binds
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "RenderQueue.h"
+
+#include <string.h>
+
+// declaration of global variables
+namespace
+{
+	// radix sort digit size
+	const int g_RadixBits = 8;
+	const int g_RadixBuckets = 1 << g_RadixBits;
+	const int g_RadixPasses = 64 / g_RadixBits;
+}
+
+/***********************************************************
+ *  RenderQueue()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+RenderQueue::RenderQueue()
+{
+	m_farPlane = 100.0f;
+}
+
+/***********************************************************
+ *  Clear()
+ *
+ *  This method is used to remove all recorded commands.  The
+ *  memory is kept so that recording does not reallocate
+ *  every frame.
+ ***********************************************************/
+void RenderQueue::Clear()
+{
+	m_commands.clear();
+	m_keys.clear();
+	m_order.clear();
+}
+
+/***********************************************************
+ *  MakeSortKey()
+ *
+ *  This method is used to build the 64-bit sort key of a
+ *  draw command.  Opaque draws are grouped by state first
+ *  and then sorted front to back, translucent draws are
+ *  sorted back to front first so that they blend correctly.
+ ***********************************************************/
+uint64_t RenderQueue::MakeSortKey(const DRAW_COMMAND& command, float viewDepth) const
+{
+	uint64_t key = 0;
+
+	// quantize the view depth to 16 bits
+	float depth = viewDepth / m_farPlane;
+	if (depth < 0.0f)
+	{
+		depth = 0.0f;
+	}
+	else if (depth > 1.0f)
+	{
+		depth = 1.0f;
+	}
+	uint64_t depthBits = (uint64_t)(depth * 65535.0f);
+
+	// state bits shared by both orderings - the texture slot and
+	// material are stored + 1 so that "none" sorts first
+	uint64_t textureBits = (uint64_t)((command.textureID + 1) & 0xFF);
+	uint64_t meshBits = (uint64_t)(command.meshID & 0xFF);
+	uint64_t partBits = (uint64_t)(command.meshParts & 0x0F);
+	uint64_t lodBits = (uint64_t)(command.lod & 0x03);
+	uint64_t materialBits = (uint64_t)((command.materialID + 1) & 0xFF);
+	uint64_t groupBits = (uint64_t)(command.occlusionGroup & 0x0F);
+	uint64_t variantBits = (uint64_t)(command.variant & 0x0F);
+	uint64_t stateBits = (variantBits << 34) | (groupBits << 30) | (textureBits << 22) | (materialBits << 14) | (meshBits << 6) | (partBits << 2) | lodBits;
+
+	key |= (uint64_t)(command.pass & 0x03) << 62;
+	if (command.bTranslucent != 0)
+	{
+		key |= (uint64_t)1 << 61;
+		key |= (0xFFFF - depthBits) << 45;
+		key |= stateBits << 7;
+	}
+	else
+	{
+		key |= stateBits << 23;
+		key |= depthBits << 7;
+	}
+
+	return(key);
+}
+
+/***********************************************************
+ *  AddCommand()
+ *
+ *  This method is used to record a draw command.
+ ***********************************************************/
+void RenderQueue::AddCommand(const DRAW_COMMAND& command, float viewDepth)
+{
+	DRAW_COMMAND recorded = command;
+	recorded.sortKey = MakeSortKey(command, viewDepth);
+
+	m_keys.push_back(recorded.sortKey);
+	m_order.push_back((uint32_t)m_commands.size());
+	m_commands.push_back(recorded);
+}
+
+/***********************************************************
+ *  Sort()
+ *
+ *  This method is used to sort the recorded commands with a
+ *  least significant digit radix sort on their sort keys.
+ *  The sort is stable, so draws with equal keys keep their
+ *  recording order.  Digits that are equal for every key
+ *  are skipped.
+ ***********************************************************/
+void RenderQueue::Sort()
+{
+	size_t count = m_keys.size();
+	if (count < 2)
+	{
+		return;
+	}
+
+	m_scratchKeys.resize(count);
+	m_scratchOrder.resize(count);
+
+	uint32_t histogram[g_RadixBuckets];
+
+	for (int pass = 0; pass < g_RadixPasses; pass++)
+	{
+		int shift = pass * g_RadixBits;
+
+		memset(histogram, 0, sizeof(histogram));
+		for (size_t i = 0; i < count; i++)
+		{
+			histogram[(m_keys[i] >> shift) & (g_RadixBuckets - 1)]++;
+		}
+
+		// every key has the same digit, so this pass would not
+		// change the order
+		if (histogram[(m_keys[0] >> shift) & (g_RadixBuckets - 1)] == count)
+		{
+			continue;
+		}
+
+		// turn the counts into bucket start offsets
+		uint32_t offset = 0;
+		for (int bucket = 0; bucket < g_RadixBuckets; bucket++)
+		{
+			uint32_t bucketCount = histogram[bucket];
+			histogram[bucket] = offset;
+			offset += bucketCount;
+		}
+
+		for (size_t i = 0; i < count; i++)
+		{
+			uint32_t destination = histogram[(m_keys[i] >> shift) & (g_RadixBuckets - 1)]++;
+			m_scratchKeys[destination] = m_keys[i];
+			m_scratchOrder[destination] = m_order[i];
+		}
+
+		m_keys.swap(m_scratchKeys);
+		m_order.swap(m_scratchOrder);
+	}
+}
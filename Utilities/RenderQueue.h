@@ -0,0 +1,119 @@
+///////////////////////////////////////////////////////////////////////////////
+// renderqueue.h
+// ============
+// record compact draw commands and sort them on a 64-bit state key so that
+// submitting them groups the program, texture and mesh binds
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+
+/***********************************************************
+ *  RenderQueue
+ *
+ *  This class holds the draw commands recorded for one pass
+ *  and sorts them with a radix sort on their state key.
+ *
+ *  Sort key layout, from the most significant bit:
+ *    opaque:      pass(2) | 0 | variant(4) | group(4) | texture(8) |
+ *                 material(8) | mesh(8) | parts(4) | lod(2) |
+ *                 depth(16, front to back) | 0(7)
+ *    translucent: pass(2) | 1 | depth(16, back to front) | variant(4) |
+ *                 group(4) | texture(8) | material(8) | mesh(8) |
+ *                 parts(4) | lod(2) | 0(7)
+ *
+ *  The draws of each shader variant are next to each other,
+ *  so the program only changes when the variant does.  Draws
+ *  with the same texture and material are next to each
+ *  other, so they can be submitted with one multi-draw call.
+ *  The draws of an occlusion group are kept together, so that
+ *  they can be made conditional on one query.
+ ***********************************************************/
+class RenderQueue
+{
+public:
+	// constructor
+	RenderQueue();
+
+	// the passes the commands are recorded for
+	enum RenderPass
+	{
+		pass_depth = 0,
+		pass_main = 1
+	};
+
+	// one recorded draw - everything that is not needed to
+	// sort the draw is kept in a per-draw array on the side
+	// and referenced through the transform index
+	struct DRAW_COMMAND
+	{
+		uint64_t sortKey;
+		uint32_t transformIndex;  // index of the transform and color
+		uint16_t meshID;          // mesh to draw
+		uint16_t meshParts;       // sub-range of the mesh to draw
+		int16_t materialID;       // material, -1 for none
+		int16_t textureID;        // texture slot, -1 for none
+		uint8_t pass;             // RenderPass the draw belongs to
+		uint8_t bTranslucent;     // blended draw, sorted back to front
+		uint8_t lod;              // level of detail of the mesh
+		uint8_t occlusionGroup;   // occlusion query the draw depends on, 0 for none
+		uint8_t variant;          // shader features the draw needs
+	};
+
+private:
+	// the recorded commands in recording order
+	std::vector<DRAW_COMMAND> m_commands;
+	// the sort keys and command indices, before and after sorting
+	std::vector<uint64_t> m_keys;
+	std::vector<uint64_t> m_scratchKeys;
+	std::vector<uint32_t> m_order;
+	std::vector<uint32_t> m_scratchOrder;
+	// far plane used to quantize the view depth of the draws
+	float m_farPlane;
+
+public:
+	// remove all recorded commands
+	void Clear();
+	// set the far plane used to quantize view depths
+	void SetFarPlane(float farPlane) { m_farPlane = farPlane; }
+	// record a draw command - the sort key is built from the
+	// command fields and the view depth of the draw
+	void AddCommand(const DRAW_COMMAND& command, float viewDepth);
+	// sort the recorded commands on their sort keys
+	void Sort();
+
+	// number of recorded commands
+	size_t GetCommandCount() const { return(m_commands.size()); }
+	// get a command in sorted order - only valid after Sort()
+	const DRAW_COMMAND& GetSortedCommand(size_t index) const { return(m_commands[m_order[index]]); }
+
+	// build the sort key for a draw command
+	uint64_t MakeSortKey(const DRAW_COMMAND& command, float viewDepth) const;
+
+	// check whether two commands use the same pass, shader
+	// variant, texture, material and occlusion group, so that
+	// they can be drawn with one multi-draw call
+	static bool HasSameBindings(const DRAW_COMMAND& a, const DRAW_COMMAND& b)
+	{
+		return((a.pass == b.pass) &&
+			(a.bTranslucent == b.bTranslucent) &&
+			(a.variant == b.variant) &&
+			(a.occlusionGroup == b.occlusionGroup) &&
+			(a.textureID == b.textureID) &&
+			(a.materialID == b.materialID));
+	}
+	// check whether two commands also draw the same mesh, so that
+	// they can be drawn as instances of one draw
+	static bool HasSameState(const DRAW_COMMAND& a, const DRAW_COMMAND& b)
+	{
+		return(HasSameBindings(a, b) &&
+			(a.meshID == b.meshID) &&
+			(a.meshParts == b.meshParts) &&
+			(a.lod == b.lod));
+	}
+};
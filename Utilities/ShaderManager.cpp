@@ -10,21 +10,123 @@ using namespace std;
 #include <stdlib.h>
 #include <string.h>
 
+#include <sys/types.h>
+#include <sys/stat.h>
+
 #include <GL/glew.h>
 
 #include "ShaderManager.h"
+#include "ProgramCache.h"
+
+// program binaries shared by every shader manager, or NULL to
+// always compile from source
+ProgramCache* ShaderManager::s_pProgramCache = NULL;
+// whether the driver compiles the started loads on its own threads
+bool ShaderManager::s_bParallelCompile = false;
+
+// time between two checks of the shader files for changes
+static const std::chrono::milliseconds g_WatchInterval(250);
+
+/***********************************************************
+ *  GetFileTime()
+ *
+ *  This function is used to get the time a file was last
+ *  written, or 0 when it cannot be found.
+ ***********************************************************/
+static time_t GetFileTime(const std::string& path)
+{
+	struct stat fileStatus;
+	if((path.empty() == true) || (stat(path.c_str(), &fileStatus) != 0)){
+		return 0;
+	}
+	return fileStatus.st_mtime;
+}
+
+/***********************************************************
+ *  InsertDefines()
+ *
+ *  This function is used to add the lines of a shader
+ *  variant after the #version line of the shader code, which
+ *  has to come first.
+ ***********************************************************/
+static void InsertDefines(std::string& shaderCode, const char* defines)
+{
+	if((defines == NULL) || (defines[0] == 0)){
+		return;
+	}
+
+	size_t lineEnd = 0;
+	if(shaderCode.compare(0, 8, "#version") == 0){
+		lineEnd = shaderCode.find('\n');
+		lineEnd = (lineEnd == std::string::npos) ? shaderCode.size() : lineEnd + 1;
+	}
+
+	std::string variant(defines);
+	if(variant[variant.size() - 1] != '\n'){
+		variant += '\n';
+	}
+	shaderCode.insert(lineEnd, variant);
+}
 
 /***********************************************************
  *  LoadShaders()
  *
  *  This method is called to load the shader data from 
- *  external GLSL compatible files.
+ *  external GLSL compatible files.  The geometry shader is
+ *  optional and only loaded when its path is not NULL.  The
+ *  defines select a variant of the shaders, and are added
+ *  to every stage.  With a program cache, a program linked
+ *  from the same code before is loaded from its binary.
  ***********************************************************/
-GLuint ShaderManager::LoadShaders(const char * vertex_file_path,const char * fragment_file_path){
+GLuint ShaderManager::LoadShaders(const char * vertex_file_path,const char * fragment_file_path,const char * geometry_file_path,const char * defines){
 
-	// Create the shaders
-	GLuint VertexShaderID = glCreateShader(GL_VERTEX_SHADER);
-	GLuint FragmentShaderID = glCreateShader(GL_FRAGMENT_SHADER);
+	if(BeginLoadShaders(vertex_file_path, fragment_file_path, geometry_file_path, defines) == 0){
+		return 0;
+	}
+
+	return FinishLoadShaders();
+}
+
+/***********************************************************
+ *  BeginLoadShaders()
+ *
+ *  This method is called to read the shader files and hand
+ *  the stages and the program to the driver to compile and
+ *  link, without waiting for it.  Nothing is queried until
+ *  the load is finished, so with parallel compiling the
+ *  driver works on its own threads in the meantime.  A
+ *  program found in the cache is ready at once.
+ ***********************************************************/
+GLuint ShaderManager::BeginLoadShaders(const char * vertex_file_path,const char * fragment_file_path,const char * geometry_file_path,const char * defines){
+
+	return StartLoad(vertex_file_path, fragment_file_path, geometry_file_path, defines, false);
+}
+
+/***********************************************************
+ *  StartLoad()
+ *
+ *  This method is called to read the shader files and start
+ *  compiling them, for a new program or to reload the one
+ *  in use.  A reload keeps the program in use until the new
+ *  one has linked.  The files and defines are remembered,
+ *  with the time each file was written, so that the files
+ *  can be watched for changes.
+ ***********************************************************/
+GLuint ShaderManager::StartLoad(const char * vertex_file_path,const char * fragment_file_path,const char * geometry_file_path,const char * defines,bool bReload){
+
+	// a load that was started before is finished first
+	if(m_pending.programID != 0){
+		FinishLoadShaders();
+	}
+
+	// the times are taken before the files are read, so that a
+	// file written while it is read is loaded again
+	const char* WatchedPaths[3] = { vertex_file_path, fragment_file_path, geometry_file_path };
+	for(int stage = 0; stage < 3; stage++){
+		m_sourcePaths[stage] = (WatchedPaths[stage] != NULL) ? WatchedPaths[stage] : "";
+		m_sourceTimes[stage] = GetFileTime(m_sourcePaths[stage]);
+	}
+	m_defines = (defines != NULL) ? defines : "";
 
 	// Read the Vertex Shader code from the file
 	std::string VertexShaderCode;
@@ -36,7 +138,11 @@ GLuint ShaderManager::LoadShaders(const char * vertex_file_path,const char * fra
 		VertexShaderStream.close();
 	}else{
 		printf("Impossible to open %s. Are you in the right directory ? Don't forget to read the FAQ !\n", vertex_file_path);
-		getchar();
+		// an editor may have the file open while it saves it, so a
+		// reload does not wait for the user
+		if(bReload == false){
+			getchar();
+		}
 		return 0;
 	}
 
@@ -50,40 +156,333 @@ GLuint ShaderManager::LoadShaders(const char * vertex_file_path,const char * fra
 		FragmentShaderStream.close();
 	}
 
+	// Read the optional Geometry Shader code from the file
+	std::string GeometryShaderCode;
+	if(geometry_file_path != NULL){
+		std::ifstream GeometryShaderStream(geometry_file_path, std::ios::in);
+		if(GeometryShaderStream.is_open()){
+			std::stringstream sstr;
+			sstr << GeometryShaderStream.rdbuf();
+			GeometryShaderCode = sstr.str();
+			GeometryShaderStream.close();
+		}else{
+			printf("Impossible to open %s. Are you in the right directory ?\n", geometry_file_path);
+		}
+		InsertDefines(GeometryShaderCode, defines);
+	}
+
+	InsertDefines(VertexShaderCode, defines);
+	InsertDefines(FragmentShaderCode, defines);
+
+	// a program linked from the same code by the same driver is
+	// loaded from the binary it left in the cache
+	uint64_t CacheKey = 0;
+	if(s_pProgramCache != NULL){
+		std::string StageCode[3] = { VertexShaderCode, FragmentShaderCode, GeometryShaderCode };
+		CacheKey = s_pProgramCache->MakeKey(StageCode, 3);
+		GLuint CachedProgramID = s_pProgramCache->LoadProgram(CacheKey);
+		if(CachedProgramID != 0){
+			printf("Loaded cached shader program : %s\n", vertex_file_path);
+			if((bReload == true) && (m_programID != 0)){
+				glDeleteProgram(m_programID);
+			}
+			m_programID = CachedProgramID;
+			ReflectUniforms(CachedProgramID);
+			return CachedProgramID;
+		}
+	}
+
+	// Compile the stages - the optional Geometry Shader only
+	// when its path is given
+	const char* StagePaths[3] = { vertex_file_path, fragment_file_path, geometry_file_path };
+	const std::string* StageCode[3] = { &VertexShaderCode, &FragmentShaderCode, &GeometryShaderCode };
+	const GLenum StageTypes[3] = { GL_VERTEX_SHADER, GL_FRAGMENT_SHADER, GL_GEOMETRY_SHADER };
+	for(int stage = 0; stage < 3; stage++){
+		m_pending.stageIDs[stage] = 0;
+		m_pending.stagePaths[stage] = (StagePaths[stage] != NULL) ? StagePaths[stage] : "";
+		if(StagePaths[stage] == NULL){
+			continue;
+		}
+		m_pending.stageIDs[stage] = glCreateShader(StageTypes[stage]);
+		char const * SourcePointer = StageCode[stage]->c_str();
+		glShaderSource(m_pending.stageIDs[stage], 1, &SourcePointer , NULL);
+		glCompileShader(m_pending.stageIDs[stage]);
+	}
+
+	// Link the program
+	GLuint ProgramID = glCreateProgram();
+	for(int stage = 0; stage < 3; stage++){
+		if(m_pending.stageIDs[stage] != 0){
+			glAttachShader(ProgramID, m_pending.stageIDs[stage]);
+		}
+	}
+	if(s_pProgramCache != NULL){
+		glProgramParameteri(ProgramID, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+	}
+	glLinkProgram(ProgramID);
+
+	// the program is not used until the load is finished - a
+	// reload keeps drawing with the program in use until then
+	if(bReload == false){
+		m_programID = 0;
+	}
+	m_pending.programID = ProgramID;
+	m_pending.cacheKey = CacheKey;
+	m_pending.bReload = bReload;
+
+	return ProgramID;
+}
+
+/***********************************************************
+ *  PollLoadShaders()
+ *
+ *  This method is called to check whether the driver has
+ *  finished the program that was started, and to finish the
+ *  load when it has.  Without parallel compiling there is
+ *  no way to ask, so the load is finished at once.  Returns
+ *  whether the load is finished.
+ ***********************************************************/
+bool ShaderManager::PollLoadShaders(){
+
+	if(m_pending.programID == 0){
+		return true;
+	}
+
+	if(s_bParallelCompile == true){
+		GLint Completed = GL_FALSE;
+		glGetProgramiv(m_pending.programID, GL_COMPLETION_STATUS_KHR, &Completed);
+		if(Completed != GL_TRUE){
+			return false;
+		}
+	}
+
+	FinishLoadShaders();
+	return true;
+}
+
+/***********************************************************
+ *  FinishLoadShaders()
+ *
+ *  This method is called to wait for the program that was
+ *  started, report the logs of its stages and program, and
+ *  store it in the cache when it linked.  The program is
+ *  returned even when it did not link.
+ ***********************************************************/
+GLuint ShaderManager::FinishLoadShaders(){
+
+	GLuint ProgramID = m_pending.programID;
+	if(ProgramID == 0){
+		return m_programID;
+	}
+
 	GLint Result = GL_FALSE;
 	int InfoLogLength;
 
+	// Check the stages
+	for(int stage = 0; stage < 3; stage++){
+		GLuint ShaderID = m_pending.stageIDs[stage];
+		if(ShaderID == 0){
+			continue;
+		}
 
-	// Compile Vertex Shader
-	printf("Compiling shader : %s...", vertex_file_path);
-	char const * VertexSourcePointer = VertexShaderCode.c_str();
-	glShaderSource(VertexShaderID, 1, &VertexSourcePointer , NULL);
-	glCompileShader(VertexShaderID);
+		printf("Compiling shader : %s...", m_pending.stagePaths[stage].c_str());
+		glGetShaderiv(ShaderID, GL_COMPILE_STATUS, &Result);
+		glGetShaderiv(ShaderID, GL_INFO_LOG_LENGTH, &InfoLogLength);
+		if ( InfoLogLength > 0 ){
+			std::vector<char> ShaderErrorMessage(InfoLogLength+1);
+			glGetShaderInfoLog(ShaderID, InfoLogLength, NULL, &ShaderErrorMessage[0]);
+			printf("\n%s\n", &ShaderErrorMessage[0]);
+		}
 
-	// Check Vertex Shader
-	glGetShaderiv(VertexShaderID, GL_COMPILE_STATUS, &Result);
-	glGetShaderiv(VertexShaderID, GL_INFO_LOG_LENGTH, &InfoLogLength);
-	if ( InfoLogLength > 0 ){
-		std::vector<char> VertexShaderErrorMessage(InfoLogLength+1);
-		glGetShaderInfoLog(VertexShaderID, InfoLogLength, NULL, &VertexShaderErrorMessage[0]);
-		printf("\n%s\n", &VertexShaderErrorMessage[0]);
+		printf("success\n");
+	}
+
+	// Check the program
+	printf("Linking shader program...");
+	glGetProgramiv(ProgramID, GL_LINK_STATUS, &Result);
+	glGetProgramiv(ProgramID, GL_INFO_LOG_LENGTH, &InfoLogLength);
+	if ( InfoLogLength > 1 ){
+		std::vector<char> ProgramErrorMessage(InfoLogLength+1);
+		glGetProgramInfoLog(ProgramID, InfoLogLength, NULL, &ProgramErrorMessage[0]);
+		printf("\n%s\n", &ProgramErrorMessage[0]);
 	}
 
 	printf("success\n");
 
-	// Compile Fragment Shader
-	printf("Compiling shader : %s...", fragment_file_path);
-	char const * FragmentSourcePointer = FragmentShaderCode.c_str();
-	glShaderSource(FragmentShaderID, 1, &FragmentSourcePointer , NULL);
-	glCompileShader(FragmentShaderID);
+	for(int stage = 0; stage < 3; stage++){
+		if(m_pending.stageIDs[stage] != 0){
+			glDetachShader(ProgramID, m_pending.stageIDs[stage]);
+			glDeleteShader(m_pending.stageIDs[stage]);
+			m_pending.stageIDs[stage] = 0;
+		}
+	}
+	m_pending.programID = 0;
+
+	// a reload that did not link leaves the program in use
+	if(m_pending.bReload == true){
+		if(Result != GL_TRUE){
+			printf("Keeping the last shader program of %s\n", m_pending.stagePaths[0].c_str());
+			glDeleteProgram(ProgramID);
+			return m_programID;
+		}
+		if(m_programID != 0){
+			glDeleteProgram(m_programID);
+		}
+	}
 
-	// Check Fragment Shader
-	glGetShaderiv(FragmentShaderID, GL_COMPILE_STATUS, &Result);
-	glGetShaderiv(FragmentShaderID, GL_INFO_LOG_LENGTH, &InfoLogLength);
+	// keep the binary of a program that linked for the next launch
+	if((s_pProgramCache != NULL) && (Result == GL_TRUE)){
+		s_pProgramCache->SaveProgram(m_pending.cacheKey, ProgramID);
+	}
+
+	// build the uniform location table so that lookups never
+	// need to query the driver while rendering
+	ReflectUniforms(ProgramID);
+
+	m_programID = ProgramID;
+
+	return ProgramID;
+}
+
+/***********************************************************
+ *  UpdateHotReload()
+ *
+ *  This method is called between frames to check the shader
+ *  files of the program a few times a second.  When one of
+ *  them was written, the program is compiled again through
+ *  the same path as a started load, and the frames keep
+ *  drawing with the program in use meanwhile.  The new one
+ *  replaces it once it has linked, and is dropped when it
+ *  has not.  Returns whether the program was replaced, so
+ *  that its uniforms and blocks can be set up again.
+ ***********************************************************/
+bool ShaderManager::UpdateHotReload(){
+
+	// a reload that was started is swapped in when it is done
+	if(m_pending.programID != 0){
+		if(m_pending.bReload == false){
+			return false;
+		}
+		GLuint PreviousID = m_programID;
+		if(PollLoadShaders() == false){
+			return false;
+		}
+		return (m_programID != PreviousID);
+	}
+
+	if(m_sourcePaths[0].empty() == true){
+		return false;
+	}
+	std::chrono::steady_clock::time_point Now = std::chrono::steady_clock::now();
+	if(Now - m_lastWatch < g_WatchInterval){
+		return false;
+	}
+	m_lastWatch = Now;
+
+	bool bChanged = false;
+	for(int stage = 0; stage < 3; stage++){
+		if((m_sourcePaths[stage].empty() == false) && (GetFileTime(m_sourcePaths[stage]) != m_sourceTimes[stage])){
+			bChanged = true;
+		}
+	}
+	if(bChanged == false){
+		return false;
+	}
+
+	// the remembered files are replaced by the load, so they are
+	// passed in as copies
+	std::string Paths[3] = { m_sourcePaths[0], m_sourcePaths[1], m_sourcePaths[2] };
+	std::string Defines = m_defines;
+	printf("Reloading shader program : %s\n", Paths[0].c_str());
+
+	// a program found in the program cache replaces it at once
+	GLuint PreviousID = m_programID;
+	StartLoad(
+		Paths[0].c_str(),
+		Paths[1].c_str(),
+		(Paths[2].empty() == true) ? NULL : Paths[2].c_str(),
+		Defines.c_str(),
+		true);
+
+	return (m_programID != PreviousID);
+}
+
+/***********************************************************
+ *  SetParallelCompile()
+ *
+ *  This method is called to let the driver compile and link
+ *  shaders on threads of its own, so that the loads started
+ *  with BeginLoadShaders() run while the application does
+ *  other work.  Returns false when the driver has neither
+ *  parallel shader compile extension.
+ ***********************************************************/
+bool ShaderManager::SetParallelCompile(GLuint maxThreads){
+
+	if(GLEW_KHR_parallel_shader_compile == GL_TRUE){
+		glMaxShaderCompilerThreadsKHR(maxThreads);
+		s_bParallelCompile = true;
+	}
+	else if(GLEW_ARB_parallel_shader_compile == GL_TRUE){
+		glMaxShaderCompilerThreadsARB(maxThreads);
+		s_bParallelCompile = true;
+	}
+	else{
+		s_bParallelCompile = false;
+	}
+
+	return s_bParallelCompile;
+}
+
+/***********************************************************
+ *  LoadComputeShader()
+ *
+ *  This method is called to load a compute shader from an
+ *  external GLSL file and link it into its own program.
+ ***********************************************************/
+GLuint ShaderManager::LoadComputeShader(const char * compute_file_path){
+
+	// Read the Compute Shader code from the file
+	std::string ComputeShaderCode;
+	std::ifstream ComputeShaderStream(compute_file_path, std::ios::in);
+	if(ComputeShaderStream.is_open()){
+		std::stringstream sstr;
+		sstr << ComputeShaderStream.rdbuf();
+		ComputeShaderCode = sstr.str();
+		ComputeShaderStream.close();
+	}else{
+		printf("Impossible to open %s. Are you in the right directory ?\n", compute_file_path);
+		return 0;
+	}
+
+	uint64_t CacheKey = 0;
+	if(s_pProgramCache != NULL){
+		CacheKey = s_pProgramCache->MakeKey(&ComputeShaderCode, 1);
+		GLuint CachedProgramID = s_pProgramCache->LoadProgram(CacheKey);
+		if(CachedProgramID != 0){
+			printf("Loaded cached shader program : %s\n", compute_file_path);
+			m_programID = CachedProgramID;
+			ReflectUniforms(CachedProgramID);
+			return CachedProgramID;
+		}
+	}
+
+	GLint Result = GL_FALSE;
+	int InfoLogLength;
+
+	// Compile Compute Shader
+	printf("Compiling shader : %s...", compute_file_path);
+	GLuint ComputeShaderID = glCreateShader(GL_COMPUTE_SHADER);
+	char const * ComputeSourcePointer = ComputeShaderCode.c_str();
+	glShaderSource(ComputeShaderID, 1, &ComputeSourcePointer , NULL);
+	glCompileShader(ComputeShaderID);
+
+	// Check Compute Shader
+	glGetShaderiv(ComputeShaderID, GL_COMPILE_STATUS, &Result);
+	glGetShaderiv(ComputeShaderID, GL_INFO_LOG_LENGTH, &InfoLogLength);
 	if ( InfoLogLength > 0 ){
-		std::vector<char> FragmentShaderErrorMessage(InfoLogLength+1);
-		glGetShaderInfoLog(FragmentShaderID, InfoLogLength, NULL, &FragmentShaderErrorMessage[0]);
-		printf("\n%s\n", &FragmentShaderErrorMessage[0]);
+		std::vector<char> ComputeShaderErrorMessage(InfoLogLength+1);
+		glGetShaderInfoLog(ComputeShaderID, InfoLogLength, NULL, &ComputeShaderErrorMessage[0]);
+		printf("\n%s\n", &ComputeShaderErrorMessage[0]);
 	}
 
 	printf("success\n");
@@ -92,8 +491,10 @@ GLuint ShaderManager::LoadShaders(const char * vertex_file_path,const char * fra
 	printf("Linking shader program...");
 	GLuint ProgramID = glCreateProgram();
 	m_programID = ProgramID;
-	glAttachShader(ProgramID, VertexShaderID);
-	glAttachShader(ProgramID, FragmentShaderID);
+	glAttachShader(ProgramID, ComputeShaderID);
+	if(s_pProgramCache != NULL){
+		glProgramParameteri(ProgramID, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+	}
 	glLinkProgram(ProgramID);
 
 	// Check the program
@@ -106,14 +507,126 @@ GLuint ShaderManager::LoadShaders(const char * vertex_file_path,const char * fra
 	}
 
 	printf("success\n");
-	
-	glDetachShader(ProgramID, VertexShaderID);
-	glDetachShader(ProgramID, FragmentShaderID);
-	
-	glDeleteShader(VertexShaderID);
-	glDeleteShader(FragmentShaderID);
+
+	if((s_pProgramCache != NULL) && (Result == GL_TRUE)){
+		s_pProgramCache->SaveProgram(CacheKey, ProgramID);
+	}
+
+	ReflectUniforms(ProgramID);
+
+	glDetachShader(ProgramID, ComputeShaderID);
+	glDeleteShader(ComputeShaderID);
+
+	// report a program that failed to link as not loaded
+	if (Result != GL_TRUE){
+		glDeleteProgram(ProgramID);
+		m_programID = 0;
+		return 0;
+	}
 
 	return ProgramID;
 }
 
+/***********************************************************
+ *  ReflectUniforms()
+ *
+ *  This method is called after linking to list every active
+ *  uniform in the program and store its location in a table
+ *  keyed by the hash of the uniform name.
+ ***********************************************************/
+void ShaderManager::ReflectUniforms(GLuint programID)
+{
+	GLint uniformCount = 0;
+	GLint maxNameLength = 0;
+
+	m_uniforms.clear();
+
+	glGetProgramiv(programID, GL_ACTIVE_UNIFORMS, &uniformCount);
+	glGetProgramiv(programID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength);
+	if ((uniformCount <= 0) || (maxNameLength <= 0))
+	{
+		return;
+	}
+
+	std::vector<char> nameBuffer(maxNameLength + 1);
+	m_uniforms.reserve(uniformCount);
+
+	for (GLint i = 0; i < uniformCount; i++)
+	{
+		GLsizei nameLength = 0;
+		GLint arraySize = 0;
+		GLenum uniformType = GL_NONE;
+
+		glGetActiveUniform(programID, (GLuint)i, maxNameLength, &nameLength, &arraySize, &uniformType, &nameBuffer[0]);
+		std::string uniformName(&nameBuffer[0], nameLength);
+
+		// members of uniform blocks have no location
+		GLint location = glGetUniformLocation(programID, uniformName.c_str());
+		if (location < 0)
+		{
+			continue;
+		}
+		AddUniform(uniformName, location);
+
+		// arrays of basic types are reported once as "name[0]", so
+		// also register the bare name and every other element
+		size_t suffix = uniformName.rfind("[0]");
+		if ((suffix != std::string::npos) && (suffix + 3 == uniformName.size()))
+		{
+			std::string baseName = uniformName.substr(0, suffix);
+			AddUniform(baseName, location);
+			for (GLint element = 1; element < arraySize; element++)
+			{
+				std::string elementName = baseName + "[" + std::to_string(element) + "]";
+				AddUniform(elementName, glGetUniformLocation(programID, elementName.c_str()));
+			}
+		}
+	}
+
+	std::sort(m_uniforms.begin(), m_uniforms.end(),
+		[](const UNIFORM_INFO& a, const UNIFORM_INFO& b) { return(a.nameHash < b.nameHash); });
+
+	for (size_t i = 1; i < m_uniforms.size(); i++)
+	{
+		if (m_uniforms[i].nameHash == m_uniforms[i - 1].nameHash)
+		{
+			printf("WARNING: uniform name hash collision in program %u\n", programID);
+		}
+	}
+}
+
+/***********************************************************
+ *  AddUniform()
+ *
+ *  This method is used to add one uniform name and its
+ *  location to the uniform location table.
+ ***********************************************************/
+void ShaderManager::AddUniform(const std::string& name, GLint location)
+{
+	UNIFORM_INFO uniform;
+	uniform.nameHash = HashUniformName(name.c_str());
+	uniform.location = location;
+	m_uniforms.push_back(uniform);
+}
+
+/***********************************************************
+ *  GetUniformHandle()
+ *
+ *  This method is used to look up the location of a uniform
+ *  from the hash of its name.  An invalid handle is returned
+ *  for uniforms that are not active in the program.
+ ***********************************************************/
+UniformHandle ShaderManager::GetUniformHandle(uint32_t nameHash) const
+{
+	UniformHandle handle;
 
+	std::vector<UNIFORM_INFO>::const_iterator it = std::lower_bound(
+		m_uniforms.begin(), m_uniforms.end(), nameHash,
+		[](const UNIFORM_INFO& uniform, uint32_t hash) { return(uniform.nameHash < hash); });
+	if ((it != m_uniforms.end()) && (it->nameHash == nameHash))
+	{
+		handle.location = it->location;
+	}
+
+	return(handle);
+}
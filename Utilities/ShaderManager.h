@@ -7,18 +7,72 @@
 #include <glm/gtc/type_ptr.hpp>
 
 #include <string>
+#include <vector>
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <stdint.h>
+#include <chrono>
+#include <time.h>
+
+class ProgramCache;
+
+// hash a uniform name with 32-bit FNV-1a - usable at compile time so
+// that literal names can be hashed once instead of on every lookup
+constexpr uint32_t HashUniformName(const char* name, uint32_t hash = 2166136261u)
+{
+	return (*name == '\0') ? hash :
+		HashUniformName(name + 1, (hash ^ (uint32_t)(unsigned char)*name) * 16777619u);
+}
+
+// resolved location of an active uniform in a linked program - a
+// default constructed handle refers to no uniform and is ignored
+struct UniformHandle
+{
+	GLint location = -1;
+
+	inline bool IsValid() const { return(location >= 0); }
+};
 
 class ShaderManager
 {
 public:
 	unsigned int m_programID;
-	
+
 	GLuint LoadShaders(
-		const char* vertex_file_path, 
-		const char* fragment_file_path);
+		const char* vertex_file_path,
+		const char* fragment_file_path,
+		const char* geometry_file_path = NULL,
+		const char* defines = NULL);
+	GLuint LoadComputeShader(
+		const char* compute_file_path);
+
+	// start compiling and linking the shaders without waiting
+	// for the driver, which LoadShaders() does in one call
+	GLuint BeginLoadShaders(
+		const char* vertex_file_path,
+		const char* fragment_file_path,
+		const char* geometry_file_path = NULL,
+		const char* defines = NULL);
+	// finish the started load once the driver is done with it -
+	// returns whether no load is left pending
+	bool PollLoadShaders();
+	// wait for the started load and finish it
+	GLuint FinishLoadShaders();
+	// whether a started load has not been finished yet
+	bool IsLoadPending() const { return(m_pending.programID != 0); }
+	// let the driver compile on up to maxThreads threads of its
+	// own - returns false when it cannot
+	static bool SetParallelCompile(GLuint maxThreads);
+	// check the shader files for changes between frames, and
+	// compile the program again in the background - returns
+	// whether the program was replaced by one that linked
+	bool UpdateHotReload();
+
+	// load the programs linked before from the binaries of a
+	// cache, and store the ones compiled from source in it -
+	// NULL always compiles from source
+	static void SetProgramCache(ProgramCache* pProgramCache) { s_pProgramCache = pProgramCache; }
 
 	// activate the shader
 	// ------------------------------------------------------------------------
@@ -27,77 +81,204 @@ public:
 		glUseProgram(m_programID);
 	}
 
+	// connect a uniform block of the program to a binding point
+	// ------------------------------------------------------------------------
+	inline void BindUniformBlock(const char* blockName, GLuint binding) const
+	{
+		GLuint blockIndex = glGetUniformBlockIndex(m_programID, blockName);
+		if (blockIndex != GL_INVALID_INDEX)
+		{
+			glUniformBlockBinding(m_programID, blockIndex, binding);
+		}
+	}
+
+	// uniform location lookup
+	// ------------------------------------------------------------------------
+	UniformHandle GetUniformHandle(uint32_t nameHash) const;
+
+	inline UniformHandle GetUniformHandle(const char* name) const
+	{
+		return(GetUniformHandle(HashUniformName(name)));
+	}
+
 	// utility uniform functions
 	// ------------------------------------------------------------------------
-	inline void setBoolValue(const std::string &name, bool value) const
+	inline void setBoolValue(UniformHandle handle, bool value) const
 	{
-		glUniform1i(glGetUniformLocation(m_programID, name.c_str()), (int)value);
+		glUniform1i(handle.location, (int)value);
+	}
+	inline void setBoolValue(const char* name, bool value) const
+	{
+		setBoolValue(GetUniformHandle(name), value);
 	}
 
 	// ------------------------------------------------------------------------
-	inline void setIntValue(const std::string &name, int value) const
+	inline void setIntValue(UniformHandle handle, int value) const
+	{
+		glUniform1i(handle.location, value);
+	}
+	inline void setIntValue(const char* name, int value) const
 	{
-		glUniform1i(glGetUniformLocation(m_programID, name.c_str()), value);
+		setIntValue(GetUniformHandle(name), value);
 	}
 
 	// ------------------------------------------------------------------------
-	inline void setFloatValue(const std::string &name, float value) const
+	inline void setFloatValue(UniformHandle handle, float value) const
+	{
+		glUniform1f(handle.location, value);
+	}
+	inline void setFloatValue(const char* name, float value) const
 	{
-		glUniform1f(glGetUniformLocation(m_programID, name.c_str()), value);
+		setFloatValue(GetUniformHandle(name), value);
 	}
 
 	// ------------------------------------------------------------------------
-	inline void setVec2Value(const std::string &name, const glm::vec2 &value) const
+	inline void setVec2Value(UniformHandle handle, const glm::vec2 &value) const
 	{
-		glUniform2fv(glGetUniformLocation(m_programID, name.c_str()), 1, &value[0]);
+		glUniform2fv(handle.location, 1, &value[0]);
+	}
+	inline void setVec2Value(const char* name, const glm::vec2 &value) const
+	{
+		setVec2Value(GetUniformHandle(name), value);
 	}
 
-	inline void setVec2Value(const std::string &name, float x, float y) const
+	inline void setVec2Value(UniformHandle handle, float x, float y) const
+	{
+		glUniform2f(handle.location, x, y);
+	}
+	inline void setVec2Value(const char* name, float x, float y) const
 	{
-		glUniform2f(glGetUniformLocation(m_programID, name.c_str()), x, y);
+		setVec2Value(GetUniformHandle(name), x, y);
 	}
 
 	// ------------------------------------------------------------------------
-	inline void setVec3Value(const std::string &name, const glm::vec3 &value) const
+	inline void setVec3Value(UniformHandle handle, const glm::vec3 &value) const
 	{
-		glUniform3fv(glGetUniformLocation(m_programID, name.c_str()), 1, &value[0]);
+		glUniform3fv(handle.location, 1, &value[0]);
 	}
-	inline void setVec3Value(const std::string &name, float x, float y, float z) const
+	inline void setVec3Value(const char* name, const glm::vec3 &value) const
 	{
-		glUniform3f(glGetUniformLocation(m_programID, name.c_str()), x, y, z);
+		setVec3Value(GetUniformHandle(name), value);
+	}
+	inline void setVec3Value(UniformHandle handle, float x, float y, float z) const
+	{
+		glUniform3f(handle.location, x, y, z);
+	}
+	inline void setVec3Value(const char* name, float x, float y, float z) const
+	{
+		setVec3Value(GetUniformHandle(name), x, y, z);
 	}
 
 	// ------------------------------------------------------------------------
-	inline void setVec4Value(const std::string &name, const glm::vec4 &value) const
+	inline void setVec4Value(UniformHandle handle, const glm::vec4 &value) const
+	{
+		glUniform4fv(handle.location, 1, &value[0]);
+	}
+	inline void setVec4Value(const char* name, const glm::vec4 &value) const
+	{
+		setVec4Value(GetUniformHandle(name), value);
+	}
+	inline void setVec4Value(UniformHandle handle, float x, float y, float z, float w) const
 	{
-		glUniform4fv(glGetUniformLocation(m_programID, name.c_str()), 1, &value[0]);
+		glUniform4f(handle.location, x, y, z, w);
 	}
-	inline void setVec4Value(const std::string &name, float x, float y, float z, float w)
+	inline void setVec4Value(const char* name, float x, float y, float z, float w) const
 	{
-		glUniform4f(glGetUniformLocation(m_programID, name.c_str()), x, y, z, w);
+		setVec4Value(GetUniformHandle(name), x, y, z, w);
 	}
 
 	// ------------------------------------------------------------------------
-	inline void setMat2Value(const std::string &name, const glm::mat2 &mat) const
+	inline void setMat2Value(UniformHandle handle, const glm::mat2 &mat) const
+	{
+		glUniformMatrix2fv(handle.location, 1, GL_FALSE, &mat[0][0]);
+	}
+	inline void setMat2Value(const char* name, const glm::mat2 &mat) const
 	{
-		glUniformMatrix2fv(glGetUniformLocation(m_programID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+		setMat2Value(GetUniformHandle(name), mat);
 	}
 
 	// ------------------------------------------------------------------------
-	inline void setMat3Value(const std::string &name, const glm::mat3 &mat) const
+	inline void setMat3Value(UniformHandle handle, const glm::mat3 &mat) const
 	{
-		glUniformMatrix3fv(glGetUniformLocation(m_programID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+		glUniformMatrix3fv(handle.location, 1, GL_FALSE, &mat[0][0]);
+	}
+	inline void setMat3Value(const char* name, const glm::mat3 &mat) const
+	{
+		setMat3Value(GetUniformHandle(name), mat);
 	}
 
 	// ------------------------------------------------------------------------
-	inline void setMat4Value(const std::string &name, const glm::mat4 &mat) const
+	inline void setMat4Value(UniformHandle handle, const glm::mat4 &mat) const
+	{
+		glUniformMatrix4fv(handle.location, 1, GL_FALSE, glm::value_ptr(mat));
+	}
+	inline void setMat4Value(const char* name, const glm::mat4 &mat) const
 	{
-		glUniformMatrix4fv(glGetUniformLocation(m_programID, name.c_str()), 1, GL_FALSE, glm::value_ptr(mat));
+		setMat4Value(GetUniformHandle(name), mat);
+	}
+	inline void setMat4ArrayValue(UniformHandle handle, const glm::mat4* mats, GLsizei count) const
+	{
+		glUniformMatrix4fv(handle.location, count, GL_FALSE, glm::value_ptr(mats[0]));
 	}
 
 	// ------------------------------------------------------------------------
-	inline void setSampler2DValue(const std::string& name, const int &value) const
+	inline void setSampler2DValue(UniformHandle handle, const int &value) const
+	{
+		glUniform1i(handle.location, value);
+	}
+	inline void setSampler2DValue(const char* name, const int &value) const
 	{
-		glUniform1i(glGetUniformLocation(m_programID, name.c_str()), value);
+		setSampler2DValue(GetUniformHandle(name), value);
 	}
-};
\ No newline at end of file
+
+private:
+	// location of one active uniform, keyed by the hash of its name
+	struct UNIFORM_INFO
+	{
+		uint32_t nameHash;
+		GLint location;
+	};
+
+	// active uniforms of the linked program, sorted by name hash
+	std::vector<UNIFORM_INFO> m_uniforms;
+
+	// program binaries shared by every shader manager
+	static ProgramCache* s_pProgramCache;
+	// set when the driver compiles on threads of its own
+	static bool s_bParallelCompile;
+
+	// program whose load was started, with its stages and the
+	// key it is cached with once it links
+	struct PENDING_PROGRAM
+	{
+		GLuint programID = 0;
+		GLuint stageIDs[3] = { 0, 0, 0 };
+		std::string stagePaths[3];
+		uint64_t cacheKey = 0;
+		// set when the program replaces the one in use
+		bool bReload = false;
+	};
+	PENDING_PROGRAM m_pending;
+
+	// files and defines the program was loaded from, and the
+	// time each file was written, for the hot reload
+	std::string m_sourcePaths[3];
+	time_t m_sourceTimes[3] = { 0, 0, 0 };
+	std::string m_defines;
+	std::chrono::steady_clock::time_point m_lastWatch;
+
+	// read the shader files and start compiling them, for a new
+	// program or to replace the one in use
+	GLuint StartLoad(
+		const char* vertex_file_path,
+		const char* fragment_file_path,
+		const char* geometry_file_path,
+		const char* defines,
+		bool bReload);
+
+	// query the active uniforms of the linked program and
+	// build the location table
+	void ReflectUniforms(GLuint programID);
+	// add one uniform name to the location table
+	void AddUniform(const std::string& name, GLint location);
+};
@@ -0,0 +1,312 @@
+///////////////////////////////////////////////////////////////////////////////
+// shadervariants.cpp
+// ============
+// compile the variants of a shader program for sets of features on first
+// use, and keep them cached by their feature bits
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "ShaderVariants.h"
+
+#include <iostream>
+
+// declaration of global variables
+namespace
+{
+	// define that makes the shaders read the features as
+	// constants, and the define of each feature bit
+	const char* g_VariantDefine = "#define SHADER_VARIANT\n";
+	const char* g_FeatureDefines[ShaderVariants::feature_bits] = {
+		"#define FEATURE_TEXTURE\n",
+		"#define FEATURE_INSTANCED\n",
+		"#define FEATURE_PACKED\n",
+		"#define FEATURE_LIGHTING\n",
+		"#define FEATURE_BLINN\n"
+	};
+}
+
+/***********************************************************
+ *  ShaderVariants()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+ShaderVariants::ShaderVariants()
+{
+	for (int i = 0; i < variant_count; i++)
+	{
+		m_variants[i].m_programID = 0;
+		m_states[i] = state_none;
+	}
+	m_nVariants = 0;
+	m_nPending = 0;
+}
+
+/***********************************************************
+ *  ~ShaderVariants()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+ShaderVariants::~ShaderVariants()
+{
+	Clear();
+}
+
+/***********************************************************
+ *  SetSources()
+ *
+ *  This method is used to set the shader files that the
+ *  variants are compiled from.  The variants that were
+ *  built from other files are freed.
+ ***********************************************************/
+void ShaderVariants::SetSources(
+	const char* vertexPath,
+	const char* fragmentPath,
+	const char* geometryPath)
+{
+	Clear();
+
+	m_vertexPath = vertexPath;
+	m_fragmentPath = fragmentPath;
+	m_geometryPath = (NULL != geometryPath) ? geometryPath : "";
+}
+
+/***********************************************************
+ *  SetBaseDefines()
+ *
+ *  This method is used to set the defines that every
+ *  variant is compiled with.  The variants are only freed
+ *  when the defines changed, so setting the same ones again
+ *  keeps the cache.
+ ***********************************************************/
+void ShaderVariants::SetBaseDefines(const char* defines)
+{
+	std::string baseDefines = (NULL != defines) ? defines : "";
+	if (baseDefines == m_baseDefines)
+	{
+		return;
+	}
+
+	Clear();
+	m_baseDefines = baseDefines;
+}
+
+/***********************************************************
+ *  MakeDefines()
+ *
+ *  This method is used to build the lines added after the
+ *  #version line of a variant, one define for each of its
+ *  features followed by the base defines.
+ ***********************************************************/
+std::string ShaderVariants::MakeDefines(uint32_t features) const
+{
+	std::string defines(g_VariantDefine);
+	for (int bit = 0; bit < feature_bits; bit++)
+	{
+		if ((features & (1u << bit)) != 0)
+		{
+			defines += g_FeatureDefines[bit];
+		}
+	}
+	defines += m_baseDefines;
+
+	return(defines);
+}
+
+/***********************************************************
+ *  RequestVariant()
+ *
+ *  This method is used to hand the program of a set of
+ *  features to the driver the first time it is asked for,
+ *  without waiting for it to be compiled.  A variant that
+ *  failed to link is not compiled again until the cache is
+ *  cleared.
+ ***********************************************************/
+bool ShaderVariants::RequestVariant(uint32_t features)
+{
+	uint32_t key = features & (variant_count - 1);
+	if (m_states[key] != state_none)
+	{
+		return(m_states[key] != state_failed);
+	}
+	if (m_vertexPath.empty() == true)
+	{
+		return(false);
+	}
+
+	std::string defines = MakeDefines(key);
+	GLuint programID = m_variants[key].BeginLoadShaders(
+		m_vertexPath.c_str(),
+		m_fragmentPath.c_str(),
+		(m_geometryPath.empty() == true) ? NULL : m_geometryPath.c_str(),
+		defines.c_str());
+	if (programID == 0)
+	{
+		m_states[key] = state_failed;
+		return(false);
+	}
+
+	m_states[key] = state_compiling;
+	m_nPending++;
+	// a program found in the program cache is ready at once
+	if (m_variants[key].IsLoadPending() == false)
+	{
+		CompleteVariant(key);
+	}
+
+	return(m_states[key] != state_failed);
+}
+
+/***********************************************************
+ *  CompleteVariant()
+ *
+ *  This method is used to check whether a variant whose
+ *  load finished has linked, and free it when it has not.
+ ***********************************************************/
+void ShaderVariants::CompleteVariant(uint32_t key)
+{
+	m_nPending--;
+
+	// LoadShaders returns the program even when it did not link
+	GLuint programID = m_variants[key].m_programID;
+	GLint linked = GL_FALSE;
+	if (programID != 0)
+	{
+		glGetProgramiv(programID, GL_LINK_STATUS, &linked);
+	}
+	if (linked != GL_TRUE)
+	{
+		std::cout << "ERROR: could not link the shader variant " << key << std::endl;
+		if (programID != 0)
+		{
+			glDeleteProgram(programID);
+		}
+		m_variants[key].m_programID = 0;
+		m_states[key] = state_failed;
+		return;
+	}
+
+	m_states[key] = state_linked;
+	m_nVariants++;
+}
+
+/***********************************************************
+ *  GetVariant()
+ *
+ *  This method is used to get the program of a set of
+ *  features.  The program is requested the first time it
+ *  is asked for, and NULL is returned until the driver has
+ *  finished it, so that the caller can draw with another
+ *  program instead of waiting.
+ ***********************************************************/
+ShaderManager* ShaderVariants::GetVariant(
+	uint32_t features,
+	bool* pbCreated)
+{
+	if (NULL != pbCreated)
+	{
+		*pbCreated = false;
+	}
+
+	uint32_t key = features & (variant_count - 1);
+	if (m_states[key] == state_built)
+	{
+		return(&m_variants[key]);
+	}
+	if ((m_states[key] == state_none) && (RequestVariant(key) == false))
+	{
+		return(NULL);
+	}
+	if (m_states[key] == state_compiling)
+	{
+		if (m_variants[key].PollLoadShaders() == false)
+		{
+			return(NULL);
+		}
+		CompleteVariant(key);
+	}
+	if (m_states[key] != state_linked)
+	{
+		return(NULL);
+	}
+
+	m_states[key] = state_built;
+	if (NULL != pbCreated)
+	{
+		*pbCreated = true;
+	}
+
+	return(&m_variants[key]);
+}
+
+/***********************************************************
+ *  FinishVariants()
+ *
+ *  This method is used to wait for the variants that are
+ *  still compiling, such as before timing the frames.
+ ***********************************************************/
+void ShaderVariants::FinishVariants()
+{
+	for (uint32_t key = 0; key < variant_count; key++)
+	{
+		if (m_states[key] == state_compiling)
+		{
+			m_variants[key].FinishLoadShaders();
+			CompleteVariant(key);
+		}
+	}
+}
+
+/***********************************************************
+ *  UpdateHotReload()
+ *
+ *  This method is used between frames to let each variant
+ *  watch its shader files.  A variant whose new program has
+ *  linked is handed out as a new one, and a variant that
+ *  failed before is tried again when its files change.
+ ***********************************************************/
+void ShaderVariants::UpdateHotReload()
+{
+	for (uint32_t key = 0; key < variant_count; key++)
+	{
+		if ((m_states[key] != state_linked) &&
+			(m_states[key] != state_built) &&
+			(m_states[key] != state_failed))
+		{
+			continue;
+		}
+		if (m_variants[key].UpdateHotReload() == true)
+		{
+			if (m_states[key] == state_failed)
+			{
+				m_nVariants++;
+			}
+			m_states[key] = state_linked;
+		}
+	}
+}
+
+/***********************************************************
+ *  Clear()
+ *
+ *  This method is used to free the programs of all of the
+ *  variants, so that they are compiled again when used.
+ ***********************************************************/
+void ShaderVariants::Clear()
+{
+	// the variants still compiling are finished, so that their
+	// stages are freed with them
+	FinishVariants();
+
+	for (int i = 0; i < variant_count; i++)
+	{
+		if ((m_states[i] == state_linked) || (m_states[i] == state_built))
+		{
+			glDeleteProgram(m_variants[i].m_programID);
+		}
+		m_variants[i].m_programID = 0;
+		m_states[i] = state_none;
+	}
+	m_nVariants = 0;
+	m_nPending = 0;
+}
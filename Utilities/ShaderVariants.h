@@ -0,0 +1,129 @@
+///////////////////////////////////////////////////////////////////////////////
+// shadervariants.h
+// ============
+// compile the variants of a shader program for sets of features on first
+// use, and keep them cached by their feature bits
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+#include <string>
+#include <stdint.h>
+
+#include "ShaderManager.h"
+
+/***********************************************************
+ *  ShaderVariants
+ *
+ *  This class builds the variants of one shader program,
+ *  each one with a set of features fixed by defines added
+ *  to its source.  The shaders read a feature as a constant
+ *  in a variant, so the branches of the features it does
+ *  not have are compiled out instead of being tested for
+ *  every vertex and fragment.
+ *
+ *  A variant is only compiled the first time it is asked
+ *  for, and is kept in a table indexed by its feature bits.
+ *  The compile does not block - the variant is handed to
+ *  the driver and is returned once it is ready, so the
+ *  caller draws with a placeholder until then, and the
+ *  variants that will be needed can be requested up front
+ *  to compile while other work is done.
+ ***********************************************************/
+class ShaderVariants
+{
+public:
+	// constructor
+	ShaderVariants();
+	// destructor
+	~ShaderVariants();
+
+	// features a variant can be built with - the ones that
+	// change from draw to draw come first, so that they fit
+	// in the sort key of a draw command
+	enum Feature
+	{
+		feature_texture = 1,
+		feature_instanced = 2,
+		feature_packed = 4,
+		feature_lighting = 8,
+		feature_blinn = 16
+	};
+	// number of feature bits, and the mask of the features
+	// chosen for each draw
+	enum
+	{
+		feature_bits = 5,
+		variant_count = 1 << feature_bits,
+		draw_features = feature_texture | feature_instanced | feature_packed
+	};
+
+	// set the shader files the variants are built from - the
+	// geometry shader is optional
+	void SetSources(
+		const char* vertexPath,
+		const char* fragmentPath,
+		const char* geometryPath = NULL);
+	// set the defines added to every variant, such as the
+	// shadow filter - the variants built with other defines
+	// are freed
+	void SetBaseDefines(const char* defines);
+
+	// start compiling the variant of a set of features when
+	// it has not been yet - returns false when it failed
+	bool RequestVariant(uint32_t features);
+	// get the variant for a set of features, requesting it
+	// when it is first used - pbCreated is set the first time
+	// it is returned, and NULL is returned while it is still
+	// compiling or when it could not be linked
+	ShaderManager* GetVariant(
+		uint32_t features,
+		bool* pbCreated = NULL);
+	// wait for every requested variant to finish
+	void FinishVariants();
+	// compile the variants again in the background when their
+	// shader files change - a variant that was replaced is set
+	// up again the next time it is returned
+	void UpdateHotReload();
+	// free all of the variants
+	void Clear();
+
+	// number of variants compiled and cached, and of the ones
+	// still compiling
+	int GetVariantCount() const { return(m_nVariants); }
+	int GetPendingCount() const { return(m_nPending); }
+
+private:
+	std::string m_vertexPath;
+	std::string m_fragmentPath;
+	std::string m_geometryPath;
+	std::string m_baseDefines;
+
+	// state of the program of a variant - a variant is linked
+	// until it is first returned, so that the caller is told
+	// to set it up even when it finished in the background
+	enum VariantState
+	{
+		state_none,
+		state_compiling,
+		state_linked,
+		state_built,
+		state_failed
+	};
+
+	// the programs indexed by their feature bits, and the
+	// state of each one
+	ShaderManager m_variants[variant_count];
+	VariantState m_states[variant_count];
+	int m_nVariants;
+	int m_nPending;
+
+	// build the defines of a set of features
+	std::string MakeDefines(uint32_t features) const;
+	// check the link of a variant whose load finished
+	void CompleteVariant(uint32_t key);
+};
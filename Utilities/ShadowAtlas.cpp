@@ -0,0 +1,701 @@
+///////////////////////////////////////////////////////////////////////////////
+// shadowatlas.cpp
+// ============
+// pack the shadow maps of the light sources into tiles of one depth texture,
+// sized by how much of the screen each light affects
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "ShadowAtlas.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <math.h>
+#include <iostream>
+
+// declaration of global variables
+namespace
+{
+	// frames a smaller tile has to be asked for before a tile
+	// shrinks, so that it is not drawn again for every small
+	// move of the camera
+	const int g_ShrinkFrames = 30;
+	// largest sine of half the field of view of a light, for a
+	// light close to or inside of its bounds
+	const float g_MaxBoundsSine = 0.95f;
+	// nearest plane of the projection of a light
+	const float g_MinNearPlane = 0.05f;
+
+	// round a size up to a power of two
+	GLsizei RoundUpPowerOfTwo(GLsizei size)
+	{
+		GLsizei rounded = 1;
+		while (rounded < size)
+		{
+			rounded *= 2;
+		}
+		return(rounded);
+	}
+}
+
+/***********************************************************
+ *  ShadowAtlas()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+ShadowAtlas::ShadowAtlas(UniformBufferManager* pUniformBuffers)
+{
+	m_pUniformBuffers = pUniformBuffers;
+	m_depthMapFBO = 0;
+	m_depthMap = 0;
+	m_size = 0;
+	m_minTileSize = 0;
+	m_maxTileSize = 0;
+	m_levels = 0;
+	m_renderedTiles = 0;
+	m_reusedTiles = 0;
+
+	for (int i = 0; i < 4; i++)
+	{
+		m_savedViewport[i] = 0;
+	}
+
+	for (int i = 0; i < TOTAL_LIGHTS; i++)
+	{
+		m_tiles[i].boundsCenter = glm::vec3(0.0f);
+		m_tiles[i].boundsRadius = 0.0f;
+		m_tiles[i].size = 0;
+		m_tiles[i].nodeLevel = 0;
+		m_tiles[i].nodeIndex = -1;
+		m_tiles[i].requestedSize = 0;
+		m_tiles[i].shrinkFrames = 0;
+		m_tiles[i].matrix = glm::mat4(1.0f);
+		m_tiles[i].bDirty = true;
+	}
+}
+
+/***********************************************************
+ *  ~ShadowAtlas()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+ShadowAtlas::~ShadowAtlas()
+{
+	DestroyAtlas();
+	m_pUniformBuffers = NULL;
+}
+
+/***********************************************************
+ *  CreateAtlas()
+ *
+ *  This method is used to create the depth texture of the
+ *  atlas and the framebuffer the tiles are drawn through.
+ *  The texture is read with the hardware depth compare,
+ *  and the area of a tile that no caster covers reads as
+ *  the far plane, so it is never in shadow.
+ ***********************************************************/
+bool ShadowAtlas::CreateAtlas(
+	GLsizei size,
+	GLsizei minTileSize,
+	GLsizei maxTileSize)
+{
+	DestroyAtlas();
+
+	m_size = RoundUpPowerOfTwo(size);
+	m_maxTileSize = glm::min(RoundUpPowerOfTwo(maxTileSize), m_size);
+	m_minTileSize = glm::min(RoundUpPowerOfTwo(minTileSize), m_maxTileSize);
+
+	// one quadtree level for each tile size down to the smallest
+	m_levels = 1;
+	for (GLsizei tileSize = m_size; tileSize > m_minTileSize; tileSize /= 2)
+	{
+		m_levels++;
+	}
+	m_nodes.assign(LevelOffset(m_levels), (uint8_t)node_free);
+
+	glGenTextures(1, &m_depthMap);
+	glBindTexture(GL_TEXTURE_2D, m_depthMap);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT, m_size, m_size, 0, GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	glGenFramebuffers(1, &m_depthMapFBO);
+	glBindFramebuffer(GL_FRAMEBUFFER, m_depthMapFBO);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, m_depthMap, 0);
+	glDrawBuffer(GL_NONE);
+	glReadBuffer(GL_NONE);
+
+	bool bComplete = (glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+	if (bComplete == false)
+	{
+		std::cout << "ERROR: shadow atlas framebuffer is not complete" << std::endl;
+		DestroyAtlas();
+		return(false);
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  DestroyAtlas()
+ *
+ *  This method is used to free the depth texture and the
+ *  framebuffer of the atlas, which takes every light out
+ *  of it.
+ ***********************************************************/
+void ShadowAtlas::DestroyAtlas()
+{
+	if (m_depthMapFBO != 0)
+	{
+		glDeleteFramebuffers(1, &m_depthMapFBO);
+		m_depthMapFBO = 0;
+	}
+	if (m_depthMap != 0)
+	{
+		glDeleteTextures(1, &m_depthMap);
+		m_depthMap = 0;
+	}
+
+	for (int i = 0; i < TOTAL_LIGHTS; i++)
+	{
+		m_tiles[i].size = 0;
+		m_tiles[i].nodeIndex = -1;
+		m_tiles[i].requestedSize = 0;
+		m_tiles[i].casters.clear();
+		m_tiles[i].bDirty = true;
+	}
+	m_nodes.clear();
+	m_levels = 0;
+	m_size = 0;
+}
+
+/***********************************************************
+ *  SetLightBounds()
+ *
+ *  This method is used to set the sphere a light casts its
+ *  shadows into, which its projection is fitted to.
+ ***********************************************************/
+void ShadowAtlas::SetLightBounds(
+	int light,
+	const glm::vec3& center,
+	float radius)
+{
+	if ((light < 0) || (light >= TOTAL_LIGHTS))
+	{
+		return;
+	}
+	m_tiles[light].boundsCenter = center;
+	m_tiles[light].boundsRadius = (radius > 0.0f) ? radius : 0.0f;
+}
+
+/***********************************************************
+ *  UpdateTiles()
+ *
+ *  This method is used to size the tile of each light by
+ *  its screen influence, to place the tiles that changed
+ *  size in the atlas, and to fit the projection of each
+ *  light to its bounds.  A tile grows as soon as a larger
+ *  one is asked for, but only shrinks after a smaller one
+ *  has been asked for over a number of frames.
+ ***********************************************************/
+void ShadowAtlas::UpdateTiles()
+{
+	if ((NULL == m_pUniformBuffers) || (m_depthMap == 0))
+	{
+		return;
+	}
+
+	GLsizei sizes[TOTAL_LIGHTS];
+	bool bPack = false;
+	for (int light = 0; light < TOTAL_LIGHTS; light++)
+	{
+		LIGHT_TILE& tile = m_tiles[light];
+		GLsizei requested = RequestTileSize(light);
+
+		sizes[light] = tile.requestedSize;
+		if ((requested == 0) || (requested > tile.requestedSize))
+		{
+			sizes[light] = requested;
+			tile.shrinkFrames = 0;
+		}
+		else if (requested < tile.requestedSize)
+		{
+			tile.shrinkFrames++;
+			if (tile.shrinkFrames >= g_ShrinkFrames)
+			{
+				sizes[light] = requested;
+				tile.shrinkFrames = 0;
+			}
+		}
+		else
+		{
+			tile.shrinkFrames = 0;
+		}
+
+		bPack = bPack || (sizes[light] != tile.requestedSize);
+	}
+
+	if (bPack == true)
+	{
+		PackTiles(sizes);
+	}
+
+	const UniformBufferManager::LIGHT_BLOCK& lights = m_pUniformBuffers->GetLightData();
+	for (int light = 0; light < TOTAL_LIGHTS; light++)
+	{
+		LIGHT_TILE& tile = m_tiles[light];
+		if (tile.size == 0)
+		{
+			m_pUniformBuffers->SetLightShadowTile(light, glm::mat4(1.0f), glm::vec4(0.0f));
+			continue;
+		}
+
+		// a perspective view from the light that just holds the
+		// sphere of its bounds
+		glm::vec3 position = lights.lightSources[light].position;
+		glm::vec3 toCenter = tile.boundsCenter - position;
+		float distance = glm::length(toCenter);
+		glm::vec3 direction = (distance > 0.0001f) ? (toCenter / distance) : glm::vec3(0.0f, -1.0f, 0.0f);
+		float sine = (distance > 0.0001f) ? glm::min(tile.boundsRadius / distance, g_MaxBoundsSine) : g_MaxBoundsSine;
+		float nearPlane = glm::max(distance - tile.boundsRadius, g_MinNearPlane);
+		float farPlane = glm::max(distance + tile.boundsRadius, nearPlane * 2.0f);
+		glm::vec3 up = (fabsf(direction.y) > 0.99f) ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+
+		glm::mat4 matrix =
+			glm::perspective(2.0f * asinf(sine), 1.0f, nearPlane, farPlane) *
+			glm::lookAt(position, position + direction, up);
+		if (matrix != tile.matrix)
+		{
+			tile.matrix = matrix;
+			tile.bDirty = true;
+		}
+
+		int row = 1 << tile.nodeLevel;
+		float scale = 1.0f / (float)m_size;
+		glm::vec4 rectangle(
+			(float)((tile.nodeIndex % row) * tile.size) * scale,
+			(float)((tile.nodeIndex / row) * tile.size) * scale,
+			(float)tile.size * scale,
+			(float)tile.size * scale);
+		m_pUniformBuffers->SetLightShadowTile(light, tile.matrix, rectangle);
+	}
+}
+
+/***********************************************************
+ *  UpdateCasters()
+ *
+ *  This method is used to compare the casters inside the
+ *  tile of a light with the casters it was drawn with.
+ ***********************************************************/
+bool ShadowAtlas::UpdateCasters(
+	int light,
+	const ShadowManager::SHADOW_CASTER* casters,
+	size_t count)
+{
+	if ((light < 0) || (light >= TOTAL_LIGHTS) || (m_tiles[light].size == 0))
+	{
+		return(false);
+	}
+
+	LIGHT_TILE& tile = m_tiles[light];
+	bool bChanged = ShadowManager::CastersChanged(tile.casters, casters, count);
+
+	if (bChanged == true)
+	{
+		tile.casters.assign(casters, casters + count);
+		tile.bDirty = true;
+	}
+
+	return(bChanged);
+}
+
+/***********************************************************
+ *  BeginAtlasPass()
+ *
+ *  This method is used to bind the framebuffer of the atlas
+ *  when any tile has to be drawn.  The scissor test keeps
+ *  the clears of a tile inside of it.
+ ***********************************************************/
+bool ShadowAtlas::BeginAtlasPass()
+{
+	bool bDraw = false;
+	for (int light = 0; light < TOTAL_LIGHTS; light++)
+	{
+		if (m_tiles[light].size == 0)
+		{
+			continue;
+		}
+		if (m_tiles[light].bDirty == true)
+		{
+			bDraw = true;
+			m_renderedTiles++;
+		}
+		else
+		{
+			m_reusedTiles++;
+		}
+	}
+
+	if ((bDraw == false) || (m_depthMapFBO == 0))
+	{
+		return(false);
+	}
+
+	glGetIntegerv(GL_VIEWPORT, m_savedViewport);
+	glBindFramebuffer(GL_FRAMEBUFFER, m_depthMapFBO);
+	glEnable(GL_SCISSOR_TEST);
+	return(true);
+}
+
+/***********************************************************
+ *  BeginTile()
+ *
+ *  This method is used to draw into the tile of a light, if
+ *  it has to be drawn in this pass.
+ ***********************************************************/
+bool ShadowAtlas::BeginTile(int light)
+{
+	if ((light < 0) || (light >= TOTAL_LIGHTS))
+	{
+		return(false);
+	}
+
+	LIGHT_TILE& tile = m_tiles[light];
+	if ((tile.size == 0) || (tile.bDirty == false))
+	{
+		return(false);
+	}
+
+	int row = 1 << tile.nodeLevel;
+	GLint x = (tile.nodeIndex % row) * tile.size;
+	GLint y = (tile.nodeIndex / row) * tile.size;
+	glViewport(x, y, tile.size, tile.size);
+	glScissor(x, y, tile.size, tile.size);
+	glClear(GL_DEPTH_BUFFER_BIT);
+
+	tile.bDirty = false;
+	return(true);
+}
+
+/***********************************************************
+ *  EndAtlasPass()
+ *
+ *  This method is used to go back to the default
+ *  framebuffer once the tiles have been drawn.
+ ***********************************************************/
+void ShadowAtlas::EndAtlasPass()
+{
+	glDisable(GL_SCISSOR_TEST);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	glViewport(m_savedViewport[0], m_savedViewport[1], m_savedViewport[2], m_savedViewport[3]);
+}
+
+/***********************************************************
+ *  RequestTileSize()
+ *
+ *  This method is used to find the edge of the tile a light
+ *  asks for.  It follows the part of the screen height its
+ *  bounds cover, scaled by the brightest channel of its
+ *  diffuse color, so a dim light far from the camera gets
+ *  the smallest tile and one without diffuse color none.
+ ***********************************************************/
+GLsizei ShadowAtlas::RequestTileSize(int light) const
+{
+	const LIGHT_TILE& tile = m_tiles[light];
+	if (tile.boundsRadius <= 0.0f)
+	{
+		return(0);
+	}
+
+	const UniformBufferManager::LIGHT_SOURCE& source = m_pUniformBuffers->GetLightData().lightSources[light];
+	float intensity = glm::min(glm::max(source.diffuseColor.r, glm::max(source.diffuseColor.g, source.diffuseColor.b)), 1.0f);
+	if (intensity <= 0.0f)
+	{
+		return(0);
+	}
+
+	// the height of the bounds on the screen, as a part of the
+	// screen - the whole screen when the camera is inside them
+	const UniformBufferManager::CAMERA_BLOCK& camera = m_pUniformBuffers->GetCameraData();
+	float depth = -(camera.view * glm::vec4(tile.boundsCenter, 1.0f)).z;
+	float coverage = 1.0f;
+	if (depth < -tile.boundsRadius)
+	{
+		coverage = 0.0f;
+	}
+	else if (depth > tile.boundsRadius)
+	{
+		coverage = tile.boundsRadius * camera.projection[1][1] /
+			sqrtf(depth * depth - tile.boundsRadius * tile.boundsRadius);
+		coverage = glm::min(coverage, 1.0f);
+	}
+
+	float edge = (float)m_maxTileSize * coverage * intensity;
+	GLsizei size = m_minTileSize;
+	while ((size < m_maxTileSize) && ((float)size < edge))
+	{
+		size *= 2;
+	}
+	return(size);
+}
+
+/***********************************************************
+ *  PackTiles()
+ *
+ *  This method is used to place the tiles whose edge has
+ *  changed, the largest first.  When they do not fit, all
+ *  of the tiles are placed again, after the largest ones
+ *  are halved until the tiles cover no more than the atlas
+ *  - power of two squares placed largest first then always
+ *  fit.  Every tile that moves is drawn again.
+ ***********************************************************/
+void ShadowAtlas::PackTiles(const GLsizei* sizes)
+{
+	GLsizei edges[TOTAL_LIGHTS];
+	bool bPlace[TOTAL_LIGHTS];
+	for (int light = 0; light < TOTAL_LIGHTS; light++)
+	{
+		edges[light] = sizes[light];
+		bPlace[light] = (sizes[light] != m_tiles[light].requestedSize);
+		if (bPlace[light] == true)
+		{
+			ReleaseTile(light);
+			m_tiles[light].requestedSize = sizes[light];
+		}
+	}
+
+	if (PlaceTiles(edges, bPlace) == true)
+	{
+		return;
+	}
+
+	// make room by halving the largest tiles, and leave out the
+	// last lights when even the smallest tiles do not fit
+	double atlasArea = (double)m_size * (double)m_size;
+	for (;;)
+	{
+		double area = 0.0;
+		int largest = -1;
+		int last = -1;
+		for (int light = 0; light < TOTAL_LIGHTS; light++)
+		{
+			area += (double)edges[light] * (double)edges[light];
+			if ((edges[light] > 0) && ((largest < 0) || (edges[light] > edges[largest])))
+			{
+				largest = light;
+			}
+			if (edges[light] > 0)
+			{
+				last = light;
+			}
+		}
+		if (area <= atlasArea)
+		{
+			break;
+		}
+
+		if (edges[largest] > m_minTileSize)
+		{
+			edges[largest] /= 2;
+		}
+		else
+		{
+			edges[last] = 0;
+		}
+	}
+
+	for (int light = 0; light < TOTAL_LIGHTS; light++)
+	{
+		ReleaseTile(light);
+		bPlace[light] = true;
+	}
+	PlaceTiles(edges, bPlace);
+}
+
+/***********************************************************
+ *  PlaceTiles()
+ *
+ *  This method is used to take a node for each of the
+ *  lights that are marked, the largest tile first.  It
+ *  stops at the first tile that does not fit.
+ ***********************************************************/
+bool ShadowAtlas::PlaceTiles(
+	const GLsizei* edges,
+	const bool* bPlace)
+{
+	// the lights to place, the largest tile first
+	int order[TOTAL_LIGHTS];
+	int nOrder = 0;
+	for (int light = 0; light < TOTAL_LIGHTS; light++)
+	{
+		if ((bPlace[light] == false) || (edges[light] == 0))
+		{
+			continue;
+		}
+		int slot = nOrder++;
+		while ((slot > 0) && (edges[order[slot - 1]] < edges[light]))
+		{
+			order[slot] = order[slot - 1];
+			slot--;
+		}
+		order[slot] = light;
+	}
+
+	for (int i = 0; i < nOrder; i++)
+	{
+		LIGHT_TILE& tile = m_tiles[order[i]];
+		GLsizei size = edges[order[i]];
+
+		int level = 0;
+		while ((m_size >> level) > size)
+		{
+			level++;
+		}
+		int index = AllocateNode(level);
+		if (index < 0)
+		{
+			return(false);
+		}
+
+		tile.size = size;
+		tile.nodeLevel = level;
+		tile.nodeIndex = index;
+		tile.bDirty = true;
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  AllocateNode()
+ *
+ *  This method is used to take a free node of a level,
+ *  splitting the free nodes above it.  The search goes
+ *  through the split nodes first in the order of their
+ *  children, so that the tiles are packed into one corner.
+ ***********************************************************/
+int ShadowAtlas::AllocateNode(int level)
+{
+	if ((level < 0) || (level >= m_levels))
+	{
+		return(-1);
+	}
+	return(AllocateNode(0, 0, level));
+}
+
+int ShadowAtlas::AllocateNode(
+	int level,
+	int index,
+	int targetLevel)
+{
+	uint8_t& state = m_nodes[LevelOffset(level) + index];
+	if (state == node_used)
+	{
+		return(-1);
+	}
+	if (level == targetLevel)
+	{
+		if (state == node_split)
+		{
+			return(-1);
+		}
+		state = node_used;
+		return(index);
+	}
+
+	bool bWasFree = (state == node_free);
+	state = node_split;
+
+	int row = 1 << level;
+	int x = index % row;
+	int y = index / row;
+	for (int child = 0; child < 4; child++)
+	{
+		int childIndex = (y * 2 + child / 2) * (row * 2) + (x * 2 + child % 2);
+		int found = AllocateNode(level + 1, childIndex, targetLevel);
+		if (found >= 0)
+		{
+			return(found);
+		}
+	}
+
+	// nothing was taken below a node that was free
+	if (bWasFree == true)
+	{
+		state = node_free;
+	}
+	return(-1);
+}
+
+/***********************************************************
+ *  FreeNode()
+ *
+ *  This method is used to give a node back.  Its parent is
+ *  free again once all four of its children are, and so on
+ *  up the tree.
+ ***********************************************************/
+void ShadowAtlas::FreeNode(
+	int level,
+	int index)
+{
+	m_nodes[LevelOffset(level) + index] = node_free;
+
+	while (level > 0)
+	{
+		int row = 1 << level;
+		int x = (index % row) & ~1;
+		int y = (index / row) & ~1;
+
+		bool bSiblingsFree = true;
+		for (int child = 0; child < 4; child++)
+		{
+			int sibling = (y + child / 2) * row + (x + child % 2);
+			bSiblingsFree = bSiblingsFree && (m_nodes[LevelOffset(level) + sibling] == node_free);
+		}
+		if (bSiblingsFree == false)
+		{
+			break;
+		}
+
+		level--;
+		index = (y / 2) * (row / 2) + (x / 2);
+		m_nodes[LevelOffset(level) + index] = node_free;
+	}
+}
+
+/***********************************************************
+ *  LevelOffset()
+ *
+ *  This method is used to get the index of the first node
+ *  of a level, after the 4^l nodes of each level l above.
+ ***********************************************************/
+int ShadowAtlas::LevelOffset(int level)
+{
+	return(((1 << (2 * level)) - 1) / 3);
+}
+
+/***********************************************************
+ *  ReleaseTile()
+ *
+ *  This method is used to give the node of a light back to
+ *  the allocator.
+ ***********************************************************/
+void ShadowAtlas::ReleaseTile(int light)
+{
+	LIGHT_TILE& tile = m_tiles[light];
+	if ((tile.size > 0) && (tile.nodeIndex >= 0))
+	{
+		FreeNode(tile.nodeLevel, tile.nodeIndex);
+	}
+	tile.size = 0;
+	tile.nodeIndex = -1;
+	tile.bDirty = true;
+}
@@ -0,0 +1,171 @@
+///////////////////////////////////////////////////////////////////////////////
+// shadowatlas.h
+// ============
+// pack the shadow maps of the light sources into tiles of one depth texture,
+// sized by how much of the screen each light affects
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+#include <glm/glm.hpp>
+
+#include <stdint.h>
+#include <vector>
+
+#include "UniformBufferManager.h"
+#include "ShadowManager.h"
+
+/***********************************************************
+ *  ShadowAtlas
+ *
+ *  This class holds one square depth texture that is split
+ *  into power of two tiles by a quadtree allocator, and a
+ *  tile for each light source that casts shadows into it.
+ *  A light looks at the sphere it casts shadows into with a
+ *  perspective projection, and the size of its tile follows
+ *  the part of the screen the sphere covers and how bright
+ *  the light is.
+ *
+ *  The tile and matrix of each light are passed to the light
+ *  block, and a tile is only drawn again when its matrix,
+ *  its place in the atlas or the casters inside it change.
+ ***********************************************************/
+class ShadowAtlas
+{
+public:
+	// constructor
+	ShadowAtlas(UniformBufferManager* pUniformBuffers);
+	// destructor
+	~ShadowAtlas();
+
+	// create the depth texture of size x size and its framebuffer,
+	// with tiles from minTileSize to maxTileSize - all three are
+	// rounded to powers of two
+	bool CreateAtlas(
+		GLsizei size,
+		GLsizei minTileSize,
+		GLsizei maxTileSize);
+	// free the depth texture and framebuffer
+	void DestroyAtlas();
+
+	// set the sphere a light casts shadows into - a radius of 0
+	// leaves the light without a tile
+	void SetLightBounds(
+		int light,
+		const glm::vec3& center,
+		float radius);
+
+	// size the tiles from the camera block, pack them into the
+	// atlas and pass them to the light block
+	void UpdateTiles();
+
+	// whether a light has a tile in the atlas
+	bool HasTile(int light) const { return(m_tiles[light].size > 0); }
+	// matrix the tile of a light is drawn with
+	const glm::mat4& GetTileMatrix(int light) const { return(m_tiles[light].matrix); }
+
+	// compare the casters inside the tile of a light with the
+	// ones it was drawn with - returns whether they changed
+	bool UpdateCasters(
+		int light,
+		const ShadowManager::SHADOW_CASTER* casters,
+		size_t count);
+
+	// bind the framebuffer of the atlas - returns false when no
+	// tile has to be drawn
+	bool BeginAtlasPass();
+	// set the viewport to the tile of a light and clear it -
+	// returns false when the tile is not drawn in this pass
+	bool BeginTile(int light);
+	// restore the framebuffer and viewport of the frame
+	void EndAtlasPass();
+
+	GLuint GetDepthMap() const { return(m_depthMap); }
+	// number of tiles drawn and reused
+	unsigned int GetRenderedTiles() const { return(m_renderedTiles); }
+	unsigned int GetReusedTiles() const { return(m_reusedTiles); }
+
+private:
+	// state of a node of the allocator quadtree
+	enum NodeState
+	{
+		node_free,
+		node_split,
+		node_used
+	};
+
+	// tile of one light source
+	struct LIGHT_TILE
+	{
+		// sphere the light casts shadows into
+		glm::vec3 boundsCenter;
+		float boundsRadius;
+		// edge of the tile in texels, 0 without a tile, and the
+		// allocator node that holds it
+		GLsizei size;
+		int nodeLevel;
+		int nodeIndex;
+		// edge the tile would have at the screen influence, and
+		// the frames a smaller edge has been asked for
+		GLsizei requestedSize;
+		int shrinkFrames;
+		// matrix the tile is drawn with
+		glm::mat4 matrix;
+		// casters the tile was drawn with
+		std::vector<ShadowManager::SHADOW_CASTER> casters;
+		// set when the tile no longer matches the scene
+		bool bDirty;
+	};
+
+	// pointer to the shared uniform buffers
+	UniformBufferManager* m_pUniformBuffers;
+
+	GLuint m_depthMapFBO;
+	GLuint m_depthMap;
+	GLsizei m_size;
+	GLsizei m_minTileSize;
+	GLsizei m_maxTileSize;
+	// viewport of the frame while the atlas is drawn
+	GLint m_savedViewport[4];
+
+	// node states of the quadtree, level by level - the nodes of
+	// a level are stored in rows of 2^level
+	std::vector<uint8_t> m_nodes;
+	int m_levels;
+
+	LIGHT_TILE m_tiles[TOTAL_LIGHTS];
+
+	unsigned int m_renderedTiles;
+	unsigned int m_reusedTiles;
+
+	// edge of the tile a light asks for this frame
+	GLsizei RequestTileSize(int light) const;
+	// place the tiles whose edge changed, packing every tile
+	// again when they do not fit
+	void PackTiles(const GLsizei* sizes);
+	// place the marked tiles, largest first - returns false
+	// when one of them does not fit
+	bool PlaceTiles(
+		const GLsizei* edges,
+		const bool* bPlace);
+
+	// find and take a free node of a level, returning its index
+	// in the level or -1
+	int AllocateNode(int level);
+	int AllocateNode(
+		int level,
+		int index,
+		int targetLevel);
+	// give a node back, joining free siblings
+	void FreeNode(
+		int level,
+		int index);
+	// index of the first node of a level
+	static int LevelOffset(int level);
+	// free the tile of a light
+	void ReleaseTile(int light);
+};
@@ -0,0 +1,762 @@
+///////////////////////////////////////////////////////////////////////////////
+// shadowmanager.cpp
+// ============
+// own the cascaded shadow map of the scene light, fit the cascades to the
+// camera and redraw each cascade only when it is due and has changed
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "ShadowManager.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <math.h>
+#include <iostream>
+#include <string>
+
+// declaration of global variables
+namespace
+{
+	// blend between logarithmic and even split depths
+	const float g_SplitLambda = 0.75f;
+	// distance behind a cascade that casters are kept from,
+	// so that objects outside of the view still cast shadows
+	const float g_CasterDistance = 20.0f;
+	// step the cascade radius is rounded up to, so that its
+	// texel size stays the same while the camera turns
+	const float g_RadiusStep = 1.0f / 16.0f;
+	// frames between the updates of each cascade by default -
+	// the far cascades cover more of the scene at a lower
+	// resolution, so their lag is harder to see
+	const int g_UpdateIntervals[MAX_SHADOW_CASCADES] = { 1, 1, 2, 4 };
+
+	// compute shader that warps and blurs the EVSM moments
+	const char* g_MomentShaderName = "shadowMomentsCompShader.glsl";
+	// width and height of the work groups of the blur
+	const GLuint g_MomentGroupSize = 8;
+
+	// names and fragment shader defines of the filters, in the
+	// order of ShadowManager::ShadowFilter
+	const char* g_FilterNames[ShadowManager::filter_count] =
+	{
+		"hardware",
+		"pcf",
+		"pcss",
+		"evsm"
+	};
+	const char* g_FilterDefines[ShadowManager::filter_count] =
+	{
+		"#define SHADOW_FILTER_HARDWARE\n",
+		"#define SHADOW_FILTER_PCF\n",
+		"#define SHADOW_FILTER_PCSS\n",
+		"#define SHADOW_FILTER_EVSM\n"
+	};
+}
+
+/***********************************************************
+ *  ShadowManager()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+ShadowManager::ShadowManager(UniformBufferManager* pUniformBuffers)
+{
+	m_pUniformBuffers = pUniformBuffers;
+	m_depthMapFBO = 0;
+	m_depthMap = 0;
+	m_width = 0;
+	m_height = 0;
+	m_nCascades = 0;
+	m_drawMask = 0;
+	m_lightDirection = glm::vec3(0.0f, -1.0f, 0.0f);
+	m_shadowDistance = 40.0f;
+	m_renderedPasses = 0;
+	m_skippedPasses = 0;
+	m_compareSampler = 0;
+	m_filter = filter_hardware;
+	m_blurMoments = 0;
+	m_momentMap = 0;
+	m_momentLevels = 0;
+	m_momentShader.m_programID = 0;
+
+	// the unit below the one of the GPU culler is left free by
+	// the scene textures
+	GLint textureUnits = 0;
+	glGetIntegerv(GL_MAX_COMBINED_TEXTURE_IMAGE_UNITS, &textureUnits);
+	m_filterTextureUnit = glm::max(textureUnits - 2, 0);
+
+	for (int i = 0; i < 4; i++)
+	{
+		m_savedViewport[i] = 0;
+	}
+
+	for (int i = 0; i < MAX_SHADOW_CASCADES; i++)
+	{
+		m_cascades[i].matrix = glm::mat4(1.0f);
+		m_cascades[i].splitDepth = 0.0f;
+		m_cascades[i].fittedMatrix = glm::mat4(1.0f);
+		m_cascades[i].fittedSplitDepth = 0.0f;
+		m_cascades[i].bDirty = true;
+		m_cascades[i].updateInterval = g_UpdateIntervals[i];
+		m_cascades[i].framesSinceUpdate = 0;
+	}
+}
+
+/***********************************************************
+ *  ~ShadowManager()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+ShadowManager::~ShadowManager()
+{
+	DestroyShadowMap();
+	if (m_momentShader.m_programID != 0)
+	{
+		glDeleteProgram(m_momentShader.m_programID);
+		m_momentShader.m_programID = 0;
+	}
+	m_pUniformBuffers = NULL;
+}
+
+/***********************************************************
+ *  GetFilterName()
+ *
+ *  This method is used to get the name of a filter.
+ ***********************************************************/
+const char* ShadowManager::GetFilterName(ShadowFilter filter)
+{
+	if ((filter < 0) || (filter >= filter_count))
+	{
+		return("");
+	}
+	return(g_FilterNames[filter]);
+}
+
+/***********************************************************
+ *  GetFilterDefines()
+ *
+ *  This method is used to get the defines that build the
+ *  fragment shader with a filter, to pass to LoadShaders().
+ ***********************************************************/
+const char* ShadowManager::GetFilterDefines(ShadowFilter filter)
+{
+	if ((filter < 0) || (filter >= filter_count))
+	{
+		return(NULL);
+	}
+	return(g_FilterDefines[filter]);
+}
+
+/***********************************************************
+ *  CreateShadowMap()
+ *
+ *  This method is used to create the depth texture array of
+ *  the cascades and the framebuffer they are drawn through,
+ *  with all of the layers attached so that one pass can
+ *  draw into any of them.  The area outside of a cascade
+ *  reads as the far plane, so it is never in shadow.
+ ***********************************************************/
+bool ShadowManager::CreateShadowMap(
+	GLsizei width,
+	GLsizei height,
+	int nCascades)
+{
+	DestroyShadowMap();
+
+	if (nCascades < 1)
+	{
+		nCascades = 1;
+	}
+	else if (nCascades > MAX_SHADOW_CASCADES)
+	{
+		nCascades = MAX_SHADOW_CASCADES;
+	}
+
+	m_width = width;
+	m_height = height;
+	m_nCascades = nCascades;
+
+	glGenTextures(1, &m_depthMap);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, m_depthMap);
+	glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_DEPTH_COMPONENT, width, height, nCascades, 0, GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
+	float borderColor[] = { 1.0f, 1.0f, 1.0f, 1.0f };
+	glTexParameterfv(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_BORDER_COLOR, borderColor);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+	// the compare sampler reads the same texture with the
+	// hardware compare and bilinear filtering of the results
+	glGenSamplers(1, &m_compareSampler);
+	glSamplerParameteri(m_compareSampler, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glSamplerParameteri(m_compareSampler, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glSamplerParameteri(m_compareSampler, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
+	glSamplerParameteri(m_compareSampler, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
+	glSamplerParameterfv(m_compareSampler, GL_TEXTURE_BORDER_COLOR, borderColor);
+	glSamplerParameteri(m_compareSampler, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+	glSamplerParameteri(m_compareSampler, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+
+	// attach every layer of the depth texture to the framebuffer
+	glGenFramebuffers(1, &m_depthMapFBO);
+	glBindFramebuffer(GL_FRAMEBUFFER, m_depthMapFBO);
+	glFramebufferTexture(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, m_depthMap, 0);
+	glDrawBuffer(GL_NONE);
+	glReadBuffer(GL_NONE);
+
+	bool bComplete = (glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+	if (bComplete == false)
+	{
+		std::cout << "ERROR: shadow map framebuffer is not complete" << std::endl;
+		DestroyShadowMap();
+		return(false);
+	}
+
+	if (m_filter == filter_evsm)
+	{
+		CreateMomentMaps();
+	}
+
+	Invalidate();
+	return(true);
+}
+
+/***********************************************************
+ *  DestroyShadowMap()
+ *
+ *  This method is used to free the depth texture array and
+ *  the framebuffer of the shadow map.
+ ***********************************************************/
+void ShadowManager::DestroyShadowMap()
+{
+	if (m_depthMapFBO != 0)
+	{
+		glDeleteFramebuffers(1, &m_depthMapFBO);
+		m_depthMapFBO = 0;
+	}
+	if (m_depthMap != 0)
+	{
+		glDeleteTextures(1, &m_depthMap);
+		m_depthMap = 0;
+	}
+	if (m_compareSampler != 0)
+	{
+		glDeleteSamplers(1, &m_compareSampler);
+		m_compareSampler = 0;
+	}
+	DestroyMomentMaps();
+	for (int i = 0; i < MAX_SHADOW_CASCADES; i++)
+	{
+		m_cascades[i].casters.clear();
+	}
+	m_nCascades = 0;
+}
+
+/***********************************************************
+ *  SetLightDirection()
+ *
+ *  This method is used to set the direction the light
+ *  shines in.  Every cascade is drawn again when it has
+ *  changed.
+ ***********************************************************/
+void ShadowManager::SetLightDirection(const glm::vec3& direction)
+{
+	glm::vec3 lightDirection = glm::normalize(direction);
+	if (lightDirection != m_lightDirection)
+	{
+		m_lightDirection = lightDirection;
+		Invalidate();
+	}
+}
+
+/***********************************************************
+ *  SetShadowDistance()
+ *
+ *  This method is used to set the view depth the last
+ *  cascade ends at.
+ ***********************************************************/
+void ShadowManager::SetShadowDistance(float distance)
+{
+	m_shadowDistance = distance;
+}
+
+/***********************************************************
+ *  SetCascadeUpdateInterval()
+ *
+ *  This method is used to set how many frames a cascade
+ *  waits between updates, 1 to update it every frame.
+ ***********************************************************/
+void ShadowManager::SetCascadeUpdateInterval(
+	int cascade,
+	int frames)
+{
+	if ((cascade < 0) || (cascade >= MAX_SHADOW_CASCADES))
+	{
+		return;
+	}
+	m_cascades[cascade].updateInterval = (frames < 1) ? 1 : frames;
+}
+
+/***********************************************************
+ *  Invalidate()
+ *
+ *  This method is used to mark every cascade to be drawn on
+ *  the next pass, whatever its update interval.
+ ***********************************************************/
+void ShadowManager::Invalidate()
+{
+	for (int i = 0; i < MAX_SHADOW_CASCADES; i++)
+	{
+		m_cascades[i].bDirty = true;
+		m_cascades[i].framesSinceUpdate = m_cascades[i].updateInterval;
+	}
+}
+
+/***********************************************************
+ *  LoadFilterShaders()
+ *
+ *  This method is used to load the compute shader that
+ *  builds the moments of the EVSM filter.  The other
+ *  filters read the depth map directly and need no shader.
+ ***********************************************************/
+bool ShadowManager::LoadFilterShaders(const char* shaderDirectory)
+{
+	std::string directory(shaderDirectory);
+
+	if (m_momentShader.m_programID != 0)
+	{
+		glDeleteProgram(m_momentShader.m_programID);
+		m_momentShader.m_programID = 0;
+	}
+	return(m_momentShader.LoadComputeShader((directory + g_MomentShaderName).c_str()) != 0);
+}
+
+/***********************************************************
+ *  SetFilter()
+ *
+ *  This method is used to select the filter of the shadow
+ *  lookups.  The moment textures only exist while the EVSM
+ *  filter is selected, and every cascade is drawn again so
+ *  that they are filled on the next pass.  The fragment
+ *  shader has to be built with the defines of the same
+ *  filter.
+ ***********************************************************/
+bool ShadowManager::SetFilter(ShadowFilter filter)
+{
+	if ((filter < 0) || (filter >= filter_count))
+	{
+		return(false);
+	}
+	if ((filter == filter_evsm) && (m_momentShader.m_programID == 0))
+	{
+		std::cout << "ERROR: the EVSM shadow filter needs " << g_MomentShaderName << std::endl;
+		return(false);
+	}
+
+	m_filter = filter;
+	if ((m_filter == filter_evsm) && (m_depthMap != 0))
+	{
+		CreateMomentMaps();
+	}
+	else
+	{
+		DestroyMomentMaps();
+	}
+
+	Invalidate();
+	return(true);
+}
+
+/***********************************************************
+ *  UpdateCascades()
+ *
+ *  This method is used to fit the cascades to the camera.
+ *  The view volume up to the shadow distance is split at
+ *  depths between an even and a logarithmic spacing, and
+ *  each cascade is the light's view of the sphere around
+ *  its slice.  The sphere does not change size while the
+ *  camera turns, and the matrix is moved by less than a
+ *  texel so that the world origin falls on a texel corner,
+ *  which keeps the texels fixed in the world.
+ ***********************************************************/
+void ShadowManager::UpdateCascades()
+{
+	if ((NULL == m_pUniformBuffers) || (m_nCascades == 0))
+	{
+		return;
+	}
+
+	const UniformBufferManager::CAMERA_BLOCK& camera = m_pUniformBuffers->GetCameraData();
+	glm::mat4 inverseProjection = glm::inverse(camera.projection);
+	glm::mat4 inverseView = glm::inverse(camera.view);
+
+	// corners of the view volume in view space, on the near
+	// and far planes
+	glm::vec3 nearCorners[4];
+	glm::vec3 farCorners[4];
+	for (int i = 0; i < 4; i++)
+	{
+		float x = ((i & 1) != 0) ? 1.0f : -1.0f;
+		float y = ((i & 2) != 0) ? 1.0f : -1.0f;
+		glm::vec4 nearCorner = inverseProjection * glm::vec4(x, y, -1.0f, 1.0f);
+		glm::vec4 farCorner = inverseProjection * glm::vec4(x, y, 1.0f, 1.0f);
+		nearCorners[i] = glm::vec3(nearCorner) / nearCorner.w;
+		farCorners[i] = glm::vec3(farCorner) / farCorner.w;
+	}
+	float nearDepth = -nearCorners[0].z;
+	float farDepth = -farCorners[0].z;
+	if (nearDepth < 0.001f)
+	{
+		nearDepth = 0.001f;
+	}
+	float shadowDepth = (farDepth < m_shadowDistance) ? farDepth : m_shadowDistance;
+
+	// the same light rotation is used for every cascade
+	glm::vec3 up = (fabsf(m_lightDirection.y) > 0.99f) ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+	glm::mat4 lightRotation = glm::lookAt(glm::vec3(0.0f), m_lightDirection, up);
+	glm::vec3 boundsMin(1.0e30f);
+	glm::vec3 boundsMax(-1.0e30f);
+
+	float sliceStart = nearDepth;
+	for (int cascade = 0; cascade < m_nCascades; cascade++)
+	{
+		CASCADE& state = m_cascades[cascade];
+
+		float fraction = (float)(cascade + 1) / (float)m_nCascades;
+		float logSplit = nearDepth * powf(shadowDepth / nearDepth, fraction);
+		float evenSplit = nearDepth + (shadowDepth - nearDepth) * fraction;
+		float sliceEnd = g_SplitLambda * logSplit + (1.0f - g_SplitLambda) * evenSplit;
+
+		// world space corners of the slice - the view depth is
+		// linear along the edges of the view volume
+		glm::vec3 corners[8];
+		glm::vec3 center(0.0f);
+		float startBlend = (sliceStart - nearDepth) / (farDepth - nearDepth);
+		float endBlend = (sliceEnd - nearDepth) / (farDepth - nearDepth);
+		for (int i = 0; i < 4; i++)
+		{
+			corners[i] = glm::vec3(inverseView * glm::vec4(glm::mix(nearCorners[i], farCorners[i], startBlend), 1.0f));
+			corners[i + 4] = glm::vec3(inverseView * glm::vec4(glm::mix(nearCorners[i], farCorners[i], endBlend), 1.0f));
+		}
+		for (int i = 0; i < 8; i++)
+		{
+			center += corners[i];
+		}
+		center /= 8.0f;
+
+		float radius = 0.0f;
+		for (int i = 0; i < 8; i++)
+		{
+			float distance = glm::length(corners[i] - center);
+			radius = (distance > radius) ? distance : radius;
+		}
+		radius = ceilf(radius / g_RadiusStep) * g_RadiusStep;
+
+		float backDistance = radius + g_CasterDistance;
+		glm::mat4 lightView = glm::lookAt(center - m_lightDirection * backDistance, center, up);
+		glm::mat4 lightProjection = glm::ortho(-radius, radius, -radius, radius, 0.0f, backDistance + radius);
+
+		// move the cascade so that the world origin lands on a
+		// texel corner
+		glm::mat4 shadowMatrix = lightProjection * lightView;
+		glm::vec4 origin = shadowMatrix * glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+		glm::vec2 texelOrigin = glm::vec2(origin) * glm::vec2((float)m_width * 0.5f, (float)m_height * 0.5f);
+		glm::vec2 offset = (glm::round(texelOrigin) - texelOrigin) / glm::vec2((float)m_width * 0.5f, (float)m_height * 0.5f);
+		lightProjection[3][0] += offset.x;
+		lightProjection[3][1] += offset.y;
+
+		state.fittedMatrix = lightProjection * lightView;
+		state.fittedSplitDepth = sliceEnd;
+		if ((state.fittedMatrix != state.matrix) || (state.fittedSplitDepth != state.splitDepth))
+		{
+			state.bDirty = true;
+		}
+
+		// grow the box around all of the cascades, in the light
+		// rotation, by the snapping offset of up to one texel
+		glm::vec3 lightCenter = glm::vec3(lightRotation * glm::vec4(center, 1.0f));
+		float margin = radius * 2.0f / (float)((m_width < m_height) ? m_width : m_height);
+		float extent = radius + margin;
+		float centerDistance = glm::dot(center, m_lightDirection);
+		boundsMin = glm::min(boundsMin, glm::vec3(lightCenter.x - extent, lightCenter.y - extent, centerDistance - backDistance));
+		boundsMax = glm::max(boundsMax, glm::vec3(lightCenter.x + extent, lightCenter.y + extent, centerDistance + radius));
+
+		sliceStart = sliceEnd;
+	}
+
+	// the depth pass is culled against the box of all cascades
+	m_pUniformBuffers->SetLightSpaceMatrix(
+		glm::ortho(boundsMin.x, boundsMax.x, boundsMin.y, boundsMax.y, boundsMin.z, boundsMax.z) * lightRotation);
+}
+
+/***********************************************************
+ *  CastersChanged()
+ *
+ *  This method is used to compare the casters passed in
+ *  with the ones a shadow map was drawn with, in the order
+ *  they were recorded.  It is shared by the cascades, the
+ *  atlas tiles and the cube faces.
+ ***********************************************************/
+bool ShadowManager::CastersChanged(
+	const std::vector<SHADOW_CASTER>& cached,
+	const SHADOW_CASTER* casters,
+	size_t count)
+{
+	if (count != cached.size())
+	{
+		return(true);
+	}
+
+	for (size_t i = 0; i < count; i++)
+	{
+		if ((cached[i].meshID != casters[i].meshID) ||
+			(cached[i].meshParts != casters[i].meshParts) ||
+			(cached[i].lod != casters[i].lod) ||
+			(cached[i].model != casters[i].model))
+		{
+			return(true);
+		}
+	}
+
+	return(false);
+}
+
+/***********************************************************
+ *  UpdateCasters()
+ *
+ *  This method is used to compare the casters inside a
+ *  cascade with the casters of its cached layer.  A caster
+ *  that moves outside of the cascade is not passed in, so
+ *  it leaves the layer untouched, while one that moves into
+ *  or out of the cascade changes the list.
+ ***********************************************************/
+bool ShadowManager::UpdateCasters(
+	int cascade,
+	const SHADOW_CASTER* casters,
+	size_t count)
+{
+	if ((cascade < 0) || (cascade >= m_nCascades))
+	{
+		return(false);
+	}
+
+	CASCADE& state = m_cascades[cascade];
+	bool bChanged = CastersChanged(state.casters, casters, count);
+
+	if (bChanged == true)
+	{
+		state.casters.assign(casters, casters + count);
+		state.bDirty = true;
+	}
+
+	return(bChanged);
+}
+
+/***********************************************************
+ *  BeginShadowPass()
+ *
+ *  This method is used to pick the cascades that are drawn
+ *  in this frame - the ones that changed and have waited
+ *  for their update interval - and to clear their layers.
+ *  The cascades that are not drawn keep the matrix their
+ *  layer was drawn with, so the lookups stay correct.
+ ***********************************************************/
+bool ShadowManager::BeginShadowPass()
+{
+	m_drawMask = 0;
+	for (int cascade = 0; cascade < m_nCascades; cascade++)
+	{
+		CASCADE& state = m_cascades[cascade];
+		state.framesSinceUpdate++;
+
+		if ((state.bDirty == true) && (state.framesSinceUpdate >= state.updateInterval))
+		{
+			m_drawMask |= 1 << cascade;
+			state.matrix = state.fittedMatrix;
+			state.splitDepth = state.fittedSplitDepth;
+			state.bDirty = false;
+			state.framesSinceUpdate = 0;
+		}
+	}
+
+	if ((m_drawMask == 0) || (m_depthMapFBO == 0))
+	{
+		m_skippedPasses++;
+		return(false);
+	}
+
+	UploadCascades();
+
+	glGetIntegerv(GL_VIEWPORT, m_savedViewport);
+	glViewport(0, 0, m_width, m_height);
+	glBindFramebuffer(GL_FRAMEBUFFER, m_depthMapFBO);
+
+	// clear the drawn layers one at a time, then attach all of
+	// the layers again for the layered draws
+	for (int cascade = 0; cascade < m_nCascades; cascade++)
+	{
+		if ((m_drawMask & (1 << cascade)) != 0)
+		{
+			glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, m_depthMap, 0, cascade);
+			glClear(GL_DEPTH_BUFFER_BIT);
+		}
+	}
+	glFramebufferTexture(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, m_depthMap, 0);
+
+	return(true);
+}
+
+/***********************************************************
+ *  EndShadowPass()
+ *
+ *  This method is used to go back to the default
+ *  framebuffer once the cascades have been drawn.
+ ***********************************************************/
+void ShadowManager::EndShadowPass()
+{
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	glViewport(m_savedViewport[0], m_savedViewport[1], m_savedViewport[2], m_savedViewport[3]);
+
+	if (m_filter == filter_evsm)
+	{
+		FilterMoments(m_drawMask);
+	}
+
+	m_drawMask = 0;
+	m_renderedPasses++;
+}
+
+/***********************************************************
+ *  UploadCascades()
+ *
+ *  This method is used to pass the matrices and split
+ *  depths of the drawn layers to the camera block, which
+ *  is uploaded right away for the layered pass.
+ ***********************************************************/
+void ShadowManager::UploadCascades()
+{
+	if (NULL == m_pUniformBuffers)
+	{
+		return;
+	}
+
+	glm::mat4 matrices[MAX_SHADOW_CASCADES];
+	float splits[MAX_SHADOW_CASCADES];
+	for (int cascade = 0; cascade < m_nCascades; cascade++)
+	{
+		matrices[cascade] = m_cascades[cascade].matrix;
+		splits[cascade] = m_cascades[cascade].splitDepth;
+	}
+
+	m_pUniformBuffers->SetShadowCascades(matrices, splits, m_nCascades);
+	m_pUniformBuffers->UploadChanges();
+}
+
+/***********************************************************
+ *  CreateMomentMaps()
+ *
+ *  This method is used to create the two moment texture
+ *  arrays of the EVSM filter, the same size as the depth
+ *  map.  The final moments have mipmaps so that the far
+ *  away lookups are filtered as well.
+ ***********************************************************/
+void ShadowManager::CreateMomentMaps()
+{
+	DestroyMomentMaps();
+
+	m_momentLevels = 1;
+	for (GLsizei size = glm::max(m_width, m_height); size > 1; size /= 2)
+	{
+		m_momentLevels++;
+	}
+
+	glGenTextures(1, &m_blurMoments);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, m_blurMoments);
+	glTexStorage3D(GL_TEXTURE_2D_ARRAY, 1, GL_RGBA32F, m_width, m_height, m_nCascades);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+	glGenTextures(1, &m_momentMap);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, m_momentMap);
+	glTexStorage3D(GL_TEXTURE_2D_ARRAY, m_momentLevels, GL_RGBA32F, m_width, m_height, m_nCascades);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+}
+
+/***********************************************************
+ *  DestroyMomentMaps()
+ *
+ *  This method is used to free the moment textures.
+ ***********************************************************/
+void ShadowManager::DestroyMomentMaps()
+{
+	if (m_blurMoments != 0)
+	{
+		glDeleteTextures(1, &m_blurMoments);
+		m_blurMoments = 0;
+	}
+	if (m_momentMap != 0)
+	{
+		glDeleteTextures(1, &m_momentMap);
+		m_momentMap = 0;
+	}
+	m_momentLevels = 0;
+}
+
+/***********************************************************
+ *  FilterMoments()
+ *
+ *  This method is used to build the moments of the drawn
+ *  cascades.  The first pass warps the depths and blurs
+ *  them along x, the second blurs the result along y into
+ *  the moment map, and its mipmaps are then built from the
+ *  blurred moments.  Each pass covers every layer in one
+ *  dispatch, and the shader skips the layers that were not
+ *  drawn.
+ ***********************************************************/
+void ShadowManager::FilterMoments(int cascadeMask)
+{
+	if ((cascadeMask == 0) || (m_momentMap == 0) || (m_momentShader.m_programID == 0))
+	{
+		return;
+	}
+
+	GLuint groupsX = (m_width + g_MomentGroupSize - 1) / g_MomentGroupSize;
+	GLuint groupsY = (m_height + g_MomentGroupSize - 1) / g_MomentGroupSize;
+
+	// the depths are read as plain values, so no sampler
+	// object is left bound to the unit
+	glActiveTexture(GL_TEXTURE0 + m_filterTextureUnit);
+	glBindSampler(m_filterTextureUnit, 0);
+
+	m_momentShader.use();
+	m_momentShader.setSampler2DValue("depthMap", m_filterTextureUnit);
+	m_momentShader.setSampler2DValue("sourceMoments", m_filterTextureUnit);
+	m_momentShader.setIntValue("layerMask", cascadeMask);
+
+	// warp the depths and blur them along x
+	glBindTexture(GL_TEXTURE_2D_ARRAY, m_depthMap);
+	glBindImageTexture(0, m_blurMoments, 0, GL_TRUE, 0, GL_WRITE_ONLY, GL_RGBA32F);
+	m_momentShader.setIntValue("blurPass", 0);
+	glDispatchCompute(groupsX, groupsY, m_nCascades);
+	glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+
+	// blur the moments along y
+	glBindTexture(GL_TEXTURE_2D_ARRAY, m_blurMoments);
+	glBindImageTexture(0, m_momentMap, 0, GL_TRUE, 0, GL_WRITE_ONLY, GL_RGBA32F);
+	m_momentShader.setIntValue("blurPass", 1);
+	glDispatchCompute(groupsX, groupsY, m_nCascades);
+	glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT | GL_TEXTURE_UPDATE_BARRIER_BIT);
+
+	glBindImageTexture(0, 0, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA32F);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, m_momentMap);
+	glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+	glActiveTexture(GL_TEXTURE0);
+}
@@ -0,0 +1,206 @@
+///////////////////////////////////////////////////////////////////////////////
+// shadowmanager.h
+// ============
+// own the cascaded shadow map of the scene light, fit the cascades to the
+// camera and redraw each cascade only when it is due and has changed
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+#include <glm/glm.hpp>
+
+#include <stdint.h>
+#include <vector>
+
+#include "UniformBufferManager.h"
+#include "ShaderManager.h"
+
+/***********************************************************
+ *  ShadowManager
+ *
+ *  This class holds the layered depth framebuffer of the
+ *  shadow cascades, one layer of a 2D array texture each.
+ *  The camera view volume, up to the shadow distance, is
+ *  split into slices and every cascade is fitted to one of
+ *  them, snapped to whole texels so that the shadows do
+ *  not shimmer while the camera moves.
+ *
+ *  Every frame the scene passes in the casters inside each
+ *  cascade, and a cascade is only drawn when its matrix or
+ *  its casters differ from the cached layer and its update
+ *  interval has passed.  All of the cascades that are drawn
+ *  in a frame share one layered pass.
+ *
+ *  The depths are read through a sampler object that turns
+ *  on the hardware depth compare, and for the EVSM filter
+ *  they are turned into exponential moments and blurred by
+ *  a compute shader after each pass.
+ ***********************************************************/
+class ShadowManager
+{
+public:
+	// constructor
+	ShadowManager(UniformBufferManager* pUniformBuffers);
+	// destructor
+	~ShadowManager();
+
+	// filters the shadow lookup can be built with - each one
+	// is a variant of the main fragment shader
+	enum ShadowFilter
+	{
+		filter_hardware,	// one compared lookup, 2x2 texels
+		filter_pcf,			// Poisson disk of compared lookups
+		filter_pcss,		// PCF sized by the blocker distance
+		filter_evsm,		// blurred exponential variance moments
+		filter_count
+	};
+
+	// name of a filter, as used on the command line
+	static const char* GetFilterName(ShadowFilter filter);
+	// defines that select a filter in the fragment shader
+	static const char* GetFilterDefines(ShadowFilter filter);
+
+	// everything about a caster that changes its depth
+	struct SHADOW_CASTER
+	{
+		glm::mat4 model;
+		uint16_t meshID;
+		uint16_t meshParts;
+		uint32_t lod;
+	};
+
+	// create the depth texture array and the framebuffer of
+	// the cascades, with one layer of width x height for each
+	bool CreateShadowMap(
+		GLsizei width,
+		GLsizei height,
+		int nCascades);
+	// free the depth texture array and framebuffer
+	void DestroyShadowMap();
+
+	// set the direction the light shines in
+	void SetLightDirection(const glm::vec3& direction);
+	// set how far from the camera the cascades reach
+	void SetShadowDistance(float distance);
+	// set how many frames a cascade waits between updates
+	void SetCascadeUpdateInterval(
+		int cascade,
+		int frames);
+	// force every cascade to be drawn on the next pass
+	void Invalidate();
+
+	// load the compute shader that builds the EVSM moments
+	// from a directory, which has to end with a path separator
+	bool LoadFilterShaders(const char* shaderDirectory);
+	// select the filter - returns false, keeping the current
+	// filter, when it needs a shader that is not loaded
+	bool SetFilter(ShadowFilter filter);
+	ShadowFilter GetFilter() const { return(m_filter); }
+
+	// fit the cascades to the view volume of the camera block -
+	// the light space matrix of the camera block is set to the
+	// box around all of the cascades, for culling the pass
+	void UpdateCascades();
+
+	int GetCascadeCount() const { return(m_nCascades); }
+	// matrix a cascade is fitted with in this frame
+	const glm::mat4& GetCascadeMatrix(int cascade) const { return(m_cascades[cascade].fittedMatrix); }
+
+	// compare a list of casters with the one a shadow map was
+	// drawn with - returns whether a caster was added, removed
+	// or changed its depth
+	static bool CastersChanged(
+		const std::vector<SHADOW_CASTER>& cached,
+		const SHADOW_CASTER* casters,
+		size_t count);
+	// compare the casters inside a cascade with the ones its
+	// layer was drawn with - returns whether they changed
+	bool UpdateCasters(
+		int cascade,
+		const SHADOW_CASTER* casters,
+		size_t count);
+
+	// bind the framebuffer and clear the layers of the cascades
+	// that are drawn in this frame - returns false, and counts
+	// the pass as skipped, when no cascade has to be drawn
+	bool BeginShadowPass();
+	// restore the framebuffer and viewport of the frame
+	void EndShadowPass();
+	// bit for each cascade drawn in the current pass
+	int GetDrawMask() const { return(m_drawMask); }
+
+	GLuint GetDepthMap() const { return(m_depthMap); }
+	// sampler object that reads the depth map with the
+	// hardware depth compare
+	GLuint GetCompareSampler() const { return(m_compareSampler); }
+	// blurred moments of the cascades, 0 unless the filter
+	// is filter_evsm
+	GLuint GetMomentMap() const { return(m_momentMap); }
+	// number of shadow passes drawn and reused
+	unsigned int GetRenderedPasses() const { return(m_renderedPasses); }
+	unsigned int GetSkippedPasses() const { return(m_skippedPasses); }
+
+private:
+	// state of one cascade
+	struct CASCADE
+	{
+		// matrix and split depth the layer was drawn with
+		glm::mat4 matrix;
+		float splitDepth;
+		// matrix and split depth fitted to the camera this frame
+		glm::mat4 fittedMatrix;
+		float fittedSplitDepth;
+		// casters the layer was drawn with
+		std::vector<SHADOW_CASTER> casters;
+		// set when the layer no longer matches the scene
+		bool bDirty;
+		// frames to wait between updates, and frames waited
+		int updateInterval;
+		int framesSinceUpdate;
+	};
+
+	// pointer to the shared uniform buffers
+	UniformBufferManager* m_pUniformBuffers;
+
+	GLuint m_depthMapFBO;
+	GLuint m_depthMap;
+	GLsizei m_width;
+	GLsizei m_height;
+	// viewport of the frame while the shadow pass is drawn
+	GLint m_savedViewport[4];
+	GLuint m_compareSampler;
+
+	// filter of the lookups, and the moments of the cascades
+	// for the EVSM filter, before and after the second blur
+	ShadowFilter m_filter;
+	GLuint m_blurMoments;
+	GLuint m_momentMap;
+	GLint m_momentLevels;
+	ShaderManager m_momentShader;
+	// texture unit the compute shader reads through, kept
+	// clear of the units of the scene textures
+	GLint m_filterTextureUnit;
+
+	CASCADE m_cascades[MAX_SHADOW_CASCADES];
+	int m_nCascades;
+	// cascades drawn in the current pass
+	int m_drawMask;
+
+	glm::vec3 m_lightDirection;
+	float m_shadowDistance;
+
+	unsigned int m_renderedPasses;
+	unsigned int m_skippedPasses;
+
+	// pass the drawn cascade matrices to the camera block
+	void UploadCascades();
+	// create or free the moment textures of the EVSM filter
+	void CreateMomentMaps();
+	void DestroyMomentMaps();
+	// build the blurred moments of the cascades in a mask
+	void FilterMoments(int cascadeMask);
+};
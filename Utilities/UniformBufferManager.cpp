@@ -0,0 +1,350 @@
+///////////////////////////////////////////////////////////////////////////////
+// uniformbuffermanager.cpp
+// ============
+// manage the std140 uniform buffer objects that hold the camera, light and
+// material data shared by all of the shader programs
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "UniformBufferManager.h"
+
+#include <string.h>
+
+// the C++ mirrors must match the std140 block layouts exactly
+static_assert(sizeof(UniformBufferManager::CAMERA_BLOCK) == 480, "CameraBlock layout");
+static_assert(sizeof(UniformBufferManager::LIGHT_SOURCE) == 144, "LightSource layout");
+static_assert(sizeof(UniformBufferManager::MATERIAL_BLOCK) == 48, "MaterialBlock layout");
+
+// declaration of global variables
+namespace
+{
+	const char* g_CameraBlockName = "CameraBlock";
+	const char* g_LightBlockName = "LightBlock";
+	const char* g_MaterialBlockName = "MaterialBlock";
+}
+
+/***********************************************************
+ *  UniformBufferManager()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+UniformBufferManager::UniformBufferManager()
+{
+	m_cameraBuffer = 0;
+	m_lightBuffer = 0;
+	m_materialBuffer = 0;
+	memset(&m_cameraData, 0, sizeof(m_cameraData));
+	memset(&m_lightData, 0, sizeof(m_lightData));
+	m_bCameraDirty = true;
+	m_bLightsDirty = true;
+	m_bMaterialsDirty = false;
+	m_materialStride = sizeof(MATERIAL_BLOCK);
+	m_boundMaterial = -1;
+}
+
+/***********************************************************
+ *  ~UniformBufferManager()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+UniformBufferManager::~UniformBufferManager()
+{
+	DestroyUniformBuffers();
+}
+
+/***********************************************************
+ *  CreateUniformBuffers()
+ *
+ *  This method is used to create the uniform buffer objects
+ *  and attach them to their binding points.  The material
+ *  table is attached per draw with BindMaterial().
+ ***********************************************************/
+void UniformBufferManager::CreateUniformBuffers()
+{
+	GLint offsetAlignment = 0;
+
+	// every material slot has to start on an aligned offset
+	// so that it can be bound as a buffer range
+	glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &offsetAlignment);
+	if (offsetAlignment > 0)
+	{
+		m_materialStride = ((sizeof(MATERIAL_BLOCK) + offsetAlignment - 1) / offsetAlignment) * offsetAlignment;
+	}
+
+	glGenBuffers(1, &m_cameraBuffer);
+	glBindBuffer(GL_UNIFORM_BUFFER, m_cameraBuffer);
+	glBufferData(GL_UNIFORM_BUFFER, sizeof(CAMERA_BLOCK), NULL, GL_DYNAMIC_DRAW);
+	glBindBufferBase(GL_UNIFORM_BUFFER, camera_block, m_cameraBuffer);
+
+	glGenBuffers(1, &m_lightBuffer);
+	glBindBuffer(GL_UNIFORM_BUFFER, m_lightBuffer);
+	glBufferData(GL_UNIFORM_BUFFER, sizeof(LIGHT_BLOCK), NULL, GL_DYNAMIC_DRAW);
+	glBindBufferBase(GL_UNIFORM_BUFFER, light_block, m_lightBuffer);
+
+	glGenBuffers(1, &m_materialBuffer);
+	glBindBuffer(GL_UNIFORM_BUFFER, m_materialBuffer);
+	glBufferData(GL_UNIFORM_BUFFER, m_materialStride * MAX_MATERIALS, NULL, GL_STATIC_DRAW);
+
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+	m_bCameraDirty = true;
+	m_bLightsDirty = true;
+	m_bMaterialsDirty = (m_materials.size() > 0);
+	m_boundMaterial = -1;
+}
+
+/***********************************************************
+ *  DestroyUniformBuffers()
+ *
+ *  This method is used to free the uniform buffer objects.
+ ***********************************************************/
+void UniformBufferManager::DestroyUniformBuffers()
+{
+	if (m_cameraBuffer != 0)
+	{
+		glDeleteBuffers(1, &m_cameraBuffer);
+		m_cameraBuffer = 0;
+	}
+	if (m_lightBuffer != 0)
+	{
+		glDeleteBuffers(1, &m_lightBuffer);
+		m_lightBuffer = 0;
+	}
+	if (m_materialBuffer != 0)
+	{
+		glDeleteBuffers(1, &m_materialBuffer);
+		m_materialBuffer = 0;
+	}
+}
+
+/***********************************************************
+ *  BindUniformBlocks()
+ *
+ *  This method is used to connect the uniform blocks that
+ *  are declared in a linked program to the shared binding
+ *  points.  Blocks the program does not use are skipped.
+ ***********************************************************/
+void UniformBufferManager::BindUniformBlocks(ShaderManager* pShaderManager)
+{
+	if (NULL == pShaderManager)
+	{
+		return;
+	}
+
+	pShaderManager->BindUniformBlock(g_CameraBlockName, camera_block);
+	pShaderManager->BindUniformBlock(g_LightBlockName, light_block);
+	pShaderManager->BindUniformBlock(g_MaterialBlockName, material_block);
+}
+
+/***********************************************************
+ *  SetCameraView()
+ *
+ *  This method is used to set the camera values for the
+ *  current frame.
+ ***********************************************************/
+void UniformBufferManager::SetCameraView(
+	const glm::mat4& view,
+	const glm::mat4& projection,
+	const glm::vec3& viewPosition)
+{
+	m_cameraData.view = view;
+	m_cameraData.projection = projection;
+	m_cameraData.viewPosition = glm::vec4(viewPosition, 1.0f);
+	m_bCameraDirty = true;
+}
+
+/***********************************************************
+ *  SetLightSpaceMatrix()
+ *
+ *  This method is used to set the matrix used by the depth
+ *  pass and the shadow lookup.
+ ***********************************************************/
+void UniformBufferManager::SetLightSpaceMatrix(const glm::mat4& lightSpaceMatrix)
+{
+	m_cameraData.lightSpaceMatrix = lightSpaceMatrix;
+	m_bCameraDirty = true;
+}
+
+/***********************************************************
+ *  SetShadowCascades()
+ *
+ *  This method is used to set the matrix and the far split
+ *  depth of each shadow cascade.  The cascades that are not
+ *  used get a split depth of 0, so no fragment selects them.
+ ***********************************************************/
+void UniformBufferManager::SetShadowCascades(
+	const glm::mat4* cascadeMatrices,
+	const float* cascadeSplits,
+	int nCascades)
+{
+	for (int i = 0; i < MAX_SHADOW_CASCADES; i++)
+	{
+		if (i < nCascades)
+		{
+			m_cameraData.cascadeMatrices[i] = cascadeMatrices[i];
+			m_cameraData.cascadeSplits[i] = cascadeSplits[i];
+		}
+		else
+		{
+			m_cameraData.cascadeMatrices[i] = glm::mat4(1.0f);
+			m_cameraData.cascadeSplits[i] = 0.0f;
+		}
+	}
+	m_bCameraDirty = true;
+}
+
+/***********************************************************
+ *  SetLightSource()
+ *
+ *  This method is used to set the values of one light source
+ *  in the light block.  The shadow tile and cube are set by
+ *  the shadow atlas and the point shadow maps, so the ones
+ *  of the light are kept.
+ ***********************************************************/
+void UniformBufferManager::SetLightSource(int index, const LIGHT_SOURCE& light)
+{
+	if ((index < 0) || (index >= TOTAL_LIGHTS))
+	{
+		return;
+	}
+
+	LIGHT_SOURCE& source = m_lightData.lightSources[index];
+	glm::mat4 shadowMatrix = source.shadowMatrix;
+	glm::vec4 shadowTile = source.shadowTile;
+	float shadowCube = source.shadowCube;
+	float shadowRadius = source.shadowRadius;
+	source = light;
+	source.shadowMatrix = shadowMatrix;
+	source.shadowTile = shadowTile;
+	source.shadowCube = shadowCube;
+	source.shadowRadius = shadowRadius;
+	m_bLightsDirty = true;
+}
+
+/***********************************************************
+ *  SetLightShadowTile()
+ *
+ *  This method is used to set the matrix and the atlas tile
+ *  of the shadow of one light source.
+ ***********************************************************/
+void UniformBufferManager::SetLightShadowTile(
+	int index,
+	const glm::mat4& shadowMatrix,
+	const glm::vec4& shadowTile)
+{
+	if ((index < 0) || (index >= TOTAL_LIGHTS))
+	{
+		return;
+	}
+
+	LIGHT_SOURCE& source = m_lightData.lightSources[index];
+	if ((source.shadowMatrix != shadowMatrix) || (source.shadowTile != shadowTile))
+	{
+		source.shadowMatrix = shadowMatrix;
+		source.shadowTile = shadowTile;
+		m_bLightsDirty = true;
+	}
+}
+
+/***********************************************************
+ *  SetLightShadowCube()
+ *
+ *  This method is used to set the cube and the reach of the
+ *  point shadow of one light source.
+ ***********************************************************/
+void UniformBufferManager::SetLightShadowCube(
+	int index,
+	float shadowCube,
+	float shadowRadius)
+{
+	if ((index < 0) || (index >= TOTAL_LIGHTS))
+	{
+		return;
+	}
+
+	LIGHT_SOURCE& source = m_lightData.lightSources[index];
+	if ((source.shadowCube != shadowCube) || (source.shadowRadius != shadowRadius))
+	{
+		source.shadowCube = shadowCube;
+		source.shadowRadius = shadowRadius;
+		m_bLightsDirty = true;
+	}
+}
+
+/***********************************************************
+ *  AddMaterial()
+ *
+ *  This method is used to add a material to the material
+ *  table.  The returned slot is passed to BindMaterial().
+ ***********************************************************/
+int UniformBufferManager::AddMaterial(const MATERIAL_BLOCK& material)
+{
+	if (m_materials.size() >= MAX_MATERIALS)
+	{
+		std::cout << "Material table is full, " << MAX_MATERIALS << " materials are supported" << std::endl;
+		return(-1);
+	}
+
+	m_materials.push_back(material);
+	m_bMaterialsDirty = true;
+
+	return((int)m_materials.size() - 1);
+}
+
+/***********************************************************
+ *  BindMaterial()
+ *
+ *  This method is used to select the material for the next
+ *  draw commands by binding its slot of the material table.
+ ***********************************************************/
+void UniformBufferManager::BindMaterial(int index)
+{
+	if ((index < 0) || (index >= (int)m_materials.size()) || (index == m_boundMaterial))
+	{
+		return;
+	}
+
+	glBindBufferRange(GL_UNIFORM_BUFFER, material_block, m_materialBuffer,
+		index * m_materialStride, sizeof(MATERIAL_BLOCK));
+	m_boundMaterial = index;
+}
+
+/***********************************************************
+ *  UploadChanges()
+ *
+ *  This method is called once per frame to upload the block
+ *  data that has changed since the last upload.
+ ***********************************************************/
+void UniformBufferManager::UploadChanges()
+{
+	if (m_bCameraDirty == true)
+	{
+		glBindBuffer(GL_UNIFORM_BUFFER, m_cameraBuffer);
+		glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(CAMERA_BLOCK), &m_cameraData);
+		m_bCameraDirty = false;
+	}
+
+	if (m_bLightsDirty == true)
+	{
+		glBindBuffer(GL_UNIFORM_BUFFER, m_lightBuffer);
+		glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(LIGHT_BLOCK), &m_lightData);
+		m_bLightsDirty = false;
+	}
+
+	if (m_bMaterialsDirty == true)
+	{
+		// lay the materials out on aligned slots
+		std::vector<unsigned char> slots(m_materialStride * m_materials.size(), 0);
+		for (size_t i = 0; i < m_materials.size(); i++)
+		{
+			memcpy(&slots[i * m_materialStride], &m_materials[i], sizeof(MATERIAL_BLOCK));
+		}
+
+		glBindBuffer(GL_UNIFORM_BUFFER, m_materialBuffer);
+		glBufferSubData(GL_UNIFORM_BUFFER, 0, slots.size(), slots.data());
+		m_bMaterialsDirty = false;
+	}
+
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
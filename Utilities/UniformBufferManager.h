@@ -0,0 +1,172 @@
+///////////////////////////////////////////////////////////////////////////////
+// uniformbuffermanager.h
+// ============
+// manage the std140 uniform buffer objects that hold the camera, light and
+// material data shared by all of the shader programs
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>        // GLEW library
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+#include "ShaderManager.h"
+
+// number of light sources in the light block - must match
+// TOTAL_LIGHTS in the fragment shaders
+#define TOTAL_LIGHTS 4
+// number of material slots in the material table
+#define MAX_MATERIALS 32
+// number of shadow cascades in the camera block - must match
+// MAX_CASCADES in the shaders
+#define MAX_SHADOW_CASCADES 4
+
+/***********************************************************
+ *  UniformBufferManager
+ *
+ *  This class owns the uniform buffer objects that are bound
+ *  to the same binding points in every shader program.  The
+ *  CPU copies are uploaded once per frame, and only when
+ *  they have changed.
+ ***********************************************************/
+class UniformBufferManager
+{
+public:
+	// constructor
+	UniformBufferManager();
+	// destructor
+	~UniformBufferManager();
+
+	// binding points used by every shader program
+	enum BlockBinding
+	{
+		camera_block = 0,
+		light_block = 1,
+		material_block = 2
+	};
+
+	// std140 layout of the CameraBlock uniform block
+	struct CAMERA_BLOCK
+	{
+		glm::mat4 view;
+		glm::mat4 projection;
+		glm::mat4 lightSpaceMatrix;
+		glm::vec4 viewPosition;
+		glm::mat4 cascadeMatrices[MAX_SHADOW_CASCADES];
+		// view depth where each cascade ends, 0 for unused cascades
+		glm::vec4 cascadeSplits;
+	};
+
+	// std140 layout of one LightSource in the LightBlock
+	struct LIGHT_SOURCE
+	{
+		glm::vec3 position;
+		float focalStrength;
+		glm::vec3 ambientColor;
+		float specularIntensity;
+		glm::vec3 diffuseColor;
+		// cube of the light in the point shadow cube array, and
+		// the distance its shadows reach - 0 without a cube
+		float shadowCube;
+		glm::vec3 specularColor;
+		float shadowRadius;
+		// matrix into the shadow tile of the light, and the tile
+		// in the shadow atlas as x, y, width and height in texture
+		// coordinates - the width is 0 when the light has no tile
+		glm::mat4 shadowMatrix;
+		glm::vec4 shadowTile;
+	};
+
+	// std140 layout of the LightBlock uniform block
+	struct LIGHT_BLOCK
+	{
+		LIGHT_SOURCE lightSources[TOTAL_LIGHTS];
+	};
+
+	// std140 layout of the MaterialBlock uniform block
+	struct MATERIAL_BLOCK
+	{
+		glm::vec3 ambientColor;
+		float ambientStrength;
+		glm::vec3 diffuseColor;
+		float shininess;
+		glm::vec3 specularColor;
+		float padding0;
+	};
+
+private:
+	// handles for the uniform buffer objects
+	GLuint m_cameraBuffer;
+	GLuint m_lightBuffer;
+	GLuint m_materialBuffer;
+
+	// CPU copies of the block data
+	CAMERA_BLOCK m_cameraData;
+	LIGHT_BLOCK m_lightData;
+	std::vector<MATERIAL_BLOCK> m_materials;
+
+	// flags for the blocks that need to be uploaded
+	bool m_bCameraDirty;
+	bool m_bLightsDirty;
+	bool m_bMaterialsDirty;
+
+	// distance in bytes between material slots, rounded up
+	// to the uniform buffer offset alignment
+	GLsizeiptr m_materialStride;
+	// material slot currently bound to the material binding
+	int m_boundMaterial;
+
+public:
+	// create the uniform buffer objects - needs a current GL context
+	void CreateUniformBuffers();
+	// free the uniform buffer objects
+	void DestroyUniformBuffers();
+
+	// connect the uniform blocks of a linked program to the
+	// shared binding points
+	void BindUniformBlocks(ShaderManager* pShaderManager);
+
+	// set the per-frame camera values
+	void SetCameraView(
+		const glm::mat4& view,
+		const glm::mat4& projection,
+		const glm::vec3& viewPosition);
+	// set the matrix that transforms world space into light space
+	void SetLightSpaceMatrix(const glm::mat4& lightSpaceMatrix);
+	// set the matrices and split depths of the shadow cascades
+	void SetShadowCascades(
+		const glm::mat4* cascadeMatrices,
+		const float* cascadeSplits,
+		int nCascades);
+	// get the current camera values
+	const CAMERA_BLOCK& GetCameraData() const { return(m_cameraData); }
+
+	// set the values of one light source - the shadow tile of
+	// the light is kept
+	void SetLightSource(int index, const LIGHT_SOURCE& light);
+	// set the shadow tile of one light source
+	void SetLightShadowTile(
+		int index,
+		const glm::mat4& shadowMatrix,
+		const glm::vec4& shadowTile);
+	// set the point shadow cube of one light source
+	void SetLightShadowCube(
+		int index,
+		float shadowCube,
+		float shadowRadius);
+	// get the current light values
+	const LIGHT_BLOCK& GetLightData() const { return(m_lightData); }
+
+	// add a material to the material table and return its slot
+	int AddMaterial(const MATERIAL_BLOCK& material);
+	// bind the material slot used by the next draw commands
+	void BindMaterial(int index);
+
+	// upload the blocks that have changed since the last upload
+	void UploadChanges();
+};
@@ -0,0 +1,119 @@
+#version 430 core
+
+// threads in each work group - must match g_AssignGroupSize
+// in LightClusters.cpp
+#define GROUP_SIZE 64
+// most lights one cluster keeps - the ones earliest in the
+// light list are kept
+#define MAX_CLUSTER_LIGHTS 128
+// number of shadow cascades - must match MAX_SHADOW_CASCADES
+// in UniformBufferManager.h
+#define MAX_CASCADES 4
+
+layout (local_size_x = GROUP_SIZE) in;
+
+// std430 mirror of LightClusters::LOCAL_LIGHT
+struct LocalLight
+{
+   vec3 position;
+   float radius;
+   vec3 color;
+   float specularIntensity;
+};
+
+layout (std140) uniform CameraBlock
+{
+   mat4 view;
+   mat4 projection;
+   mat4 lightSpaceMatrix;
+   vec4 viewPosition;
+   mat4 cascadeMatrices[MAX_CASCADES];
+   vec4 cascadeSplits;
+};
+
+layout (std430, binding = 8) readonly buffer LocalLights
+{
+   LocalLight localLights[];
+};
+// clusters along x, y and z and the number of lights, then
+// the offset and count of the light indices of each cluster
+layout (std430, binding = 9) buffer ClusterGrid
+{
+   uvec4 gridSize;
+   vec4 gridScale;
+   uint indexCount;
+   uint maxIndices;
+   uvec2 clusterRanges[];
+};
+// view space min and max corner of each cluster
+layout (std430, binding = 10) readonly buffer ClusterBounds
+{
+   vec4 clusterBounds[];
+};
+layout (std430, binding = 11) writeonly buffer LightIndices
+{
+   uint lightIndices[];
+};
+
+// view space spheres of the lights the group is testing
+shared vec4 batchLights[GROUP_SIZE];
+
+void main()
+{
+   uint cluster = gl_GlobalInvocationID.x;
+   uint clusterCount = gridSize.x * gridSize.y * gridSize.z;
+   uint lightCount = gridSize.w;
+   bool bCluster = cluster < clusterCount;
+
+   vec3 boundsMin = vec3(0.0);
+   vec3 boundsMax = vec3(0.0);
+   if(bCluster)
+   {
+      boundsMin = clusterBounds[cluster * 2u].xyz;
+      boundsMax = clusterBounds[cluster * 2u + 1u].xyz;
+   }
+
+   uint found[MAX_CLUSTER_LIGHTS];
+   uint count = 0u;
+
+   // every thread of the group moves one light into view space,
+   // then each one tests its cluster against the whole batch
+   for(uint first = 0u; first < lightCount; first += GROUP_SIZE)
+   {
+      uint light = first + gl_LocalInvocationIndex;
+      if(light < lightCount)
+      {
+         LocalLight source = localLights[light];
+         batchLights[gl_LocalInvocationIndex] = vec4((view * vec4(source.position, 1.0)).xyz, source.radius);
+      }
+      barrier();
+
+      uint batchCount = min(uint(GROUP_SIZE), lightCount - first);
+      for(uint i = 0u; bCluster && (i < batchCount) && (count < MAX_CLUSTER_LIGHTS); i++)
+      {
+         vec4 sphere = batchLights[i];
+         vec3 offset = clamp(sphere.xyz, boundsMin, boundsMax) - sphere.xyz;
+         if(dot(offset, offset) <= sphere.w * sphere.w)
+         {
+            found[count] = first + i;
+            count++;
+         }
+      }
+      barrier();
+   }
+
+   if(!bCluster)
+   {
+      return;
+   }
+
+   // a cluster that does not fit in the index buffer keeps the
+   // part of its list that does
+   uint offset = atomicAdd(indexCount, count);
+   count = (offset >= maxIndices) ? 0u : min(count, maxIndices - offset);
+   for(uint i = 0u; i < count; i++)
+   {
+      lightIndices[offset + i] = found[i];
+   }
+   clusterRanges[cluster] = uvec2(offset, count);
+}
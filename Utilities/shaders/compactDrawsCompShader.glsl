@@ -0,0 +1,53 @@
+#version 430 core
+layout (local_size_x = 64) in;
+
+// DrawElementsIndirectCommand, five values per command
+layout (std430, binding = 3) readonly buffer Commands
+{
+   uint commands[];
+};
+layout (std430, binding = 4) readonly buffer VisibleCounts
+{
+   uint visibleCounts[];
+};
+// batch of each command (x) and the first command of that batch (y)
+layout (std430, binding = 5) readonly buffer CommandBatches
+{
+   uvec2 commandBatches[];
+};
+layout (std430, binding = 6) writeonly buffer CulledCommands
+{
+   uint culledCommands[];
+};
+layout (std430, binding = 7) buffer DrawCounts
+{
+   uint drawCounts[];
+};
+
+uniform int commandCount;
+
+void main()
+{
+   uint command = gl_GlobalInvocationID.x;
+   if(command >= uint(commandCount))
+   {
+      return;
+   }
+
+   uint visible = visibleCounts[command];
+   if(visible == 0u)
+   {
+      return;
+   }
+
+   // append the command to the commands of its batch, with
+   // only its visible instances
+   uvec2 batch = commandBatches[command];
+   uint target = (batch.y + atomicAdd(drawCounts[batch.x], 1u)) * 5u;
+   uint source = command * 5u;
+   culledCommands[target] = commands[source];
+   culledCommands[target + 1u] = visible;
+   culledCommands[target + 2u] = commands[source + 2u];
+   culledCommands[target + 3u] = commands[source + 3u];
+   culledCommands[target + 4u] = commands[source + 4u];
+}
@@ -0,0 +1,144 @@
+#version 430 core
+layout (local_size_x = 64) in;
+
+// box of an instance and the index of its draw command
+struct InstanceBounds
+{
+   vec3 center;
+   uint command;
+   vec3 extent;
+   uint padding;
+};
+
+// instances in sorted order, read as floats since the
+// instance layout is not padded like a std430 struct
+layout (std430, binding = 0) readonly buffer SourceInstances
+{
+   float sourceInstances[];
+};
+layout (std430, binding = 1) writeonly buffer CulledInstances
+{
+   float culledInstances[];
+};
+layout (std430, binding = 2) readonly buffer Bounds
+{
+   InstanceBounds bounds[];
+};
+// DrawElementsIndirectCommand, five values per command
+layout (std430, binding = 3) readonly buffer Commands
+{
+   uint commands[];
+};
+layout (std430, binding = 4) buffer VisibleCounts
+{
+   uint visibleCounts[];
+};
+
+uniform int instanceCount;
+uniform int instanceFloats;
+// planes of the view volume, normals pointing inside
+uniform vec4 frustumPlanes[6];
+
+// farthest depths of the last frame and the matrix they
+// were drawn with
+uniform bool bOcclusion = false;
+uniform sampler2D depthPyramid;
+uniform int pyramidLevels;
+uniform mat4 pyramidViewProjection;
+
+const uint NO_COMMAND = 0xFFFFFFFFu;
+// boxes this large are never culled
+const float UNBOUNDED_EXTENT = 1.0e20;
+
+bool IsInFrustum(vec3 center, vec3 extent)
+{
+   for(int plane = 0; plane < 6; plane++)
+   {
+      float distance = dot(frustumPlanes[plane].xyz, center) + frustumPlanes[plane].w;
+      float radius = dot(abs(frustumPlanes[plane].xyz), extent);
+      if(distance + radius < 0.0)
+      {
+         return false;
+      }
+   }
+   return true;
+}
+
+bool IsOccluded(vec3 center, vec3 extent)
+{
+   if(any(greaterThan(extent, vec3(UNBOUNDED_EXTENT))))
+   {
+      return false;
+   }
+
+   vec2 minimum = vec2(1.0);
+   vec2 maximum = vec2(0.0);
+   float nearest = 1.0;
+   for(int corner = 0; corner < 8; corner++)
+   {
+      vec3 signs = vec3((corner & 1) != 0 ? 1.0 : -1.0, (corner & 2) != 0 ? 1.0 : -1.0, (corner & 4) != 0 ? 1.0 : -1.0);
+      vec4 clip = pyramidViewProjection * vec4(center + extent * signs, 1.0);
+      // boxes that reach behind the camera are kept
+      if((clip.w <= 1.0e-5) || (clip.z < -clip.w))
+      {
+         return false;
+      }
+      vec3 ndc = clip.xyz / clip.w;
+      minimum = min(minimum, ndc.xy * 0.5 + 0.5);
+      maximum = max(maximum, ndc.xy * 0.5 + 0.5);
+      nearest = min(nearest, ndc.z * 0.5 + 0.5);
+   }
+   minimum = clamp(minimum, vec2(0.0), vec2(1.0));
+   maximum = clamp(maximum, vec2(0.0), vec2(1.0));
+
+   // the level where the box covers at most 2x2 texels
+   int level = 0;
+   ivec2 size = textureSize(depthPyramid, 0);
+   ivec2 first = min(ivec2(minimum * vec2(size)), size - 1);
+   ivec2 last = min(ivec2(maximum * vec2(size)), size - 1);
+   while((level + 1 < pyramidLevels) && any(greaterThan(last - first, ivec2(1))))
+   {
+      level++;
+      size = textureSize(depthPyramid, level);
+      first = min(ivec2(minimum * vec2(size)), size - 1);
+      last = min(ivec2(maximum * vec2(size)), size - 1);
+   }
+
+   float farthest = max(
+      max(texelFetch(depthPyramid, first, level).r, texelFetch(depthPyramid, ivec2(last.x, first.y), level).r),
+      max(texelFetch(depthPyramid, ivec2(first.x, last.y), level).r, texelFetch(depthPyramid, last, level).r));
+
+   return nearest > farthest;
+}
+
+void main()
+{
+   uint instance = gl_GlobalInvocationID.x;
+   if(instance >= uint(instanceCount))
+   {
+      return;
+   }
+
+   uint command = bounds[instance].command;
+   if(command == NO_COMMAND)
+   {
+      return;
+   }
+
+   vec3 center = bounds[instance].center;
+   vec3 extent = bounds[instance].extent;
+   if(!IsInFrustum(center, extent) || (bOcclusion && IsOccluded(center, extent)))
+   {
+      return;
+   }
+
+   // move the instance to the next free slot of its command,
+   // starting at the base instance of the command
+   uint slot = atomicAdd(visibleCounts[command], 1u);
+   uint source = instance * uint(instanceFloats);
+   uint target = (commands[command * 5u + 4u] + slot) * uint(instanceFloats);
+   for(int value = 0; value < instanceFloats; value++)
+   {
+      culledInstances[target + uint(value)] = sourceInstances[source + uint(value)];
+   }
+}
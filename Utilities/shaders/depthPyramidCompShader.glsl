@@ -0,0 +1,34 @@
+#version 430 core
+layout (local_size_x = 8, local_size_y = 8) in;
+
+// the depth buffer copy or the previous level of the pyramid
+uniform sampler2D sourceDepth;
+uniform int sourceLevel;
+layout (r32f, binding = 0) uniform writeonly image2D targetLevel;
+
+void main()
+{
+   ivec2 target = ivec2(gl_GlobalInvocationID.xy);
+   ivec2 targetSize = imageSize(targetLevel);
+   if(any(greaterThanEqual(target, targetSize)))
+   {
+      return;
+   }
+
+   // the source texels under the target texel - three along
+   // a side when the source size is odd, so no texel is missed
+   ivec2 sourceSize = textureSize(sourceDepth, sourceLevel);
+   ivec2 first = (target * sourceSize) / targetSize;
+   ivec2 last = max(first, ((target + 1) * sourceSize + targetSize - 1) / targetSize - 1);
+
+   float farthest = 0.0;
+   for(int y = first.y; y <= last.y; y++)
+   {
+      for(int x = first.x; x <= last.x; x++)
+      {
+         farthest = max(farthest, texelFetch(sourceDepth, ivec2(x, y), sourceLevel).r);
+      }
+   }
+
+   imageStore(targetLevel, target, vec4(farthest));
+}
@@ -1,47 +1,166 @@
-#version 330 core
+#version 430 core
 
+// member order follows the std140 packing of the C++ mirrors
+// in UniformBufferManager.h
 struct Material 
 {
     vec3 ambientColor;
     float ambientStrength;
     vec3 diffuseColor;
-    vec3 specularColor;
     float shininess;
+    vec3 specularColor;
 }; 
 
 struct LightSource 
 {
     vec3 position;	
+    float focalStrength;
     vec3 ambientColor;
+    float specularIntensity;
     vec3 diffuseColor;
+    // cube of the light in the point shadow cubes, and the
+    // distance its shadows reach - 0 without a cube
+    float shadowCube;
     vec3 specularColor;
-    float focalStrength;
+    float shadowRadius;
+    // matrix into the shadow atlas tile of the light, and the
+    // tile as x, y, width and height - 0 width without a tile
+    mat4 shadowMatrix;
+    vec4 shadowTile;
+};
+
+// std430 mirror of LightClusters::LOCAL_LIGHT
+struct LocalLight
+{
+    vec3 position;
+    float radius;
+    vec3 color;
     float specularIntensity;
 };
 
 #define TOTAL_LIGHTS 4
+// number of shadow cascades - must match MAX_SHADOW_CASCADES
+// in UniformBufferManager.h
+#define MAX_CASCADES 4
+// light that the shadow cascades are drawn from
+#define SHADOW_LIGHT 0
+// near plane of the faces of the point shadow cubes - must
+// match g_NearPlane in PointShadowMaps.cpp
+#define OMNI_NEAR_PLANE 0.05
+
+// shadow filter of the variant, defined when the program is
+// loaded - one hardware compared lookup when none is defined
+#if !defined(SHADOW_FILTER_PCF) && !defined(SHADOW_FILTER_PCSS) && !defined(SHADOW_FILTER_EVSM)
+#define SHADOW_FILTER_HARDWARE
+#endif
+// radius of the Poisson PCF in texels
+#define PCF_RADIUS 1.5
+// size of the light for PCSS, as a fraction of a cascade,
+// the penumbra in texels for a unit of depth between the
+// caster and the receiver, and the largest penumbra
+#define PCSS_LIGHT_SIZE 0.01
+#define PCSS_PENUMBRA_SCALE 400.0
+#define PCSS_MAX_RADIUS 8.0
+// exponents of the EVSM warp - must match the moment shader
+#define EVSM_POSITIVE_EXPONENT 40.0
+#define EVSM_NEGATIVE_EXPONENT 5.0
+// fraction of the lit range that is cut off to hide the
+// light bleeding of variance shadows
+#define EVSM_BLEED_REDUCTION 0.3
 
 in vec3 fragmentPosition;
 in vec3 fragmentVertexNormal;
 in vec2 fragmentTextureCoordinate;
 in vec4 fragmentPosLightSpace;
+in vec4 fragmentObjectColor;
 
 out vec4 outFragmentColor;
 
+// the features are fixed in a shader variant, as in the
+// vertex shader
+#ifdef SHADER_VARIANT
+#ifdef FEATURE_TEXTURE
+const bool bUseTexture = true;
+#else
+const bool bUseTexture = false;
+#endif
+#ifdef FEATURE_LIGHTING
+const bool bUseLighting = true;
+#else
+const bool bUseLighting = false;
+#endif
+#ifdef FEATURE_BLINN
+const bool blinn = true;
+#else
+const bool blinn = false;
+#endif
+#else
 uniform bool bUseTexture=false;
 uniform bool bUseLighting=false;
-uniform vec4 objectColor = vec4(1.0f);
-uniform sampler2D objectTexture;
-uniform sampler2D depthMap;
-uniform vec3 viewPosition;
-uniform vec2 UVscale = vec2(1.0f, 1.0f);
-uniform LightSource lightSources[TOTAL_LIGHTS];
-uniform Material material;
 uniform bool blinn;
+#endif
+uniform sampler2D objectTexture;
+// one layer for each shadow cascade - the depths are read
+// directly, through the hardware depth compare, or as the
+// filtered moments of the EVSM variant
+uniform sampler2DArray depthMap;
+uniform sampler2DArrayShadow shadowMap;
+uniform sampler2DArray momentMap;
+// tiles of the shadows of the other lights, read through the
+// hardware depth compare
+uniform sampler2DShadow shadowAtlas;
+// depth cubes of the point lights, read through the hardware
+// depth compare
+uniform samplerCubeArrayShadow shadowCubes;
+
+// local lights, and the lists of the ones that reach each
+// cluster of the view volume - bindings follow ClusterBinding
+// in LightClusters.cpp
+layout (std430, binding = 8) readonly buffer LocalLights
+{
+   LocalLight localLights[];
+};
+layout (std430, binding = 9) readonly buffer ClusterGrid
+{
+   uvec4 gridSize;
+   vec4 gridScale;
+   uint indexCount;
+   uint maxIndices;
+   uvec2 clusterRanges[];
+};
+layout (std430, binding = 11) readonly buffer LightIndices
+{
+   uint lightIndices[];
+};
+
+layout (std140) uniform CameraBlock
+{
+   mat4 view;
+   mat4 projection;
+   mat4 lightSpaceMatrix;
+   vec4 viewPosition;
+   mat4 cascadeMatrices[MAX_CASCADES];
+   vec4 cascadeSplits;
+};
+
+layout (std140) uniform LightBlock
+{
+   LightSource lightSources[TOTAL_LIGHTS];
+};
+
+layout (std140) uniform MaterialBlock
+{
+   Material material;
+};
 
 // function prototypes
-vec3 CalcLightSource(LightSource light, vec3 lightNormal, vec3 vertexPosition, vec3 viewDirection);
-float CalcShadow(vec4 fragPosLightSpace);
+vec3 CalcLightSource(LightSource light, vec3 lightNormal, vec3 vertexPosition, vec3 viewDirection, float shadow);
+float CalcShadow(vec3 worldPosition, vec3 lightNormal);
+float FilterShadow(vec3 projCoords, float layer, float bias);
+float CalcAtlasShadow(LightSource light, vec3 worldPosition, vec3 lightNormal);
+float CalcCubeShadow(LightSource light, vec3 worldPosition, vec3 lightNormal);
+vec3 CalcClusterLights(vec3 lightNormal, vec3 vertexPosition, vec3 viewDirection);
+vec3 CalcLocalLight(LocalLight light, vec3 lightNormal, vec3 vertexPosition, vec3 viewDirection);
 
 void main()
 {
@@ -49,39 +168,48 @@ void main()
    {
       // properties
       vec3 lightNormal = normalize(fragmentVertexNormal);
-      vec3 viewDirection = normalize(viewPosition - fragmentPosition);
+      vec3 viewDirection = normalize(viewPosition.xyz - fragmentPosition);
       vec3 phongResult = vec3(0.0f);
+      float shadow = CalcShadow(fragmentPosition, lightNormal);
 
       for(int i = 0; i < TOTAL_LIGHTS; i++)
       {
-         phongResult += CalcLightSource(lightSources[i], lightNormal, fragmentPosition, viewDirection); 
+         float lightShadow = shadow;
+         if(i != SHADOW_LIGHT)
+         {
+            lightShadow = max(
+               CalcAtlasShadow(lightSources[i], fragmentPosition, lightNormal),
+               CalcCubeShadow(lightSources[i], fragmentPosition, lightNormal));
+         }
+         phongResult += CalcLightSource(lightSources[i], lightNormal, fragmentPosition, viewDirection, lightShadow); 
       }   
+      phongResult += CalcClusterLights(lightNormal, fragmentPosition, viewDirection);
     
       if(bUseTexture == true)
       {
-         vec4 textureColor = texture(objectTexture, fragmentTextureCoordinate * UVscale);
+         vec4 textureColor = texture(objectTexture, fragmentTextureCoordinate);
          outFragmentColor = vec4(phongResult * textureColor.xyz, 1.0);
       }
       else
       {
-         outFragmentColor = vec4(phongResult * objectColor.xyz, objectColor.w);
+         outFragmentColor = vec4(phongResult * fragmentObjectColor.xyz, fragmentObjectColor.w);
       }
    }
    else 
    {
       if(bUseTexture == true)
       {
-         outFragmentColor = texture(objectTexture, fragmentTextureCoordinate * UVscale);
+         outFragmentColor = texture(objectTexture, fragmentTextureCoordinate);
       }
       else
       {
-         outFragmentColor = objectColor;
+         outFragmentColor = fragmentObjectColor;
       }
    }
 }
 
 // calculates the color when using a directional light.
-vec3 CalcLightSource(LightSource light, vec3 lightNormal, vec3 vertexPosition, vec3 viewDirection)
+vec3 CalcLightSource(LightSource light, vec3 lightNormal, vec3 vertexPosition, vec3 viewDirection, float shadow)
 {
    vec3 ambient;
    vec3 diffuse;
@@ -124,24 +252,252 @@ vec3 CalcLightSource(LightSource light, vec3 lightNormal, vec3 vertexPosition, v
       //specular = (light.specularIntensity * material.shininess) * specularComponent * material.specularColor;
    }
 
-   // calculate shadow
-   //float shadow = CalcShadow(fragmentPosLightSpace);
+   // the shadow only hides the direct light
+   return(ambient + (1.0 - shadow) * (diffuse + specular));
+}
+
+// finds the cascade that covers the fragment and compares its
+// depth with the depth of the closest caster
+float CalcShadow(vec3 worldPosition, vec3 lightNormal)
+{
+   float viewDepth = -(view * vec4(worldPosition, 1.0)).z;
+   vec3 lightDirection = normalize(lightSources[SHADOW_LIGHT].position - worldPosition);
+   // slope scaled bias against shadow acne
+   float bias = max(0.002 * (1.0 - dot(lightNormal, lightDirection)), 0.0005);
+
+   for(int i = 0; i < MAX_CASCADES; i++)
+   {
+      if(viewDepth >= cascadeSplits[i])
+      {
+         continue;
+      }
+
+      // perform perspective divide and transform to [0,1] range
+      vec4 fragPosLightSpace = cascadeMatrices[i] * vec4(worldPosition, 1.0);
+      vec3 projCoords = (fragPosLightSpace.xyz / fragPosLightSpace.w) * 0.5 + 0.5;
+
+      // a cascade that has not been updated since the camera
+      // moved may not cover the fragment, so try the next one
+      if(any(lessThan(projCoords, vec3(0.0))) || any(greaterThan(projCoords, vec3(1.0))))
+      {
+         continue;
+      }
+
+      return FilterShadow(projCoords, float(i), bias);
+   }
+
+   return 0.0;
+}
+
+// offsets of the Poisson disk used by the PCF and PCSS filters
+const vec2 poissonDisk[16] = vec2[](
+   vec2(-0.94201624, -0.39906216), vec2(0.94558609, -0.76890725),
+   vec2(-0.09418410, -0.92938870), vec2(0.34495938, 0.29387760),
+   vec2(-0.91588581, 0.45771432), vec2(-0.81544232, -0.87912464),
+   vec2(-0.38277543, 0.27676845), vec2(0.97484398, 0.75648379),
+   vec2(0.44323325, -0.97511554), vec2(0.53742981, -0.47373420),
+   vec2(-0.26496911, -0.41893023), vec2(0.79197514, 0.19090188),
+   vec2(-0.24188840, 0.99706507), vec2(-0.81409955, 0.91437590),
+   vec2(0.19984126, 0.78641367), vec2(0.14383161, -0.14100790));
+
+// rotation of the disk for each pixel, so that the taps
+// of neighbouring pixels do not band
+mat2 DiskRotation()
+{
+   float angle = 6.28318531 * fract(52.9829189 * fract(dot(gl_FragCoord.xy, vec2(0.06711056, 0.00583715))));
+   float s = sin(angle);
+   float c = cos(angle);
+   return mat2(c, s, -s, c);
+}
+
+// averages hardware compared lookups over a rotated disk -
+// every lookup already blends the 2x2 texels around it
+float PoissonPCF(vec3 projCoords, float layer, float bias, float radius)
+{
+   vec2 texelSize = 1.0 / vec2(textureSize(shadowMap, 0).xy);
+   mat2 rotation = DiskRotation();
+   float lit = 0.0;
+   for(int i = 0; i < 16; i++)
+   {
+      vec2 offset = rotation * poissonDisk[i] * radius * texelSize;
+      lit += texture(shadowMap, vec4(projCoords.xy + offset, layer, projCoords.z - bias));
+   }
+   return 1.0 - lit / 16.0;
+}
+
+// one tail of the Chebyshev bound of the warped depth
+float ChebyshevUpperBound(vec2 moments, float depth)
+{
+   if(depth <= moments.x)
+   {
+      return 1.0;
+   }
+   float variance = max(moments.y - moments.x * moments.x, 0.00001);
+   float distance = depth - moments.x;
+   float lit = variance / (variance + distance * distance);
+   return clamp((lit - EVSM_BLEED_REDUCTION) / (1.0 - EVSM_BLEED_REDUCTION), 0.0, 1.0);
+}
+
+// filters the shadow of a fragment with the filter of the
+// shader variant, returning 1 for full shadow
+float FilterShadow(vec3 projCoords, float layer, float bias)
+{
+#if defined(SHADOW_FILTER_PCF)
+   return PoissonPCF(projCoords, layer, bias, PCF_RADIUS);
+#elif defined(SHADOW_FILTER_PCSS)
+   // average the depth of the casters in front of the fragment
+   // over the area the light can be seen through
+   mat2 rotation = DiskRotation();
+   float searchRadius = PCSS_LIGHT_SIZE;
+   float blockerDepth = 0.0;
+   float blockers = 0.0;
+   for(int i = 0; i < 16; i++)
+   {
+      vec2 offset = rotation * poissonDisk[i] * searchRadius;
+      float depth = texture(depthMap, vec3(projCoords.xy + offset, layer)).r;
+      if(depth < projCoords.z - bias)
+      {
+         blockerDepth += depth;
+         blockers += 1.0;
+      }
+   }
+   if(blockers == 0.0)
+   {
+      return 0.0;
+   }
+   blockerDepth /= blockers;
+
+   // the light is directional, so the penumbra grows with the
+   // distance between the caster and the receiver
+   float penumbra = (projCoords.z - blockerDepth) * PCSS_PENUMBRA_SCALE;
+   return PoissonPCF(projCoords, layer, bias, clamp(penumbra, 1.0, PCSS_MAX_RADIUS));
+#elif defined(SHADOW_FILTER_EVSM)
+   // the moments are stored for a depth in [-1, 1], and the
+   // warp makes the bound tight for both tails
+   vec4 moments = texture(momentMap, vec3(projCoords.xy, layer));
+   float depth = 2.0 * (projCoords.z - bias) - 1.0;
+   float positive = exp(EVSM_POSITIVE_EXPONENT * depth);
+   float negative = -exp(-EVSM_NEGATIVE_EXPONENT * depth);
+   float lit = min(
+      ChebyshevUpperBound(moments.xy, positive),
+      ChebyshevUpperBound(moments.zw, negative));
+   return 1.0 - lit;
+#else
+   // one lookup, compared and blended over 2x2 texels by the
+   // hardware
+   return 1.0 - texture(shadowMap, vec4(projCoords.xy, layer, projCoords.z - bias));
+#endif
+}
+
+// compares the depth of a fragment with the tile of a light
+// in the shadow atlas
+float CalcAtlasShadow(LightSource light, vec3 worldPosition, vec3 lightNormal)
+{
+   if(light.shadowTile.z <= 0.0)
+   {
+      return 0.0;
+   }
+
+   vec4 fragPosLightSpace = light.shadowMatrix * vec4(worldPosition, 1.0);
+   if(fragPosLightSpace.w <= 0.0)
+   {
+      return 0.0;
+   }
+   vec3 projCoords = (fragPosLightSpace.xyz / fragPosLightSpace.w) * 0.5 + 0.5;
+   if(any(lessThan(projCoords, vec3(0.0))) || any(greaterThan(projCoords, vec3(1.0))))
+   {
+      return 0.0;
+   }
+
+   // the perspective depth is finer near the light, so the
+   // bias is smaller than the one of the cascades
+   vec3 lightDirection = normalize(light.position - worldPosition);
+   float bias = max(0.001 * (1.0 - dot(lightNormal, lightDirection)), 0.0002);
+
+   // keep the filtered lookup half a texel inside of the tile,
+   // so that it does not blend with the tile next to it
+   vec2 halfTexel = 0.5 / vec2(textureSize(shadowAtlas, 0));
+   vec2 atlasCoords = clamp(
+      light.shadowTile.xy + projCoords.xy * light.shadowTile.zw,
+      light.shadowTile.xy + halfTexel,
+      light.shadowTile.xy + light.shadowTile.zw - halfTexel);
+   return 1.0 - texture(shadowAtlas, vec3(atlasCoords, projCoords.z - bias));
+}
+
+// compares the depth of a fragment with the face of the cube
+// of a point light that it is seen through
+float CalcCubeShadow(LightSource light, vec3 worldPosition, vec3 lightNormal)
+{
+   if(light.shadowRadius <= 0.0)
+   {
+      return 0.0;
+   }
+
+   vec3 lightToFragment = worldPosition - light.position;
+   float major = max(abs(lightToFragment.x), max(abs(lightToFragment.y), abs(lightToFragment.z)));
+   if(major >= light.shadowRadius)
+   {
+      return 0.0;
+   }
+
+   // the face is drawn with a perspective projection, so the
+   // stored depth follows the distance along its major axis
+   float nearPlane = OMNI_NEAR_PLANE;
+   float farPlane = light.shadowRadius;
+   float depth = ((farPlane + nearPlane) / (farPlane - nearPlane) -
+      (2.0 * farPlane * nearPlane) / ((farPlane - nearPlane) * major)) * 0.5 + 0.5;
+
+   vec3 lightDirection = normalize(-lightToFragment);
+   float bias = max(0.001 * (1.0 - dot(lightNormal, lightDirection)), 0.0002);
+   return 1.0 - texture(shadowCubes, vec4(lightToFragment, light.shadowCube), depth - bias);
+}
+
+// adds the local lights that reach the cluster of the fragment
+vec3 CalcClusterLights(vec3 lightNormal, vec3 vertexPosition, vec3 viewDirection)
+{
+   if(gridSize.w == 0u)
+   {
+      return vec3(0.0);
+   }
+
+   // the tile under the fragment and the slice of its depth,
+   // which grow with the log of the depth
+   float viewDepth = -(view * vec4(vertexPosition, 1.0)).z;
+   uvec3 cell = uvec3(
+      gl_FragCoord.xy / gridScale.xy,
+      max(log(max(viewDepth, 0.0001)) * gridScale.z + gridScale.w, 0.0));
+   cell = min(cell, gridSize.xyz - 1u);
+   uint cluster = (cell.z * gridSize.y + cell.y) * gridSize.x + cell.x;
 
-   return(ambient + diffuse + specular);
+   uvec2 range = clusterRanges[cluster];
+   vec3 result = vec3(0.0);
+   for(uint i = 0u; i < range.y; i++)
+   {
+      result += CalcLocalLight(localLights[lightIndices[range.x + i]], lightNormal, vertexPosition, viewDirection);
+   }
+   return result;
 }
 
-float CalcShadow(vec4 fragPosLightSpace)
-{
-   // perform perspective divide
-   vec3 projCoords = fragPosLightSpace.xyz / fragPosLightSpace.w;
-   // transform to [0,1] range
-   projCoords = projCoords * 0.5 + 0.5;
-   // get closest depth value from light's perspective (using [0,1] range fragPosLight as coords)
-   float closestDepth = texture(depthMap, projCoords.xy).r; 
-   // get depth of current fragment from light's perspective
-   float currentDepth = projCoords.z;
-   // check whether current frag pos is in shadow
-   float shadow = currentDepth > closestDepth  ? 1.0 : 0.0;
-
-   return shadow;
-}
\ No newline at end of file
+// calculates the diffuse and Blinn specular color of a local
+// light, which falls smoothly to zero at its radius
+vec3 CalcLocalLight(LocalLight light, vec3 lightNormal, vec3 vertexPosition, vec3 viewDirection)
+{
+   vec3 toLight = light.position - vertexPosition;
+   float distance = length(toLight);
+   float falloff = clamp(1.0 - pow(distance / light.radius, 4.0), 0.0, 1.0);
+   float attenuation = falloff * falloff / (distance * distance + 1.0);
+   if(attenuation <= 0.0)
+   {
+      return vec3(0.0);
+   }
+
+   vec3 lightDirection = toLight / max(distance, 0.0001);
+   float impact = max(dot(lightNormal, lightDirection), 0.0);
+   vec3 diffuse = impact * material.diffuseColor * light.color;
+
+   vec3 halfwayDir = normalize(lightDirection + viewDirection);
+   float specularComponent = pow(max(dot(lightNormal, halfwayDir), 0.0), 16.0);
+   vec3 specular = (light.specularIntensity * material.shininess) * specularComponent * material.specularColor;
+
+   return attenuation * (diffuse + specular);
+}
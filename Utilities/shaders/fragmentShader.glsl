@@ -1,40 +1,65 @@
 #version 440 core
 
+// member order follows the std140 packing of the C++ mirrors
+// in UniformBufferManager.h
 struct Material 
 {
     vec3 ambientColor;
     float ambientStrength;
     vec3 diffuseColor;
-    vec3 specularColor;
     float shininess;
+    vec3 specularColor;
 }; 
 
 struct LightSource 
 {
     vec3 position;	
+    float focalStrength;
     vec3 ambientColor;
+    float specularIntensity;
     vec3 diffuseColor;
+    float shadowCube;
     vec3 specularColor;
-    float focalStrength;
-    float specularIntensity;
+    float shadowRadius;
+    mat4 shadowMatrix;
+    vec4 shadowTile;
 };
 
 #define TOTAL_LIGHTS 4
+// number of shadow cascades - must match MAX_SHADOW_CASCADES
+// in UniformBufferManager.h
+#define MAX_CASCADES 4
 
 in vec3 fragmentPosition;
 in vec3 fragmentVertexNormal;
 in vec2 fragmentTextureCoordinate;
+in vec4 fragmentObjectColor;
 
 out vec4 outFragmentColor;
 
 uniform bool bUseTexture=false;
 uniform bool bUseLighting=false;
-uniform vec4 objectColor = vec4(1.0f);
 uniform sampler2D objectTexture;
-uniform vec3 viewPosition;
-uniform vec2 UVscale = vec2(1.0f, 1.0f);
-uniform LightSource lightSources[TOTAL_LIGHTS];
-uniform Material material;
+
+layout (std140) uniform CameraBlock
+{
+   mat4 view;
+   mat4 projection;
+   mat4 lightSpaceMatrix;
+   vec4 viewPosition;
+   mat4 cascadeMatrices[MAX_CASCADES];
+   vec4 cascadeSplits;
+};
+
+layout (std140) uniform LightBlock
+{
+   LightSource lightSources[TOTAL_LIGHTS];
+};
+
+layout (std140) uniform MaterialBlock
+{
+   Material material;
+};
 
 // function prototypes
 vec3 CalcLightSource(LightSource light, vec3 lightNormal, vec3 vertexPosition, vec3 viewDirection);
@@ -45,7 +70,7 @@ void main()
    {
       // properties
       vec3 lightNormal = normalize(fragmentVertexNormal);
-      vec3 viewDirection = normalize(viewPosition - fragmentPosition);
+      vec3 viewDirection = normalize(viewPosition.xyz - fragmentPosition);
       vec3 phongResult = vec3(0.0f);
 
       for(int i = 0; i < TOTAL_LIGHTS; i++)
@@ -55,23 +80,23 @@ void main()
     
       if(bUseTexture == true)
       {
-         vec4 textureColor = texture(objectTexture, fragmentTextureCoordinate * UVscale);
+         vec4 textureColor = texture(objectTexture, fragmentTextureCoordinate);
          outFragmentColor = vec4(phongResult * textureColor.xyz, 1.0);
       }
       else
       {
-         outFragmentColor = vec4(phongResult * objectColor.xyz, objectColor.w);
+         outFragmentColor = vec4(phongResult * fragmentObjectColor.xyz, fragmentObjectColor.w);
       }
    }
    else 
    {
       if(bUseTexture == true)
       {
-         outFragmentColor = texture(objectTexture, fragmentTextureCoordinate * UVscale);
+         outFragmentColor = texture(objectTexture, fragmentTextureCoordinate);
       }
       else
       {
-         outFragmentColor = objectColor;
+         outFragmentColor = fragmentObjectColor;
       }
    }
 }
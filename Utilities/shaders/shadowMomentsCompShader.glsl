@@ -0,0 +1,67 @@
+#version 430 core
+layout (local_size_x = 8, local_size_y = 8) in;
+
+// exponents of the EVSM warp - must match fragShader.glsl
+#define EVSM_POSITIVE_EXPONENT 40.0
+#define EVSM_NEGATIVE_EXPONENT 5.0
+// taps on each side of the blur
+#define BLUR_RADIUS 3
+
+// depths of the cascades, read by the first pass
+uniform sampler2DArray depthMap;
+// moments blurred along x, read by the second pass
+uniform sampler2DArray sourceMoments;
+// 0 for the first pass, which warps the depths and blurs
+// them along x, and 1 for the second, which blurs along y
+uniform int blurPass;
+// bit for each cascade layer that is filtered
+uniform int layerMask;
+layout (rgba32f, binding = 0) uniform writeonly image2DArray targetMoments;
+
+// binomial weights of the blur, from the center out
+const float weights[BLUR_RADIUS + 1] = float[](0.3125, 0.234375, 0.09375, 0.015625);
+
+// moments of the positive and negative exponential warps of
+// a depth, which is moved to [-1, 1] first
+vec4 WarpDepth(float depth)
+{
+   float warpedDepth = 2.0 * depth - 1.0;
+   float positive = exp(EVSM_POSITIVE_EXPONENT * warpedDepth);
+   float negative = -exp(-EVSM_NEGATIVE_EXPONENT * warpedDepth);
+   return vec4(positive, positive * positive, negative, negative * negative);
+}
+
+void main()
+{
+   int layer = int(gl_GlobalInvocationID.z);
+   if((layerMask & (1 << layer)) == 0)
+   {
+      return;
+   }
+
+   ivec2 target = ivec2(gl_GlobalInvocationID.xy);
+   ivec2 targetSize = imageSize(targetMoments).xy;
+   if(any(greaterThanEqual(target, targetSize)))
+   {
+      return;
+   }
+
+   ivec2 axis = (blurPass == 0) ? ivec2(1, 0) : ivec2(0, 1);
+   vec4 moments = vec4(0.0);
+   for(int i = -BLUR_RADIUS; i <= BLUR_RADIUS; i++)
+   {
+      ivec2 tap = clamp(target + axis * i, ivec2(0), targetSize - 1);
+      vec4 value;
+      if(blurPass == 0)
+      {
+         value = WarpDepth(texelFetch(depthMap, ivec3(tap, layer), 0).r);
+      }
+      else
+      {
+         value = texelFetch(sourceMoments, ivec3(tap, layer), 0);
+      }
+      moments += value * weights[abs(i)];
+   }
+
+   imageStore(targetMoments, ivec3(target, layer), moments);
+}
\ No newline at end of file
@@ -2,22 +2,92 @@
 layout (location = 0) in vec3 inVertexPosition;
 layout (location = 1) in vec3 inVertexNormal;
 layout (location = 2) in vec2 inTextureCoordinate;
+// per-instance values, used when bInstanced is set
+layout (location = 3) in mat4 inInstanceModel;
+layout (location = 7) in vec4 inInstanceColor;
+layout (location = 8) in vec2 inInstanceUVscale;
+// center (xyz) and scale (w) of packed positions - (0, 0, 0, 1)
+// when the attribute is not enabled
+layout (location = 9) in vec4 inMeshDecode;
 
 out vec2 fragmentTextureCoordinate;
 out vec3 fragmentPosition;
 out vec3 fragmentVertexNormal;
 out vec4 fragmentPosLightSpace;
+out vec4 fragmentObjectColor;
 
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
-uniform mat4 lightSpaceMatrix;
+uniform vec4 objectColor = vec4(1.0f);
+uniform vec2 UVscale = vec2(1.0f, 1.0f);
+// a shader variant is built with its features fixed, so that
+// the branches of the other features are compiled out - the
+// features are uniforms when the shader is built without one
+#ifdef SHADER_VARIANT
+#ifdef FEATURE_INSTANCED
+const bool bInstanced = true;
+#else
+const bool bInstanced = false;
+#endif
+#ifdef FEATURE_PACKED
+const bool bPackedVertices = true;
+#else
+const bool bPackedVertices = false;
+#endif
+#else
+uniform bool bInstanced = false;
+// set when the normals hold two octahedral coordinates
+uniform bool bPackedVertices = false;
+#endif
+
+// number of shadow cascades - must match MAX_SHADOW_CASCADES
+// in UniformBufferManager.h
+#define MAX_CASCADES 4
+
+layout (std140) uniform CameraBlock
+{
+   mat4 view;
+   mat4 projection;
+   mat4 lightSpaceMatrix;
+   vec4 viewPosition;
+   mat4 cascadeMatrices[MAX_CASCADES];
+   vec4 cascadeSplits;
+};
+
+vec3 DecodeOctahedral(vec2 encoded)
+{
+   vec3 normal = vec3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
+   if(normal.z < 0.0)
+   {
+      vec2 signs = vec2(encoded.x >= 0.0 ? 1.0 : -1.0, encoded.y >= 0.0 ? 1.0 : -1.0);
+      normal.xy = (1.0 - abs(normal.yx)) * signs;
+   }
+   return normalize(normal);
+}
 
 void main()
 {
-   fragmentPosition = vec3(model * vec4(inVertexPosition, 1.0));
-   gl_Position = projection * view * model * vec4(inVertexPosition, 1.0f);
-   fragmentVertexNormal = inVertexNormal;
-   fragmentTextureCoordinate = inTextureCoordinate;
+   mat4 objectModel = model;
+   vec4 color = objectColor;
+   vec2 textureScale = UVscale;
+
+   if(bInstanced == true)
+   {
+      objectModel = inInstanceModel;
+      color = inInstanceColor;
+      textureScale = inInstanceUVscale;
+   }
+
+   vec3 vertexPosition = inMeshDecode.xyz + inVertexPosition * inMeshDecode.w;
+   vec3 vertexNormal = inVertexNormal;
+   if(bPackedVertices == true)
+   {
+      vertexNormal = DecodeOctahedral(inVertexNormal.xy);
+   }
+
+   fragmentPosition = vec3(objectModel * vec4(vertexPosition, 1.0));
+   gl_Position = projection * view * objectModel * vec4(vertexPosition, 1.0f);
+   fragmentVertexNormal = vertexNormal;
+   fragmentTextureCoordinate = inTextureCoordinate * textureScale;
+   fragmentObjectColor = color;
    fragmentPosLightSpace = lightSpaceMatrix * vec4(fragmentPosition, 1.0);
 }
\ No newline at end of file
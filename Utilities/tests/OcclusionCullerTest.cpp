@@ -0,0 +1,184 @@
+///////////////////////////////////////////////////////////////////////////////
+// occlusioncullertest.cpp
+// ============
+// check the CPU occlusion culler on a few scenes whose answers are known,
+// and time the culling of a scene of many boxes for each frame
+//
+// The culler makes no OpenGL calls, so this is built on its own by the
+// OcclusionCullerTest project of the solution, or from the Utilities
+// directory with:
+//   g++ -std=c++17 -O2 -I. -I../Libraries/glm tests/OcclusionCullerTest.cpp
+//       OcclusionCuller.cpp Frustum.cpp -pthread -o OcclusionCullerTest
+// and returns 1 when a check fails.
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "OcclusionCuller.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+// declaration of global variables
+namespace
+{
+	// frames timed after the checks, and the views culled in
+	// each frame - the camera, the sun and the shadow tiles
+	const int g_TimedFrames = 200;
+	const int g_ViewsPerFrame = 6;
+	// boxes and occluders of the timed scene
+	const int g_TimedBoxes = 2000;
+	const int g_TimedOccluders = 16;
+
+	// camera at the origin looking down -z
+	glm::mat4 CameraMatrix()
+	{
+		glm::mat4 projection = glm::perspective(glm::radians(60.0f), 2.0f, 0.1f, 100.0f);
+		glm::mat4 view = glm::lookAt(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+		return(projection * view);
+	}
+
+	// wall 4 units wide and high, 5 units in front of the camera
+	void AddWall(OcclusionCuller& culler)
+	{
+		culler.ClearOccluders();
+		culler.AddOccluderBox(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, -5.0f), glm::vec3(2.0f, 2.0f, 0.1f));
+	}
+
+	// report one check, and return whether it passed
+	bool Check(
+		const char* name,
+		bool bVisible,
+		bool bExpected)
+	{
+		bool bPassed = (bVisible == bExpected);
+		std::cout << (bPassed ? "PASS: " : "FAIL: ") << name
+			<< " - visible " << bVisible << ", expected " << bExpected << std::endl;
+		return(bPassed);
+	}
+}
+
+/***********************************************************
+ *  RunChecks()
+ *
+ *  This function is used to test boxes around a wall that
+ *  the camera looks at, and returns the number of checks
+ *  that failed.
+ ***********************************************************/
+int RunChecks()
+{
+	OcclusionCuller culler;
+	AddWall(culler);
+	culler.RasterizeOccluders(CameraMatrix());
+
+	int nFailed = 0;
+
+	// a small box straight behind the wall is hidden
+	if (Check("occluder in front", culler.IsBoxVisible(glm::vec3(0.0f, 0.0f, -10.0f), glm::vec3(0.5f)), false) == false)
+	{
+		nFailed++;
+	}
+	// the same box between the camera and the wall is seen
+	if (Check("occluder behind", culler.IsBoxVisible(glm::vec3(0.0f, 0.0f, -3.0f), glm::vec3(0.5f)), true) == false)
+	{
+		nFailed++;
+	}
+	// a box behind the wall that reaches past its edge is seen
+	if (Check("box peeking around", culler.IsBoxVisible(glm::vec3(4.5f, 0.0f, -10.0f), glm::vec3(1.0f)), true) == false)
+	{
+		nFailed++;
+	}
+	// a box behind the wall that is larger than it is seen
+	if (Check("box larger than occluder", culler.IsBoxVisible(glm::vec3(0.0f, 0.0f, -10.0f), glm::vec3(6.0f, 6.0f, 0.5f)), true) == false)
+	{
+		nFailed++;
+	}
+
+	return(nFailed);
+}
+
+/***********************************************************
+ *  RunTiming()
+ *
+ *  This function is used to time the culling of a grid of
+ *  boxes behind rows of occluders, for several views in
+ *  each frame as the scene manager does, and prints the
+ *  time of each frame and of each view.
+ ***********************************************************/
+void RunTiming()
+{
+	OcclusionCuller culler;
+	for (int i = 0; i < g_TimedOccluders; i++)
+	{
+		float x = -12.0f + 1.6f * (float)i;
+		culler.AddOccluderBox(glm::mat4(1.0f), glm::vec3(x, 0.0f, -6.0f), glm::vec3(0.6f, 2.0f, 0.1f));
+	}
+
+	std::vector<float> centerX(g_TimedBoxes);
+	std::vector<float> centerY(g_TimedBoxes);
+	std::vector<float> centerZ(g_TimedBoxes);
+	std::vector<float> extent(g_TimedBoxes, 0.25f);
+	for (int i = 0; i < g_TimedBoxes; i++)
+	{
+		centerX[i] = -20.0f + 40.0f * (float)(i % 50) / 50.0f;
+		centerY[i] = -2.0f + 4.0f * (float)((i / 50) % 4) / 4.0f;
+		centerZ[i] = -8.0f - 0.5f * (float)(i / 200);
+	}
+
+	Frustum::BOX_ARRAYS boxes;
+	boxes.centerX = centerX.data();
+	boxes.centerY = centerY.data();
+	boxes.centerZ = centerZ.data();
+	boxes.extentX = extent.data();
+	boxes.extentY = extent.data();
+	boxes.extentZ = extent.data();
+
+	std::vector<uint8_t> visible(g_TimedBoxes);
+	glm::mat4 viewProjection = CameraMatrix();
+	size_t nVisible = 0;
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for (int frame = 0; frame < g_TimedFrames; frame++)
+	{
+		for (int view = 0; view < g_ViewsPerFrame; view++)
+		{
+			visible.assign(g_TimedBoxes, 1);
+			culler.RasterizeOccluders(viewProjection);
+			culler.CullBoxes(boxes, g_TimedBoxes, visible.data());
+		}
+	}
+	std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+	for (int i = 0; i < g_TimedBoxes; i++)
+	{
+		nVisible += visible[i];
+	}
+
+	double milliseconds = std::chrono::duration<double, std::milli>(end - start).count();
+	std::cout << "INFO: " << g_TimedBoxes << " boxes behind " << g_TimedOccluders << " occluders, "
+		<< nVisible << " visible" << std::endl;
+	std::cout << "INFO: cull time " << milliseconds / g_TimedFrames << " ms per frame, "
+		<< milliseconds / (g_TimedFrames * g_ViewsPerFrame) << " ms per view" << std::endl;
+}
+
+/***********************************************************
+ *  main()
+ *
+ *  This function runs the checks and then the timing.
+ ***********************************************************/
+int main()
+{
+	int nFailed = RunChecks();
+	RunTiming();
+
+	if (nFailed > 0)
+	{
+		std::cout << "ERROR: " << nFailed << " occlusion checks failed" << std::endl;
+		return(1);
+	}
+
+	return(0);
+}